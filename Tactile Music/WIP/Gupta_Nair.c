@@ -65,10 +65,24 @@
  *  which services any interrupts or threads on an as-needed basis.
  *
  *  The edmaHwi() interrupt service routine is called when a buffer has been
- *  filled.  It contains a state variable named pingOrPong that indicates
- *  whether the buffer is a PING or PONG buffer.  dmaHwi switches the buffer
- *  state to the opposite buffer and calls the SWI thread processBuffer to
- *  process the audio data.
+ *  filled.  It contains a state variable named ringIndex that indicates
+ *  which buffer of the ring was just filled.  edmaHwi advances it to the
+ *  next buffer and posts the SWI thread processBuffer to process the audio
+ *  data.
+ *
+ *  This version generalizes Ping/Pong to a ring of gRingDepth buffers of
+ *  gBuffSize words per direction, set before main() runs.  The output
+ *  trails the input by gRingDepth frames, and each frame must be processed
+ *  within gRingDepth - 1 frame periods: small frames in a deeper ring cut
+ *  the latency while keeping slack for the other threads.
+ *
+ *  Each frame is also filtered in place, and the transmit channel sends
+ *  from the receive buffers: the transmit EDMA reads each word of a buffer
+ *  just before the receive EDMA overwrites it, a ring later.  That drops
+ *  the transmit buffers, and a bypassed frame is sent as received without
+ *  a copy.  A muted frame repoints its transmit reload entry at a single
+ *  zero word, read without incrementing the source, instead of clearing
+ *  the buffer.
  *
  *  Other Functions
  *
@@ -93,7 +107,14 @@
  *  based on these settings.  A header file called dsk_appcfg.h contains the
  *  results of the autogeneration and must be included for proper operation.
  *  The name of the file is taken from dsk_app.cdb and adding cfg.h.
+ *
+ *  When built with HOST_SIM defined (see host/Makefile) the BIOS, CSL and
+ *  BSL modules are replaced by the workstation simulation in host/dsk_sim.h,
+ *  which feeds the EDMA buffers from a WAV file instead of the AIC23.
  */
+#ifdef HOST_SIM
+#include "host/dsk_sim.h"
+#else
 #include "dsk_appcfg.h"
 
 /*
@@ -102,6 +123,7 @@
  */
 #include <std.h>
 #include <swi.h>
+#include <clk.h>
 #include <log.h>
 #include <c6x.h>
 #include <csl.h>
@@ -119,60 +141,179 @@
 #include <dsk6713_led.h>
 #include <dsk6713_dip.h>
 #include <aic23.h>
+#endif
 #include <string.h>
 
+#include "eq_energy.h"
+#include "eq_onset.h"
+#include "eq_sched.h"
+#include "eq_sdft.h"
+#include "eq_stats.h"
+#include "eq_tactile.h"
+
 /* Function prototypes */
 void initIrq(void);
 void initMcbsp(void);
 void initEdma(void);
 void processBuffer(void);
+void processFrame(Uint32 buf);
+void setXmtSource(Uint32 buf, Uint32 muted);
 void edmaHwi(void);
+void hapticTick(void);
+void dumpStats(void);
 
-/* Constants for the buffered ping-pong transfer */
-#define BUFFSIZE 1024
-#define PING 0
-#define PONG 1
+/* Constants for the buffer ring, in words (stereo, so always even) */
+#define BUFFSIZE 1024           // default frame: Ping/Pong of 1024 words
+#define RING_DEPTH 2
+#define MIN_BUFFSIZE 64
+#define MAX_BUFFSIZE 4096       // at most EQ_MAX_FRAME
+#define MIN_RING 2
+#define MAX_RING 8
+
+/*
+ * Each direction's buffers come from a pool of RING_POOL_WORDS, so
+ * gBuffSize * gRingDepth must fit in it.  The DSK keeps the pool in
+ * internal RAM; the host has room for every setting.
+ */
+#ifndef RING_POOL_WORDS
+#ifdef HOST_SIM
+#define RING_POOL_WORDS (MAX_BUFFSIZE * MAX_RING)
+#else
+#define RING_POOL_WORDS 8192
+#endif
+#endif
 #define num_of_coeffs 101	// order of filter = 100
-float AvgPLP=0.0, AvgPBP=0.0, AvgPHP=0.0;
-float PLP=0.0,PBP=0.0,PHP=0.0;
 
-/*coeffs for LED display*/
-float lp1[13] ={0.127174276079605, 0.0581343489943583, 0.0681122463081755, 0.0766052817881472, 0.0830675938972334, 0.0871853443909994, 0.0884935091352945, 0.0871853443909994, 0.0830675938972334, 0.0766052817881472, 0.0681122463081755, 0.0581343489943583, 0.127174276079605};
+/*coeffs for LED display (const: placed in read-only .const)*/
+const float lp1[13] ={0.127174276079605, 0.0581343489943583, 0.0681122463081755, 0.0766052817881472, 0.0830675938972334, 0.0871853443909994, 0.0884935091352945, 0.0871853443909994, 0.0830675938972334, 0.0766052817881472, 0.0681122463081755, 0.0581343489943583, 0.127174276079605};
 
-float bp1[13]={0.0109723768383746, -0.0467943943338264, -0.0741398108994016, -0.149777301781025, 0.117993634189359, 0.192388845547486, 0.294512671843853, 0.192388845547486, 0.117993634189359, -0.149777301781025, -0.0741398108994016, -0.0467943943338264, 0.0109723768383746};
+const float bp1[13]={0.0109723768383746, -0.0467943943338264, -0.0741398108994016, -0.149777301781025, 0.117993634189359, 0.192388845547486, 0.294512671843853, 0.192388845547486, 0.117993634189359, -0.149777301781025, -0.0741398108994016, -0.0467943943338264, 0.0109723768383746};
 
-float hp1[13]={-0.0351103427314022, 0.120418583869658, 0.0883153039547716, 0.00865009773730016, -0.134411547496756, -0.277541793649009, 0.662413172546772, -0.277541793649009, -0.134411547496756, 0.00865009773730016, 0.0883153039547716, 0.120418583869658, -0.0351103427314022};
+const float hp1[13]={-0.0351103427314022, 0.120418583869658, 0.0883153039547716, 0.00865009773730016, -0.134411547496756, -0.277541793649009, 0.662413172546772, -0.277541793649009, -0.134411547496756, 0.00865009773730016, 0.0883153039547716, 0.120418583869658, -0.0351103427314022};
 
 
 /*coeffs for filtering signal*/
-float lp[101] = {0.000794206273044022, 0.000548194416095954, 0.000663759028931897, 0.000730868445533115, 0.000725042173370078, 0.000625403097601075, 0.000417966493673838, 9.95735925426323e-05, -0.000319729398910800, -0.000814113631211842, -0.00134291964974873, -0.00185146995043936, -0.00227604976855320, -0.00254877142578663, -0.00260556539105503, -0.00239330106441487, -0.00187925585202128, -0.00105780163669138, 4.29242654544079e-05, 0.00135928483246650, 0.00279201516631559, 0.00421174592220747, 0.00546638622898337, 0.00639450217019192, 0.00684017826993213, 0.00667108818699390, 0.00579404736101161, 0.00417181129718697, 0.00183584406187777, -0.00110549621443575, -0.00446772626977129, -0.00799355070314555, -0.0113648346373487, -0.0142260751327139, -0.0162041723486797, -0.0169421532171993, -0.0161267529445259, -0.0135198182013752, -0.00898349682512086, -0.00250101512389786, 0.00581172956195405, 0.0157047045708828, 0.0268009604244810, 0.0386166827614341, 0.0505881284732122, 0.0621078232828363, 0.0725640566815100, 0.0813837006945989, 0.0880710804968140, 0.0922444628176314, 0.0936628894927666, 0.0922444628176314, 0.0880710804968140, 0.0813837006945989, 0.0725640566815100, 0.0621078232828363, 0.0505881284732122, 0.0386166827614341, 0.0268009604244810, 0.0157047045708828, 0.00581172956195405, -0.00250101512389786, -0.00898349682512086, -0.0135198182013752, -0.0161267529445259, -0.0169421532171993, -0.0162041723486797, -0.0142260751327139, -0.0113648346373487, -0.00799355070314555, -0.00446772626977129, -0.00110549621443575, 0.00183584406187777, 0.00417181129718697, 0.00579404736101161, 0.00667108818699390, 0.00684017826993213, 0.00639450217019192, 0.00546638622898337, 0.00421174592220747, 0.00279201516631559, 0.00135928483246650, 4.29242654544079e-05, -0.00105780163669138, -0.00187925585202128, -0.00239330106441487, -0.00260556539105503, -0.00254877142578663, -0.00227604976855320, -0.00185146995043936, -0.00134291964974873, -0.000814113631211842, -0.000319729398910800, 9.95735925426323e-05, 0.000417966493673838, 0.000625403097601075, 0.000725042173370078, 0.000730868445533115, 0.000663759028931897, 0.000548194416095954, 0.000794206273044022};
+const float lp[101] = {0.000794206273044022, 0.000548194416095954, 0.000663759028931897, 0.000730868445533115, 0.000725042173370078, 0.000625403097601075, 0.000417966493673838, 9.95735925426323e-05, -0.000319729398910800, -0.000814113631211842, -0.00134291964974873, -0.00185146995043936, -0.00227604976855320, -0.00254877142578663, -0.00260556539105503, -0.00239330106441487, -0.00187925585202128, -0.00105780163669138, 4.29242654544079e-05, 0.00135928483246650, 0.00279201516631559, 0.00421174592220747, 0.00546638622898337, 0.00639450217019192, 0.00684017826993213, 0.00667108818699390, 0.00579404736101161, 0.00417181129718697, 0.00183584406187777, -0.00110549621443575, -0.00446772626977129, -0.00799355070314555, -0.0113648346373487, -0.0142260751327139, -0.0162041723486797, -0.0169421532171993, -0.0161267529445259, -0.0135198182013752, -0.00898349682512086, -0.00250101512389786, 0.00581172956195405, 0.0157047045708828, 0.0268009604244810, 0.0386166827614341, 0.0505881284732122, 0.0621078232828363, 0.0725640566815100, 0.0813837006945989, 0.0880710804968140, 0.0922444628176314, 0.0936628894927666, 0.0922444628176314, 0.0880710804968140, 0.0813837006945989, 0.0725640566815100, 0.0621078232828363, 0.0505881284732122, 0.0386166827614341, 0.0268009604244810, 0.0157047045708828, 0.00581172956195405, -0.00250101512389786, -0.00898349682512086, -0.0135198182013752, -0.0161267529445259, -0.0169421532171993, -0.0162041723486797, -0.0142260751327139, -0.0113648346373487, -0.00799355070314555, -0.00446772626977129, -0.00110549621443575, 0.00183584406187777, 0.00417181129718697, 0.00579404736101161, 0.00667108818699390, 0.00684017826993213, 0.00639450217019192, 0.00546638622898337, 0.00421174592220747, 0.00279201516631559, 0.00135928483246650, 4.29242654544079e-05, -0.00105780163669138, -0.00187925585202128, -0.00239330106441487, -0.00260556539105503, -0.00254877142578663, -0.00227604976855320, -0.00185146995043936, -0.00134291964974873, -0.000814113631211842, -0.000319729398910800, 9.95735925426323e-05, 0.000417966493673838, 0.000625403097601075, 0.000725042173370078, 0.000730868445533115, 0.000663759028931897, 0.000548194416095954, 0.000794206273044022};
 
-float bp[101] = {-3.44129163333276e-05, -9.55777451440713e-06, 2.64899380714646e-05, 5.55858616219839e-05, 3.76123224727201e-05, -2.37894569729972e-05, -6.72758486875963e-05, -3.02726953188300e-05, 7.08690878564160e-05, 0.000131345355737871, 5.67311481966252e-05, -0.000116289533926509, -0.000219521231249759, -0.000113433667247428, 0.000135376673604786, 0.000265948932286808, 7.06744440433403e-05, -0.000338537990629421, -0.000547637061692444, -0.000212085991955519, 0.000515626914967612, 0.000938423771622001, 0.000297806786620044, -0.00155269478647518, -0.00386395990955181, -0.00284323714036927, -0.00500833002678241, -0.00574101906720537, -0.00440682620397027, 0.000735045794638078, 0.00809925858140467, 0.0127424168773443, 0.0110040579026694, 0.00561901315991171, 0.00468191357995884, 0.0132770865785417, 0.0256501707807756, 0.0279518390867756, 0.0118933403200059, -0.0136292140137046, -0.0275398620655114, -0.0175859792010491, 0.00229633694770758, -0.000485843011545146, -0.0454831232415294, -0.110965780974025, -0.140265785480084, -0.0854100172458280, 0.0460340892645079, 0.184341744473006, 0.243276200782189, 0.184341744473006, 0.0460340892645078, -0.0854100172458280, -0.140265785480084, -0.110965780974025, -0.0454831232415294, -0.000485843011545156, 0.00229633694770758, -0.0175859792010492, -0.0275398620655114, -0.0136292140137046, 0.0118933403200059, 0.0279518390867756, 0.0256501707807756, 0.0132770865785417, 0.00468191357995884, 0.00561901315991170, 0.0110040579026694, 0.0127424168773443, 0.00809925858140467, 0.000735045794638078, -0.00440682620397027, -0.00574101906720537, -0.00500833002678241, -0.00284323714036927, -0.00386395990955181, -0.00155269478647518, 0.000297806786620044, 0.000938423771622001, 0.000515626914967613, -0.000212085991955519, -0.000547637061692444, -0.000338537990629421, 7.06744440433402e-05, 0.000265948932286808, 0.000135376673604786, -0.000113433667247428, -0.000219521231249759, -0.000116289533926509, 5.67311481966252e-05, 0.000131345355737871, 7.08690878564160e-05, -3.02726953188300e-05, -6.72758486875963e-05, -2.37894569729972e-05, 3.76123224727201e-05, 5.55858616219839e-05, 2.64899380714646e-05, -9.55777451440713e-06, -3.44129163333276e-05};
+const float bp[101] = {-3.44129163333276e-05, -9.55777451440713e-06, 2.64899380714646e-05, 5.55858616219839e-05, 3.76123224727201e-05, -2.37894569729972e-05, -6.72758486875963e-05, -3.02726953188300e-05, 7.08690878564160e-05, 0.000131345355737871, 5.67311481966252e-05, -0.000116289533926509, -0.000219521231249759, -0.000113433667247428, 0.000135376673604786, 0.000265948932286808, 7.06744440433403e-05, -0.000338537990629421, -0.000547637061692444, -0.000212085991955519, 0.000515626914967612, 0.000938423771622001, 0.000297806786620044, -0.00155269478647518, -0.00386395990955181, -0.00284323714036927, -0.00500833002678241, -0.00574101906720537, -0.00440682620397027, 0.000735045794638078, 0.00809925858140467, 0.0127424168773443, 0.0110040579026694, 0.00561901315991171, 0.00468191357995884, 0.0132770865785417, 0.0256501707807756, 0.0279518390867756, 0.0118933403200059, -0.0136292140137046, -0.0275398620655114, -0.0175859792010491, 0.00229633694770758, -0.000485843011545146, -0.0454831232415294, -0.110965780974025, -0.140265785480084, -0.0854100172458280, 0.0460340892645079, 0.184341744473006, 0.243276200782189, 0.184341744473006, 0.0460340892645078, -0.0854100172458280, -0.140265785480084, -0.110965780974025, -0.0454831232415294, -0.000485843011545156, 0.00229633694770758, -0.0175859792010492, -0.0275398620655114, -0.0136292140137046, 0.0118933403200059, 0.0279518390867756, 0.0256501707807756, 0.0132770865785417, 0.00468191357995884, 0.00561901315991170, 0.0110040579026694, 0.0127424168773443, 0.00809925858140467, 0.000735045794638078, -0.00440682620397027, -0.00574101906720537, -0.00500833002678241, -0.00284323714036927, -0.00386395990955181, -0.00155269478647518, 0.000297806786620044, 0.000938423771622001, 0.000515626914967613, -0.000212085991955519, -0.000547637061692444, -0.000338537990629421, 7.06744440433402e-05, 0.000265948932286808, 0.000135376673604786, -0.000113433667247428, -0.000219521231249759, -0.000116289533926509, 5.67311481966252e-05, 0.000131345355737871, 7.08690878564160e-05, -3.02726953188300e-05, -6.72758486875963e-05, -2.37894569729972e-05, 3.76123224727201e-05, 5.55858616219839e-05, 2.64899380714646e-05, -9.55777451440713e-06, -3.44129163333276e-05};
 
-float hp[101] = {-3.71378189903913e-06, -0.000385543776213135, -0.000174286613119065, 0.000155157397306870, 0.000447502003880196, 0.000299012398223559, -0.000291860363810950, -0.000755737883023330, -0.000461619506027581, 0.000503496026963570, 0.00118813038360108, 0.000665865452239553, -0.000816332162203236, -0.00177382913521060, -0.000911957710963548, 0.00126274639089030, 0.00254599785197993, 0.00119733493481360, -0.00188298883432695, -0.00354369458049196, -0.00151685212622968, 0.00272779656450504, 0.00481532178960400, 0.00186296024772780, -0.00386354139677245, -0.00642521516611152, -0.00222550571371127, 0.00538243640005939, 0.00846605162099258, 0.00259215799409269, -0.00742229885590284, -0.0110854266837481, -0.00294952555849002, 0.0102082964516512, 0.0145406925245107, 0.00328346668466473, -0.0141499399473485, -0.0193309086282212, -0.00357979828755701, 0.0200969128979563, 0.0265683984078155, 0.00382562538269158, -0.0301733841938447, -0.0392988908601045, -0.00400986239956292, 0.0516171374349632, 0.0697678224436065, 0.00412388283250039, -0.135158465095099, -0.277442591451597, 0.662504031041749, -0.277442591451597, -0.135158465095099, 0.00412388283250039, 0.0697678224436065, 0.0516171374349632, -0.00400986239956292, -0.0392988908601045, -0.0301733841938447, 0.00382562538269158, 0.0265683984078155, 0.0200969128979563, -0.00357979828755701, -0.0193309086282212, -0.0141499399473485, 0.00328346668466473, 0.0145406925245107, 0.0102082964516512, -0.00294952555849002, -0.0110854266837481, -0.00742229885590284, 0.00259215799409269, 0.00846605162099258, 0.00538243640005939, -0.00222550571371127, -0.00642521516611152, -0.00386354139677245, 0.00186296024772780, 0.00481532178960400, 0.00272779656450504, -0.00151685212622968, -0.00354369458049196, -0.00188298883432695, 0.00119733493481360, 0.00254599785197993, 0.00126274639089030, -0.000911957710963548, -0.00177382913521060, -0.000816332162203236, 0.000665865452239553, 0.00118813038360108, 0.000503496026963570, -0.000461619506027581, -0.000755737883023330, -0.000291860363810950, 0.000299012398223559, 0.000447502003880196, 0.000155157397306870, -0.000174286613119065, -0.000385543776213135, -3.71378189903913e-06};
+const float hp[101] = {-3.71378189903913e-06, -0.000385543776213135, -0.000174286613119065, 0.000155157397306870, 0.000447502003880196, 0.000299012398223559, -0.000291860363810950, -0.000755737883023330, -0.000461619506027581, 0.000503496026963570, 0.00118813038360108, 0.000665865452239553, -0.000816332162203236, -0.00177382913521060, -0.000911957710963548, 0.00126274639089030, 0.00254599785197993, 0.00119733493481360, -0.00188298883432695, -0.00354369458049196, -0.00151685212622968, 0.00272779656450504, 0.00481532178960400, 0.00186296024772780, -0.00386354139677245, -0.00642521516611152, -0.00222550571371127, 0.00538243640005939, 0.00846605162099258, 0.00259215799409269, -0.00742229885590284, -0.0110854266837481, -0.00294952555849002, 0.0102082964516512, 0.0145406925245107, 0.00328346668466473, -0.0141499399473485, -0.0193309086282212, -0.00357979828755701, 0.0200969128979563, 0.0265683984078155, 0.00382562538269158, -0.0301733841938447, -0.0392988908601045, -0.00400986239956292, 0.0516171374349632, 0.0697678224436065, 0.00412388283250039, -0.135158465095099, -0.277442591451597, 0.662504031041749, -0.277442591451597, -0.135158465095099, 0.00412388283250039, 0.0697678224436065, 0.0516171374349632, -0.00400986239956292, -0.0392988908601045, -0.0301733841938447, 0.00382562538269158, 0.0265683984078155, 0.0200969128979563, -0.00357979828755701, -0.0193309086282212, -0.0141499399473485, 0.00328346668466473, 0.0145406925245107, 0.0102082964516512, -0.00294952555849002, -0.0110854266837481, -0.00742229885590284, 0.00259215799409269, 0.00846605162099258, 0.00538243640005939, -0.00222550571371127, -0.00642521516611152, -0.00386354139677245, 0.00186296024772780, 0.00481532178960400, 0.00272779656450504, -0.00151685212622968, -0.00354369458049196, -0.00188298883432695, 0.00119733493481360, 0.00254599785197993, 0.00126274639089030, -0.000911957710963548, -0.00177382913521060, -0.000816332162203236, 0.000665865452239553, 0.00118813038360108, 0.000503496026963570, -0.000461619506027581, -0.000755737883023330, -0.000291860363810950, 0.000299012398223559, 0.000447502003880196, 0.000155157397306870, -0.000174286613119065, -0.000385543776213135, -3.71378189903913e-06};
 
 int dip_value;	//gets the number corresponding to the dip  switches pressed
 float presentsamp; 	/*present sample is defined as a global variable as
 			it gets the value from processBuffer and is used in blinkLED simulatenously*/
 
 /*
- * Data buffer declarations - the program uses four logical buffers of size
- * BUFFSIZE, one ping and one pong buffer on both receive and transmit sides.
+ * Data buffer declarations - the program uses gRingDepth logical buffers of
+ * gBuffSize words, received into, processed in place and transmitted from;
+ * buffer k starts at word k * gBuffSize of the pool.  Settings out of
+ * range, or too large for the pool, fall back to BUFFSIZE and RING_DEPTH.
+ * Muted frames are sent from gBufferMute, one word, instead.
+ */
+int gBuffSize = BUFFSIZE;
+int gRingDepth = RING_DEPTH;
+
+#ifdef _TMS320C6X
+#pragma DATA_ALIGN(gBufferRcv, 8)
+#endif
+Int16 gBufferRcv[RING_POOL_WORDS];  // Receive and transmit buffers
+Int16 gBufferMute;                  // Silence for muted frames
+Uint32 gXmtMuted;                   // bit k: buffer k sends gBufferMute
+
+/*
+ * Equalizer state.  gEqBank holds the coefficients for every DIP setting,
+ * and gEqActive points at the entry for the current one.
+ */
+#ifdef _TMS320C6X
+#pragma DATA_ALIGN(gEqBank, 8)
+#endif
+EqBank gEqBank;
+EqEngine gEqEngine;
+const EqCoefSet * volatile gEqActive;
+
+/*
+ * gEqEngineMode selects direct-form or FFT filtering at start-up.  The FFT
+ * mode keeps an EQ_BANK_FFT_N-point spectrum (BUFFSIZE/2 + num_of_coeffs - 1
+ * rounded up to a power of 2) for each of the EQ_BANK_FILTERS filtering DIP
+ * settings.  Frames that need a longer transform (2048 words and up) leave
+ * every setting in direct form.
+ */
+int gEqEngineMode = EQ_ENGINE_DIRECT;
+float gEqSpectra[EQ_BANK_SPECTRA];
+
+/*
+ * gEqAudioPath and gEqMeterPath pick the FIRs or the biquad crossovers
+ * (EQ_PATH_*) for the output and for the LED meters.  The codec runs at
+ * EQ_SAMPLE_RATE (register 8 above).
+ */
+#define EQ_SAMPLE_RATE 8000.0f
+int gEqAudioPath = EQ_PATH_FIR;
+int gEqMeterPath = EQ_PATH_FIR;
+
+/*
+ * Frame timing, stamped with CLK_gethtime() in edmaHwi() and processFrame()
+ * (see eq_stats.h).  Read gEqStats from the debugger, or call dumpStats().
+ */
+EqStats gEqStats;
+
+/*
+ * Every frame's band powers go to gEqEnergy (see eq_energy.h).  blinkLED()
+ * drains them through gLedReader; other consumers attach their own reader.
+ */
+EqEnergyRing gEqEnergy;
+EqEnergyReader gLedReader;
+
+/*
+ * Each LED and each motor lights for energy that stands out from its own
+ * band's recent level (see eq_adapt.h); nothing lights for the first
+ * gAdaptWarmup seconds.
+ */
+float gAdaptWarmup = EQ_ADAPT_WARMUP;
+EqAdapt gLedAdapt[EQ_NUM_BANDS];
+
+/*
+ * Motor packets for the tactile sleeve (see eq_tactile.h), one every
+ * TACTILE_INTERVAL seconds of audio, built from the frames as they are
+ * filtered.  gTactileSink, if set before main(), gets each packet;
+ * gEqTactile.last always holds the latest.
+ *
+ * With gTactileHop set before main(), the packets come from the sliding
+ * DFT of eq_sdft.h instead: one every gTactileHop seconds, each over the
+ * last TACTILE_INTERVAL seconds.
+ */
+#define TACTILE_INTERVAL 0.1f
+EqTactile gEqTactile;
+EqTactileSink gTactileSink;
+void *gTactileArg;
+float gTactileHop;
+EqSdft gEqSdft;
+
+/*
+ * gTactileOnsets, set before main(), lets the band onsets of eq_onset.h
+ * run the motors too (EQ_TACTILE_ONSETS) or alone
+ * (EQ_TACTILE_ONSETS_ONLY); see eq_tactile.h.
  */
-Int16 gBufferXmtPing[BUFFSIZE];  // Transmit PING buffer
-//Int16 gBufferXmtSing[BUFFSIZE];  // Transmit SING buffer
-Int16 gBufferXmtPong[BUFFSIZE];  // Transmit PONG buffer
+Uint32 gTactileOnsets = EQ_TACTILE_LEVEL;
+EqOnset gEqOnset;
 
-Int16 gBufferRcvPing[BUFFSIZE];  // Receive PING buffer
-//Int16 gBufferRcvSing[BUFFSIZE];  // Receive SING buffer
-Int16 gBufferRcvPong[BUFFSIZE];  // Receive PONG buffer
+/*
+ * With gTactileSched set before main(), gTactileSink gets the packets
+ * through the sample-clock scheduler of eq_sched.h instead, each
+ * gSchedDelay seconds after the end of its interval.  By default that is
+ * when the interval's last sample is heard: the codec plays a frame
+ * gRingDepth frames after receiving it, and the filters delay it by
+ * another (EQ_FIR_TAPS - 1) / 2 samples.  edmaHwi() runs its clock and
+ * hapticTick() fills in between frames.
+ */
+#define SCHED_TICK_MS 1.0f
+int gTactileSched;
+float gSchedDelay;
+EqSched gEqSched;
 
 EDMA_Handle hEdmaXmt;            // EDMA channel handles
-EDMA_Handle hEdmaReloadXmtPing;
-EDMA_Handle hEdmaReloadXmtPong;
+EDMA_Handle hEdmaReloadXmt[MAX_RING];  // reload entry k: buffer k (or mute)
 EDMA_Handle hEdmaRcv;
-EDMA_Handle hEdmaReloadRcvPing;
-EDMA_Handle hEdmaReloadRcvPong;
+EDMA_Handle hEdmaReloadRcv[MAX_RING];
 
 MCBSP_Handle hMcbsp1;                 // McBSP1 (codec data) handle
 
@@ -196,7 +337,7 @@ EDMA_Config gEdmaConfigXmt = {
     EDMA_FMKS(OPT, LINK, YES)          |  // Enable link parameters?
     EDMA_FMKS(OPT, FS, NO),               // Use frame sync?
 
-    (Uint32)&gBufferXmtPing,              // Src address
+    EDMA_SRC_OF(gBufferRcv),              // Src address
 
     EDMA_FMK (CNT, FRMCNT, NULL)       |  // Frame count
     EDMA_FMK (CNT, ELECNT, BUFFSIZE),     // Element count
@@ -228,7 +369,7 @@ EDMA_Config gEdmaConfigRcv = {
     EDMA_FMK (CNT, FRMCNT, NULL)       |  // Frame count
     EDMA_FMK (CNT, ELECNT, BUFFSIZE),     // Element count
 
-    (Uint32)&gBufferRcvPing,              // Dest address
+    EDMA_DST_OF(gBufferRcv),              // Dest address
 
     EDMA_FMKS(IDX, FRMIDX, DEFAULT)    |  // Frame index value
     EDMA_FMKS(IDX, ELEIDX, DEFAULT),      // Element index value
@@ -322,6 +463,8 @@ AIC23_Params config = {
  */
 void main()
 {
+    Uint32 i;
+
     /* Initialize Board Support Library */
     DSK6713_init();
 
@@ -333,8 +476,53 @@ void main()
 	CSL_init();
 
 
-    /* Clear buffers */
-    memset((void *)gBufferXmtPing, 0, BUFFSIZE * 4 * 2);
+    /* Check the ring settings and clear the buffers */
+    if (gBuffSize < MIN_BUFFSIZE || gBuffSize > MAX_BUFFSIZE ||
+        (gBuffSize & 1) || gRingDepth < MIN_RING || gRingDepth > MAX_RING ||
+        gBuffSize * gRingDepth > RING_POOL_WORDS)
+    {
+        gBuffSize = BUFFSIZE;
+        gRingDepth = RING_DEPTH;
+    }
+    memset((void *)gBufferRcv, 0, sizeof(gBufferRcv));
+    gBufferMute = 0;
+
+    /* Build every filter combination once, starting muted */
+    eqBankInit(&gEqBank, lp, bp, hp);
+    gEqActive = &gEqBank.set[0];
+    eqEngineInit(&gEqEngine, gEqActive, lp1, bp1, hp1, EQ_XFADE_WORDS);
+    if (gEqEngineMode == EQ_ENGINE_FFT && eqEngineSetFft(&gEqEngine, gBuffSize) == 0 &&
+        eqBankPrepareFft(&gEqBank, &gEqEngine.fft, gEqSpectra,
+                         sizeof(gEqSpectra) / sizeof(gEqSpectra[0])) != 0)
+        gEqEngine.engine = EQ_ENGINE_DIRECT;    // spectra too long for gEqSpectra
+    eqEngineSetPaths(&gEqEngine, gEqAudioPath, gEqMeterPath, EQ_SAMPLE_RATE);
+    eqEnergyInit(&gEqEnergy);
+    eqEnergyReaderInit(&gEqEnergy, &gLedReader);
+    for (i = 0; i < EQ_NUM_BANDS; i++)
+        eqAdaptInit(&gLedAdapt[i], gBuffSize / 2 / EQ_SAMPLE_RATE,
+                    EQ_ADAPT_TAU, EQ_ADAPT_K, gAdaptWarmup);
+    if (gTactileHop > 0.0f &&
+        eqSdftInit(&gEqSdft, EQ_SAMPLE_RATE, EQ_IIR_LO_HZ, EQ_IIR_HI_HZ,
+                   gTactileHop, TACTILE_INTERVAL, eqTactileSdftSink,
+                   &gEqTactile) != 0)
+        gTactileHop = 0.0f;     // window too long for the hop
+    eqTactileInit(&gEqTactile, EQ_SAMPLE_RATE,
+                  gTactileHop > 0.0f ? gTactileHop : TACTILE_INTERVAL,
+                  gAdaptWarmup, gTactileSched ? eqSchedSink : gTactileSink,
+                  gTactileSched ? (void *)&gEqSched : gTactileArg);
+    eqTactileOnsets(&gEqTactile, gTactileOnsets);
+    eqOnsetInit(&gEqOnset, EQ_SAMPLE_RATE, EQ_ONSET_TAU, EQ_ONSET_K,
+                EQ_ONSET_HOLD, gAdaptWarmup, eqTactileOnsetSink, &gEqTactile);
+    eqSchedInit(&gEqSched, EQ_SAMPLE_RATE, gBuffSize / 2, SCHED_TICK_MS,
+                gEqTactile.interval,
+                gSchedDelay > 0.0f ? (Uint32)(gSchedDelay * EQ_SAMPLE_RATE)
+                                   : gRingDepth * gBuffSize / 2 +
+                                     (EQ_FIR_TAPS - 1) / 2,
+                gTactileSink, gTactileArg);
+
+    /* frame periods at the rate the codec is about to get */
+    eqStatsInit(&gEqStats, CLK_countspms(), gBuffSize / 2, gRingDepth,
+                eqStatsCodecRate(config.regs[8]));
 
     AIC23_setParams(&config);  // Configure the codec
 
@@ -384,56 +572,57 @@ void initIrq(void)
 
 /*
  *  initEdma() - Initialize the DMA controller.  Use linked transfers to
- *               automatically transition from ping to pong and visa-versa.
+ *               automatically move from each buffer of the ring to the next
+ *               and from the last back to the first.
  */
 void initEdma(void)
 {
+    int k;
+
     /* Configure transmit channel */
     hEdmaXmt = EDMA_open(EDMA_CHA_XEVT1, EDMA_OPEN_RESET);  // get hEdmaXmt handle and reset channel
-    hEdmaReloadXmtPing = EDMA_allocTable(-1);               // get hEdmaReloadXmtPing handle
-    hEdmaReloadXmtPong = EDMA_allocTable(-1);               // get hEdmaReloadXmtPong handle
+    for (k = 0; k < gRingDepth; k++)
+        hEdmaReloadXmt[k] = EDMA_allocTable(-1);            // get a reload handle per buffer
 
-
-	gEdmaConfigXmt.dst = MCBSP_getXmtAddr(hMcbsp1);         // set the desination address to McBSP1 DXR
+    gEdmaConfigXmt.dst = MCBSP_getXmtAddr(hMcbsp1);         // set the desination address to McBSP1 DXR
+    gEdmaConfigXmt.cnt = EDMA_FMK(CNT, FRMCNT, NULL) |
+                         EDMA_FMK(CNT, ELECNT, gBuffSize);  // one frame per transfer
 
     gXmtChan = EDMA_intAlloc(-1);                           // get an open TCC
 
     gEdmaConfigXmt.opt |= EDMA_FMK(OPT,TCC,gXmtChan);       // set TCC to gXmtChan
 
-    EDMA_config(hEdmaXmt, &gEdmaConfigXmt);                 // then configure the registers
-    EDMA_config(hEdmaReloadXmtPing, &gEdmaConfigXmt);       // and the reload for Ping
-
-
-    gEdmaConfigXmt.src = EDMA_SRC_OF(gBufferXmtPong);       // change the structure to have a source of Pong
-    EDMA_config(hEdmaReloadXmtPong, &gEdmaConfigXmt);       // and configure the reload for Pong
-
-
-
-    EDMA_link(hEdmaXmt,hEdmaReloadXmtPong);                 // link the regs to Pong
-    EDMA_link(hEdmaReloadXmtPong,hEdmaReloadXmtPing);       // link Pong to Ping
-    EDMA_link(hEdmaReloadXmtPing,hEdmaReloadXmtPong);       // and link Ping to Pong
+    gXmtMuted = 0;
+    for (k = gRingDepth - 1; k >= 0; k--)
+    {
+        gEdmaConfigXmt.src = EDMA_SRC_OF(gBufferRcv + k * gBuffSize);  // send from the receive buffer
+        EDMA_config(hEdmaReloadXmt[k], &gEdmaConfigXmt);    // configure the reload for buffer k
+        EDMA_link(hEdmaReloadXmt[k], hEdmaReloadXmt[(k + 1) % gRingDepth]);  // and link it to the next
+    }
+    EDMA_config(hEdmaXmt, &gEdmaConfigXmt);                 // then configure the registers for buffer 0
+    EDMA_link(hEdmaXmt, hEdmaReloadXmt[1 % gRingDepth]);    // link the regs to buffer 1
 
 
     /* Configure receive channel */
     hEdmaRcv = EDMA_open(EDMA_CHA_REVT1, EDMA_OPEN_RESET);  // get hEdmaRcv handle and reset channel
-    hEdmaReloadRcvPing = EDMA_allocTable(-1);               // get hEdmaReloadRcvPing handle
-    hEdmaReloadRcvPong = EDMA_allocTable(-1);               // get hEdmaReloadRcvPong handle
+    for (k = 0; k < gRingDepth; k++)
+        hEdmaReloadRcv[k] = EDMA_allocTable(-1);            // get a reload handle per buffer
 
     gEdmaConfigRcv.src = MCBSP_getRcvAddr(hMcbsp1);         // and the desination address to McBSP1 DXR
+    gEdmaConfigRcv.cnt = EDMA_FMK(CNT, FRMCNT, NULL) |
+                         EDMA_FMK(CNT, ELECNT, gBuffSize);
 
     gRcvChan = EDMA_intAlloc(-1);                           // get an open TCC
     gEdmaConfigRcv.opt |= EDMA_FMK(OPT,TCC,gRcvChan);       // set TCC to gRcvChan
 
-
-    EDMA_config(hEdmaRcv, &gEdmaConfigRcv);                 // then configure the registers
-    EDMA_config(hEdmaReloadRcvPing, &gEdmaConfigRcv);       // and the reload for Ping
-
-    gEdmaConfigRcv.dst = EDMA_DST_OF(gBufferRcvPong);       // change the structure to have a destination of Pong
-    EDMA_config(hEdmaReloadRcvPong, &gEdmaConfigRcv);       // and configure the reload for Pong
-
-    EDMA_link(hEdmaRcv,hEdmaReloadRcvPong);                 // link the regs to Pong
-    EDMA_link(hEdmaReloadRcvPong,hEdmaReloadRcvPing);       // link Pong to Ping
-    EDMA_link(hEdmaReloadRcvPing,hEdmaReloadRcvPong);       // and link Ping to Pong
+    for (k = gRingDepth - 1; k >= 0; k--)
+    {
+        gEdmaConfigRcv.dst = EDMA_DST_OF(gBufferRcv + k * gBuffSize);
+        EDMA_config(hEdmaReloadRcv[k], &gEdmaConfigRcv);    // configure the reload for buffer k
+        EDMA_link(hEdmaReloadRcv[k], hEdmaReloadRcv[(k + 1) % gRingDepth]);  // and link it to the next
+    }
+    EDMA_config(hEdmaRcv, &gEdmaConfigRcv);                 // then configure the registers for buffer 0
+    EDMA_link(hEdmaRcv, hEdmaReloadRcv[1 % gRingDepth]);    // link the regs to buffer 1
 
     /* Enable interrupts in the EDMA controller */
     EDMA_intClear(gXmtChan);
@@ -466,8 +655,9 @@ void initEdma(void)
  */
 void edmaHwi(void)
 {
-    static Uint32 pingOrPong = PING;  // Ping-pong state variable
+    static Uint32 ringIndex = 0;      // buffer the EDMA just finished
     static Int16 xmtdone = 0, rcvdone = 0;
+    Uint32 now = CLK_gethtime();
 
     /* Check CIPR to see which transfer completed */
     if (EDMA_intTest(gXmtChan))
@@ -484,15 +674,11 @@ void edmaHwi(void)
     /* If both transfers complete, signal processBufferSwi to handle */
     if (xmtdone && rcvdone)
     {
-        if (pingOrPong==PING)
-        {
-            SWI_or(&processBufferSwi, PING);
-            pingOrPong = PONG;
-        } else
-        {
-            SWI_or(&processBufferSwi, PONG);
-            pingOrPong = PING;
-        }
+        eqStatsIsr(&gEqStats, now, ringIndex);
+        if (gTactileSched)
+            eqSchedFrame(&gEqSched);
+        SWI_or(&processBufferSwi, 1u << ringIndex);
+        ringIndex = (ringIndex + 1) % gRingDepth;
         rcvdone = 0;
         xmtdone = 0;
     }
@@ -502,276 +688,96 @@ void edmaHwi(void)
 /* ------------------------------- Threads ------------------------------ */
 
 /*
- *  processBuffer() - Process audio data once it has been received.
+ *  processBuffer() - Process audio data once it has been received.  The
+ *                    mailbox has bit k set for each buffer k posted by
+ *                    edmaHwi(); if the SWI was held off for more than one
+ *                    frame there are several, taken in ring order.
  */
 void processBuffer(void)
 {
-    Uint32 pingPong;
-	int j, n, x, y, z;
-	int n1=0;
-	float output;
-	float output_left=0.0, output_right=0.0;
-	Int i;
-	float h[101] = {0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0};
-	int k=0;
-
-switch (dip_value)
- {//depending on the switches chosen/ON, generate the h value.
- case 0:
-	k=2; //no pass
-	x=0, y=0, z=0;
-	break;
- case 1:
-	for(i=0;i<num_of_coeffs;i++)
-	h[i] = lp[i];
-	x=0, y=0, z=1;
-	break;
- case 2:
-	for(i=0;i<num_of_coeffs;i++)
-	h[i] = bp[i];
-	x=0, y=1, z=0;
-	break;
- case 3:
-	for(i=0;i<num_of_coeffs;i++)
-	h[i] = lp[i]+bp[i];
-	x=0, y=1, z=1;
-	break;
- case 4:
-	for(i=0;i<num_of_coeffs;i++)
-	h[i] = hp[i];
-	x=1, y=0, z=0;
-	break;
- case 5:
-	for(i=0;i<num_of_coeffs;i++)
-	h[i] = hp[i]+lp[i];
-	x=1, y=0, z=1;
-	break;
- case 6:
-	for(i=0;i<num_of_coeffs;i++)
-	h[i] = hp[i]+bp[i];
-	x=1, y=1, z=0;
-	break;
- case 7:
-	for(i=0;i<num_of_coeffs;i++)
-	h[i] = hp[i]+bp[i]+lp[i];
-	x=1, y=1, z=1;
-	break;
- default:
-	k=1; //by-pass
- }
-
-
-PLP=0.0, PBP=0.0, PHP=0.0;
-    /* Get contents of mailbox posted by edmaHwi */
-    pingPong =  SWI_getmbox();
-
-if (k==0)//one or more of the switches is ON
-{
-   /*filtering signal to produce a better sound output*/
-  if (pingPong == PING)
-  {
-	for(i=0;i<1024;i++) // each buffer length = 1024
-	{//compute one filtered output sample, and repeat 1024 times for the entire buffer
-		output_left = 0.0,output_right=0.0, j=0; //output_left => filtered signal for left channel
-		for(n=i+1;n>i-201;n--) // filter left and right channels seperately
-                          // using 101 samples on each channel => total 202 samples
-		{
-		if(n<0) //if samples required are in the previous buffer
-			{
-			n1 = 1024+n; // take the last few samples from PONG, since current buffer is PING
-			output_left += h[j]*gBufferRcvPong[n1];
-			}
-		else
-			{
-			output_left += h[j]*gBufferRcvPing[n];
-			}
-		n--;
-    //left & right channel samples alternate
-    //so repeat the process for each channel
-		if(n<0)
-			{
-			n1 = 1024+n;
-			output_right += h[j]*gBufferRcvPong[n1];
-			}
-		else
-			{
-			output_right += h[j]*gBufferRcvPing[n];
-			}
-		j++;  //get next filter coefficient to multiply
-		}
-    // put the alternate output samples in Ping buffer for transmission
-		gBufferXmtPing[i] = output_right;
-		i++;
-		gBufferXmtPing[i] = output_left;
-	}
+    static Uint32 next = 0;           // buffer expected first
+    Uint32 mailbox, first, k, buf;
 
-	/*Low Pass filtering for LED display */
-    if(z==1)
-    {
-    AvgPLP=0.0, PLP=0.0;
-	for(i=0;i<1024;i++)
-	  {
-		output = 0.0, j=0;
-		for(n=i+1;n>i-12;n--)
-		{
-		output += lp1[j]*gBufferRcvPing[n];
-		j++;
-		}
-		PLP += output*output;//LPF Power for each output sample added up
-		}
-		AvgPLP = PLP/1024; //Avg. mean square value for the whole buffer
-    }
+    /* Get contents of mailbox posted by edmaHwi */
+    mailbox = SWI_getmbox();
 
-	/*Band Pass filtering for LED display */
-	if(y==1)
+    first = next;
+    for (k = 0; k < gRingDepth; k++)
     {
-	AvgPBP=0.0, PBP=0.0;
-	for(i=0;i<1024;i++)
-	  {
-		output = 0.0, j=0;
-		for(n=i+1;n>i-12;n--)
-		{
-		output += bp1[j]*gBufferRcvPing[n];
-		j++;
-		}
-		PBP += output*output;
-  	  }
-		AvgPBP = PBP/1024;
+        buf = (first + k) % gRingDepth;
+        if (mailbox & (1u << buf))
+        {
+            processFrame(buf);
+            next = (buf + 1) % gRingDepth;
+        }
     }
+}
 
-	/*High Pass filtering for LED display */
-	if(x==1)
-    {
-    AvgPHP=0.0, PHP=0.0;
-	for(i=0;i<1024;i++)
-	  {
-		output = 0.0, j=0;
-		for(n=i+1;n>i-12;n--)
-		{
-		output += hp1[j]*gBufferRcvPing[n];
-		j++;
-		}
-		PHP = output*output;
-		}
-		AvgPHP = PHP/1024;
-    }
- } 	//end of Ping
+/*
+ *  processFrame() - Filter ring buffer buf in place and publish its band
+ *                   powers.
+ */
+void processFrame(Uint32 buf)
+{
+	Int16 *frame = gBufferRcv + buf * gBuffSize;
+	EqMeters meters;
+	Uint32 mode = dip_value, out;
 
-/*filtering signal to produce a better sound output*/
-  else
-   {
- 	for(i=0;i<1024;i++)
-	{
-		output_left = 0.0,output_right=0.0, j=0, n1=0;
+	eqStatsStart(&gEqStats, CLK_gethtime(), buf);
 
-		for(n=i+1;n>i-201;n--)
-		{
-			if(n<0)
-			{
-				n1 = 1024+n;
-				output_left += h[j]*gBufferRcvPing[n1];
-			}
-			else
-			{
-				output_left += h[j]*gBufferRcvPong[n];
-			}
-			n--;
-			if(n<0)
-			{
-				n1 = 1024+n;
-				output_right += h[j]*gBufferRcvPing[n1];
-			}
-			else
-			{
-				output_right += h[j]*gBufferRcvPong[n];
-			}
-		j++;
-		}
-		gBufferXmtPong[i] = output_right;
-		i++;
-		gBufferXmtPong[i] = output_left;
-	}
+	/* the sliding DFT takes the input, before it is filtered over */
+	if (gTactileHop > 0.0f)
+		eqSdftPush(&gEqSdft, frame, gBuffSize);
 
-	/*Low Pass filtering for LED display */
-	if(z==1)
-    {
-	AvgPLP=0.0, PLP=0.0;
-	for(i=0;i<1024;i++)
-	  {
-		output = 0.0, j=0;
-		for(n=i+1;n>i-24;n--)
-		{
-		output += lp1[j]*gBufferRcvPong[n];
-		j++;
-		}
-		PLP += output*output;
-  	  }
-		AvgPLP = PLP/1024;
-    }
+    /* filter (or pass, or mute) with the coefficient set load() published
+       for the current DIP switches */
+    out = eqEngineProcessInPlace(&gEqEngine, EQ_ACQUIRE(gEqActive), frame,
+                                 gBuffSize, &meters);
+    setXmtSource(buf, out == EQ_MODE_MUTE);
 
-	/*Band Pass filtering for LED display */
-	if(y==1)
-    {
-    AvgPBP=0.0, PBP=0.0;
-	for(i=0;i<1024;i++)
-	  {
-		output = 0.0, j=0;
-		for(n=i+1;n>i-12;n--)
-		{
-		output += bp1[j]*gBufferRcvPong[n];
-		j++;
-		}
-		PBP += output*output;
-  	  }
-		AvgPBP = PBP/1024;
-    }
+	/* meters holds every band's power; the consumers pick what they show */
+	eqEnergyPublish(&gEqEnergy, &meters, gBuffSize, CLK_gethtime());
+	if (gTactileOnsets != EQ_TACTILE_LEVEL)
+		eqOnsetPush(&gEqOnset, &meters, gBuffSize);
+	if (gTactileHop <= 0.0f)
+		eqTactilePush(&gEqTactile, &meters, gBuffSize);
 
-	/*High Pass filtering for LED display */
-	if(x==1)
-    {
-    AvgPHP=0.0, PHP=0.0;
-	for(i=0;i<1024;i++)
-	  {
-		output = 0.0, j=0;
-		for(n=i+1;n>i-12;n--)
-		{
-		output += hp1[j]*gBufferRcvPong[n];
-		j++;
-		}
-		PHP += output*output;
-  	  }
-		AvgPHP = PHP/1024;
-    }
- } 	//end of Pong
-} 	//end of k=0
+	eqStatsEnd(&gEqStats, CLK_gethtime(), buf, mode);
+} //end of processFrame()
 
-else if(k==1) //all pass filter when switch 3 is pressed
-{
-   if (pingPong == PING)
-   {	for(i=0;i<1024;i++)
-		gBufferXmtPing[i] = gBufferRcvPing[i];
-   }	//end of Ping
-
-   else
-   {	for(i=0;i<1024;i++)
-		gBufferXmtPong[i] = gBufferRcvPong[i];
-   } 	//end of Pong
-} 	//end of k=1
-
-else 	// no pass filter when no switch is pressed
+/*
+ *  setXmtSource() - Send ring buffer buf from the buffer itself, or muted
+ *                   from gBufferMute.  Its reload entry is next loaded when
+ *                   the transfer before it ends, a ring after buf was
+ *                   filled, so it is free to change until that deadline.
+ */
+void setXmtSource(Uint32 buf, Uint32 muted)
 {
-   if (pingPong == PING)
-   {	for(i=0;i<1024;i++)
-		gBufferXmtPing[i] = 0;
-   }	//end of Ping
+	EDMA_Config cfg = gEdmaConfigXmt;
 
+	if (((gXmtMuted >> buf) & 1) == muted)
+		return;
+	if (muted)
+	{
+		cfg.opt &= ~EDMA_FMKS(OPT, SUM, INC);    // SUM NONE: one word
+		cfg.src = EDMA_SRC_OF(&gBufferMute);
+	}
+	else
+		cfg.src = EDMA_SRC_OF(gBufferRcv + buf * gBuffSize);
+	EDMA_config(hEdmaReloadXmt[buf], &cfg);
+	EDMA_link(hEdmaReloadXmt[buf], hEdmaReloadXmt[(buf + 1) % gRingDepth]);
+	gXmtMuted ^= 1u << buf;
+}
 
-   else
-   {	for(i=0;i<1024;i++)
-		gBufferXmtPong[i] = 0;
-   } 	//end of Pong
-} 	//end of k=2
-} //end of processBuffer()
+/*
+ *  dumpStats() - Print the frame timing statistics (eq_stats.h) through
+ *                stdio.  Not for the audio threads: on the DSK each line
+ *                halts the CPU while the debugger collects it.
+ */
+void dumpStats(void)
+{
+	eqStatsDump(&gEqStats, stdout);
+}
 
 /*
  *  blinkLED() - Periodic thread (PRD) that toggles LED #0 every 500ms if
@@ -780,33 +786,50 @@ else 	// no pass filter when no switch is pressed
  *               PRD --> PRD_blinkLed.  The period is set there at 500
  *               ticks, with each tick corresponding to 1ms in real
  *               time.
+ *
+ *               Each LED lights if any frame since the last call passed
+ *               its band with energy above the band's adaptive threshold.
  */
 void blinkLED(void)
 {
-		if(AvgPLP>800000)
+	EqEnergyRecord rec;
+	Uint32 on = 0, b;
+
+	/* drain every frame published since the last call; every frame
+	   trains the thresholds, whether or not its band is passed */
+	while (eqEnergyRead(&gEqEnergy, &gLedReader, &rec))
+	{
+		for (b = 0; b < EQ_NUM_BANDS; b++)
+		{
+			float avg = rec.meters.power[b] / rec.words; //Avg. mean square value for the whole buffer
+
+			if (eqAdaptStep(&gLedAdapt[b], avg / EQ_FULL_SCALE2) &&
+			    (rec.meters.bands & (1u << b)))
+				on |= 1u << b;
+		}
+	}
+
+		if(on & EQ_BAND_LP)
 		{
 		DSK6713_LED_on(0);
-		AvgPLP=0.0;
 		}
 		else
 		{
 		DSK6713_LED_off(0);
 		}
 
-		if(AvgPBP>400000)
+		if(on & EQ_BAND_BP)
 		{
 		DSK6713_LED_on(1);
-		AvgPBP=0.0;
 		}
 		else
 		{
 		DSK6713_LED_off(1);
 		}
 
-		if(AvgPHP>125)
+		if(on & EQ_BAND_HP)
 		{
 		DSK6713_LED_on(2);
-		AvgPHP=0.0;
 		}
 		else
 		{
@@ -816,6 +839,20 @@ void blinkLED(void)
 }
 
 
+/*
+ *  hapticTick() - PRD that releases the motor packets that have come due
+ *                 on the sample clock (see eq_sched.h).  The thread is
+ *                 configured in the DSP/BIOS configuration tool under
+ *                 Scheduling --> PRD PRD_hapticTick, with a period of 1
+ *                 tick (SCHED_TICK_MS).
+ */
+void hapticTick(void)
+{
+	if (gTactileSched)
+		eqSchedTick(&gEqSched);
+}
+
+
 /*
  *  load() - PRD that simulates a 20-25% dummy load on a 225MHz 6713 if
  *           DIP switch #1 is depressed.  The thread is configured in
@@ -825,5 +862,12 @@ void blinkLED(void)
  */
 void load(void)
 {
+	const EqCoefSet *set;
+
 	dip_value=(!(DSK6713_DIP_get(3))*8)+(!(DSK6713_DIP_get(2))*4)+(!(DSK6713_DIP_get(1))*2)+(!(DSK6713_DIP_get(0))*1);
+
+	/* hand the matching precomputed coefficients to processBuffer() */
+	set = &gEqBank.set[dip_value];
+	if (set != gEqActive)
+		EQ_PUBLISH(gEqActive, set);
 }
@@ -0,0 +1,94 @@
+/*
+ *  ======== eq_adapt.c ========
+ *
+ *  Adaptive band threshold.  See eq_adapt.h.
+ */
+#include <math.h>
+
+#include "eq_adapt.h"
+
+#define EQ_ADAPT_TINY       1e-12f  // keeps log10 of silence finite
+
+void eqAdaptInit(EqAdapt *a, float step, float tau, float k, float warmup)
+{
+    float n = warmup / step;
+
+    a->alpha = (float)(1.0 - exp(-step / tau));
+    a->k = k;
+    a->warmup = (Uint32)n;
+    if ((float)a->warmup < n)
+        a->warmup++;
+    a->count = 0;
+    a->mean = 0.0f;
+    a->var = 0.0f;
+}
+
+int eqAdaptStep(EqAdapt *a, float ms)
+{
+    float db = 10.0f * (float)log10(ms + EQ_ADAPT_TINY);
+    float alpha = a->alpha, d, rise;
+    int on = 0;
+
+    if (a->count >= a->warmup && db > EQ_ADAPT_FLOOR_DB)
+    {
+        rise = a->k * (float)sqrt(a->var);
+        if (rise < EQ_ADAPT_MARGIN_DB)
+            rise = EQ_ADAPT_MARGIN_DB;
+        on = db > a->mean + rise;
+    }
+
+    /* running average until the EWMA weight takes over */
+    a->count++;
+    if (alpha < 1.0f / a->count)
+        alpha = 1.0f / a->count;
+    d = db - a->mean;
+    a->mean += alpha * d;
+    a->var = (1.0f - alpha) * (a->var + alpha * d * d);
+    return on;
+}
+
+void eqAdaptBankInit(EqAdaptBank *b, float step, float tau, float k,
+                     float warmup)
+{
+    EqAdapt a;
+    Uint32 i;
+
+    eqAdaptInit(&a, step, tau, k, warmup);
+    b->alpha = a.alpha;
+    b->k = k;
+    b->warmup = a.warmup;
+    b->count = 0;
+    for (i = 0; i < EQ_ADAPT_BANK; i++)
+        b->mean[i] = b->var[i] = 0.0f;
+}
+
+Uint32 eqAdaptBankStep(EqAdaptBank *b, const float ms[EQ_ADAPT_BANK])
+{
+    float db[EQ_ADAPT_BANK], alpha = b->alpha, rise;
+    Uint32 i, on = 0;
+
+    for (i = 0; i < EQ_ADAPT_BANK; i++)
+        db[i] = 10.0f * (float)log10(ms[i] + EQ_ADAPT_TINY);
+
+    if (b->count >= b->warmup)
+        for (i = 0; i < EQ_ADAPT_BANK; i++)
+        {
+            rise = b->k * (float)sqrt(b->var[i]);
+            if (rise < EQ_ADAPT_MARGIN_DB)
+                rise = EQ_ADAPT_MARGIN_DB;
+            if (db[i] > EQ_ADAPT_FLOOR_DB && db[i] > b->mean[i] + rise)
+                on |= 1u << i;
+        }
+
+    b->count++;
+    if (alpha < 1.0f / b->count)
+        alpha = 1.0f / b->count;
+    for (i = 0; i < EQ_ADAPT_BANK; i++)
+    {
+        float d = db[i] - b->mean[i];
+
+        b->mean[i] += alpha * d;
+        b->var[i] = (1.0f - alpha) * (b->var[i] + alpha * d * d);
+    }
+    return on;
+}
@@ -0,0 +1,78 @@
+/*
+ *  ======== eq_adapt.h ========
+ *
+ *  Adaptive on/off threshold for one band's energy, replacing cutoffs
+ *  that were tuned on a single song.  The tracker keeps an exponentially
+ *  weighted mean and variance of the energy in dB.  A value is "on" when
+ *  it is more than k standard deviations above the mean, with a margin of
+ *  at least EQ_ADAPT_MARGIN_DB.  In the log domain the decision does not
+ *  depend on level, so quiet and loud tracks need no calibration.
+ *
+ *  Each value is tested against the statistics of the values before it,
+ *  and is then added to them.  Each step costs O(1).  For the first
+ *  warm-up seconds the mean is a plain average of what has arrived, and
+ *  nothing is on.  Values below EQ_ADAPT_FLOOR_DB (full scale = 0 dB)
+ *  count as silence and are never on; callers divide a mean square by
+ *  EQ_FULL_SCALE2 to put it on that scale.
+ */
+#ifndef EQ_ADAPT_H
+#define EQ_ADAPT_H
+
+#include "eq_types.h"
+
+#define EQ_ADAPT_TAU        8.0f    // default time constant, seconds
+#define EQ_ADAPT_K          1.0f    // default standard deviations
+#define EQ_ADAPT_WARMUP     1.0f    // default warm-up, seconds
+#define EQ_ADAPT_MARGIN_DB  3.0f    // least rise over the mean that is on
+#define EQ_ADAPT_FLOOR_DB   (-90.0f)
+#define EQ_FULL_SCALE2      (32768.0f * 32768.0f)   // power of a full-scale word
+
+typedef struct EqAdapt {
+    float  alpha;       // weight of a new value
+    float  k;
+    Uint32 warmup;      // values before any is on
+    Uint32 count;       // values seen
+    float  mean;        // dB
+    float  var;         // dB^2
+} EqAdapt;
+
+/*
+ *  eqAdaptInit() - Track values that arrive every step seconds, with time
+ *                  constant tau and warm-up warmup (both in seconds), and
+ *                  a threshold k standard deviations above the mean.
+ */
+void eqAdaptInit(EqAdapt *a, float step, float tau, float k, float warmup);
+
+/*
+ *  eqAdaptStep() - Test the mean square ms (full scale = 1) against the
+ *                  threshold, then add it to the statistics.  Returns 1
+ *                  if it is on.
+ */
+int  eqAdaptStep(EqAdapt *a, float ms);
+
+/*
+ *  EqAdaptBank - EQ_ADAPT_BANK trackers that step together with the same
+ *                settings, laid out by field so one step runs down each
+ *                array.  Each tracker decides exactly as an EqAdapt would.
+ */
+#define EQ_ADAPT_BANK       8
+
+typedef struct EqAdaptBank {
+    float  alpha;
+    float  k;
+    Uint32 warmup;
+    Uint32 count;
+    float  mean[EQ_ADAPT_BANK];
+    float  var[EQ_ADAPT_BANK];
+} EqAdaptBank;
+
+void eqAdaptBankInit(EqAdaptBank *b, float step, float tau, float k,
+                     float warmup);
+
+/*
+ *  eqAdaptBankStep() - eqAdaptStep() for every tracker, tracker i taking
+ *                      ms[i].  Returns bit i set if tracker i is on.
+ */
+Uint32 eqAdaptBankStep(EqAdaptBank *b, const float ms[EQ_ADAPT_BANK]);
+
+#endif /* EQ_ADAPT_H */
@@ -0,0 +1,92 @@
+/*
+ *  ======== eq_bank.c ========
+ *
+ *  Coefficient bank construction.  See eq_bank.h.
+ */
+#include <string.h>
+
+#include "eq_bank.h"
+
+void eqBankBuild(EqCoefSet *set, Uint32 mode, Uint32 bands,
+                 const float *lp, const float *bp, const float *hp)
+{
+    int i;
+
+    memset(set->h, 0, sizeof(set->h));
+    memset(set->q, 0, sizeof(set->q));
+    set->qShift = 0;
+    set->symmetric = 0;
+    set->mode = mode;
+    set->bands = bands;
+    set->spectrum = NULL;
+    set->nband = NULL;
+
+    if (mode != EQ_MODE_FILTER)
+        return;
+
+    /* Same summation order as the original per-frame switch */
+    for (i = 0; i < EQ_FIR_TAPS; i++)
+    {
+        float h = 0.0f;
+
+        if (bands & EQ_BAND_HP)
+            h += hp[i];
+        if (bands & EQ_BAND_BP)
+            h += bp[i];
+        if (bands & EQ_BAND_LP)
+            h += lp[i];
+        set->h[i] = h;
+    }
+    set->qShift = eqFirQuantize(set->h, EQ_FIR_TAPS, set->q);
+    set->symmetric = eqFirIsSymmetric(set->h, EQ_FIR_TAPS);
+}
+
+void eqBankInit(EqBank *bank, const float *lp, const float *bp,
+                const float *hp)
+{
+    Uint32 dip;
+
+    eqBankBuild(&bank->set[0], EQ_MODE_MUTE, 0, lp, bp, hp);
+    for (dip = 1; dip <= EQ_BANK_FILTERS; dip++)
+        eqBankBuild(&bank->set[dip], EQ_MODE_FILTER, dip, lp, bp, hp);
+    for (dip = EQ_BANK_FILTERS + 1; dip < EQ_BANK_SIZE; dip++)
+        eqBankBuild(&bank->set[dip], EQ_MODE_BYPASS, 0, lp, bp, hp);
+}
+
+void eqBankBuildNBand(EqCoefSet *set, const EqNBand *nb)
+{
+    eqBankBuild(set, EQ_MODE_FILTER, 0, NULL, NULL, NULL);
+    eqNBandMix(nb, set->h);
+    set->qShift = eqFirQuantize(set->h, EQ_FIR_TAPS, set->q);
+    set->symmetric = eqFirIsSymmetric(set->h, EQ_FIR_TAPS);
+    set->nband = nb;
+}
+
+int eqBankPrepareFft(EqBank *bank, const EqFftPlan *plan, float *storage,
+                     Uint32 capacity)
+{
+    Uint32 i, need = 0;
+
+    /* all or none: a bank half in FFT mode would time each DIP setting
+       differently */
+    for (i = 0; i < EQ_BANK_SIZE; i++)
+    {
+        bank->set[i].spectrum = NULL;
+        if (bank->set[i].mode == EQ_MODE_FILTER)
+            need += plan->n;
+    }
+    if (need > capacity)
+        return -1;
+
+    for (i = 0; i < EQ_BANK_SIZE; i++)
+    {
+        EqCoefSet *set = &bank->set[i];
+
+        if (set->mode != EQ_MODE_FILTER)
+            continue;
+        eqFftSpectrum(plan, set->h, EQ_FIR_TAPS, storage);
+        set->spectrum = storage;
+        storage += plan->n;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ *  ======== eq_bank.h ========
+ *
+ *  Precomputed coefficient bank, one entry per DIP switch value.  Entries
+ *  are built once at start-up from the lp/bp/hp designs; the audio thread
+ *  only ever follows a pointer to the active entry, which load() swaps
+ *  with EQ_PUBLISH() when the switches change.
+ */
+#ifndef EQ_BANK_H
+#define EQ_BANK_H
+
+#include "eq_fir.h"
+#include "eq_fft.h"
+#include "eq_nband.h"
+
+/* Band bits, in DIP switch order */
+#define EQ_BAND_LP      0x1
+#define EQ_BAND_BP      0x2
+#define EQ_BAND_HP      0x4
+#define EQ_NUM_BANDS    3
+
+/* Band index (0..EQ_NUM_BANDS-1) of each band bit */
+#define EQ_LP           0
+#define EQ_BP           1
+#define EQ_HP           2
+
+/* What an entry does with the audio */
+#define EQ_MODE_FILTER  0       // filter with h
+#define EQ_MODE_BYPASS  1       // copy the input to the output
+#define EQ_MODE_MUTE    2       // output silence
+
+#define EQ_BANK_SIZE    16      // 4 DIP switches
+#define EQ_TAPS_PADDED  104     // EQ_FIR_TAPS rounded up for vector loads
+#define EQ_BANK_FILTERS 7       // filtering entries from eqBankInit(), DIP 1..7
+#define EQ_BANK_FFT_N   1024    // 1024-word frames: 512 + taps - 1, rounded up
+#define EQ_BANK_SPECTRA (EQ_BANK_FILTERS * EQ_BANK_FFT_N)
+
+typedef struct EqCoefSet {
+    float  h[EQ_TAPS_PADDED] EQ_ALIGNED(32);  // zero past EQ_FIR_TAPS
+    Int16  q[EQ_TAPS_PADDED] EQ_ALIGNED(16);  // h * 2^qShift for eqFirQ15()
+    Uint32 qShift;
+    Uint32 symmetric;           // h is linear phase; filter it folded
+    Uint32 mode;                // EQ_MODE_*
+    Uint32 bands;               // EQ_BAND_* summed into h and metered
+    const float *spectrum;      // h for eqFftConvolve(), NULL until prepared
+    const EqNBand *nband;       // bands metered per frame, or NULL
+} EqCoefSet;
+
+typedef struct EqBank {
+    EqCoefSet set[EQ_BANK_SIZE];
+} EqBank;
+
+/*
+ *  eqBankInit() - Build the entries for the DIP values used by the
+ *                 equalizer: 0 mutes, 1..7 sum the selected bands and
+ *                 8..15 bypass (switch 3 overrides the rest).
+ */
+void eqBankInit(EqBank *bank, const float *lp, const float *bp,
+                const float *hp);
+
+/*
+ *  eqBankBuild() - Fill one entry with the sum of the bands in mask.
+ *                  Used by eqBankInit() and for custom entries; an entry
+ *                  must not be rebuilt while it is the published one.
+ */
+void eqBankBuild(EqCoefSet *set, Uint32 mode, Uint32 bands,
+                 const float *lp, const float *bp, const float *hp);
+
+/*
+ *  eqBankBuildNBand() - Fill one entry with the gain-weighted sum of the
+ *                       bands of nb, which the engine then also meters
+ *                       band by band.  nb must outlive the entry.
+ */
+void eqBankBuildNBand(EqCoefSet *set, const EqNBand *nb);
+
+/*
+ *  eqBankPrepareFft() - Transform every filtering entry for the FFT mode,
+ *                       using plan->n floats of storage per entry.
+ *                       Returns 0, or -1 if capacity (in floats) is short,
+ *                       in which case no entry has a spectrum.
+ */
+int  eqBankPrepareFft(EqBank *bank, const EqFftPlan *plan, float *storage,
+                      Uint32 capacity);
+
+/* The application's storage for eqBankPrepareFft() (Gupta_Nair.c) */
+extern float gEqSpectra[EQ_BANK_SPECTRA];
+
+#endif /* EQ_BANK_H */
@@ -0,0 +1,83 @@
+/*
+ *  ======== eq_energy.c ========
+ *
+ *  Band-energy ring.  See eq_energy.h.
+ */
+#include <string.h>
+
+#include "eq_energy.h"
+
+#define EQ_RECORD_WORDS     (sizeof(EqEnergyRecord) / sizeof(Uint32))
+
+void eqEnergyInit(EqEnergyRing *ring)
+{
+    memset((void *)ring, 0, sizeof(*ring));
+}
+
+/*
+ *  The record is copied a word at a time through volatile pointers, so
+ *  the stores stay between the two updates of the slot number.
+ */
+void eqEnergyPublish(EqEnergyRing *ring, const EqMeters *meters,
+                     Uint32 words, Uint32 time)
+{
+    Uint32 frame = ring->head, i;
+    volatile EqEnergySlot *slot = &ring->slot[frame % EQ_ENERGY_SLOTS];
+    volatile Uint32 *dst = (volatile Uint32 *)&slot->rec;
+    EqEnergyRecord rec;
+
+    rec.frame = frame;
+    rec.time = time;
+    rec.words = words;
+    rec.meters = *meters;
+
+    slot->seq = 0;
+    EQ_FENCE();
+    for (i = 0; i < EQ_RECORD_WORDS; i++)
+        dst[i] = ((const Uint32 *)&rec)[i];
+    EQ_FENCE();
+    slot->seq = frame + 1;
+    EQ_FENCE();
+    ring->head = frame + 1;
+}
+
+void eqEnergyReaderInit(const EqEnergyRing *ring, EqEnergyReader *rd)
+{
+    rd->next = ring->head;
+    rd->dropped = 0;
+}
+
+int eqEnergyRead(const EqEnergyRing *ring, EqEnergyReader *rd,
+                 EqEnergyRecord *rec)
+{
+    for (;;)
+    {
+        Uint32 head = ring->head, seq, i;
+        const volatile EqEnergySlot *slot;
+        const volatile Uint32 *src;
+
+        EQ_FENCE();
+        if (rd->next == head)
+            return 0;
+        if (head - rd->next > EQ_ENERGY_SLOTS)
+        {
+            rd->dropped += head - EQ_ENERGY_SLOTS - rd->next;
+            rd->next = head - EQ_ENERGY_SLOTS;
+        }
+
+        slot = &ring->slot[rd->next % EQ_ENERGY_SLOTS];
+        src = (const volatile Uint32 *)&slot->rec;
+        seq = slot->seq;
+        EQ_FENCE();
+        for (i = 0; i < EQ_RECORD_WORDS; i++)
+            ((Uint32 *)rec)[i] = src[i];
+        EQ_FENCE();
+
+        /* rewritten under us (or being rewritten): look again */
+        if (seq == rd->next + 1 && slot->seq == seq)
+        {
+            rd->next++;
+            return 1;
+        }
+    }
+}
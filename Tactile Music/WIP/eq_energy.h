@@ -0,0 +1,68 @@
+/*
+ *  ======== eq_energy.h ========
+ *
+ *  Band energies from the audio thread to any number of consumers (LED
+ *  driver, haptic encoder, telemetry) without locks.  The audio thread
+ *  publishes one record per frame into a ring of EQ_ENERGY_SLOTS; each
+ *  consumer drains it through its own EqEnergyReader, so every consumer
+ *  sees every frame, peaks included, as long as it polls at least once
+ *  every EQ_ENERGY_SLOTS frames.  A consumer that falls further behind
+ *  skips to the oldest record still held and counts the frames it lost.
+ *
+ *  The writer never waits.  Each slot carries the number of the frame it
+ *  holds plus one, and 0 while it is being rewritten, so a reader that
+ *  was preempted by the audio thread part way through a copy sees the
+ *  number change and reads again (a seqlock per slot).  One writer only.
+ */
+#ifndef EQ_ENERGY_H
+#define EQ_ENERGY_H
+
+#include "eq_engine.h"
+
+#define EQ_ENERGY_SLOTS     64      // frames held, a power of 2
+
+typedef struct EqEnergyRecord {
+    Uint32   frame;     // frame number since eqEnergyInit()
+    Uint32   time;      // timestamp the writer gave, eg. CLK_gethtime()
+    Uint32   words;     // frame length, for mean squares
+    EqMeters meters;    // all three band powers, and any N-band energies
+} EqEnergyRecord;
+
+typedef struct EqEnergySlot {
+    Uint32         seq;     // frame + 1 when valid, 0 while written
+    EqEnergyRecord rec;
+} EqEnergySlot;
+
+typedef struct EqEnergyRing {
+    volatile Uint32 head;   // frames published
+    volatile EqEnergySlot slot[EQ_ENERGY_SLOTS];
+} EqEnergyRing;
+
+typedef struct EqEnergyReader {
+    Uint32 next;        // next frame to read
+    Uint32 dropped;     // frames overwritten before they were read
+} EqEnergyReader;
+
+void eqEnergyInit(EqEnergyRing *ring);
+
+/*
+ *  eqEnergyPublish() - Add the record of the frame of words words just
+ *                      measured in meters.
+ */
+void eqEnergyPublish(EqEnergyRing *ring, const EqMeters *meters,
+                     Uint32 words, Uint32 time);
+
+/*
+ *  eqEnergyReaderInit() - Attach a consumer; it sees the frames published
+ *                         from now on.
+ */
+void eqEnergyReaderInit(const EqEnergyRing *ring, EqEnergyReader *rd);
+
+/*
+ *  eqEnergyRead() - Copy the reader's next record to rec.  Returns 1, or
+ *                   0 if the reader is up to date.
+ */
+int  eqEnergyRead(const EqEnergyRing *ring, EqEnergyReader *rd,
+                  EqEnergyRecord *rec);
+
+#endif /* EQ_ENERGY_H */
@@ -0,0 +1,184 @@
+/*
+ *  ======== eq_engine.c ========
+ *
+ *  Equalizer engine.  See eq_engine.h.
+ */
+#include <string.h>
+
+#include "eq_engine.h"
+
+void eqEngineInit(EqEngine *eng, const EqCoefSet *set, const float *lp1,
+                  const float *bp1, const float *hp1, Uint32 xfadeWords)
+{
+    eqFirInit(&eng->fir);
+    eng->meter[EQ_LP] = lp1;
+    eng->meter[EQ_BP] = bp1;
+    eng->meter[EQ_HP] = hp1;
+    eng->meterSymmetric = eqFirIsSymmetric(lp1, EQ_LED_TAPS) &&
+                          eqFirIsSymmetric(bp1, EQ_LED_TAPS) &&
+                          eqFirIsSymmetric(hp1, EQ_LED_TAPS);
+    eng->current = set;
+    eng->xfadeWords = xfadeWords > EQ_MAX_FRAME ? EQ_MAX_FRAME : xfadeWords;
+    eng->engine = EQ_ENGINE_DIRECT;
+    eng->audioPath = EQ_PATH_FIR;
+    eng->meterPath = EQ_PATH_FIR;
+}
+
+int eqEngineSetPaths(EqEngine *eng, Uint32 audio, Uint32 meter, float rate)
+{
+    if (audio > EQ_PATH_IIR || meter > EQ_PATH_IIR)
+        return -1;
+    if (audio == EQ_PATH_IIR || meter == EQ_PATH_IIR)
+        eqIirDesign(&eng->iir, rate, EQ_IIR_LO_HZ, EQ_IIR_HI_HZ);
+    eng->audioPath = audio;
+    eng->meterPath = meter;
+    return 0;
+}
+
+int eqEngineSetFft(EqEngine *eng, Uint32 n)
+{
+#ifdef EQ_FIXED
+    /* the transform is float only */
+    return -1;
+#else
+    Uint32 size = eqFftSize(n / EQ_CHANNELS, EQ_FIR_TAPS);
+
+    if (size == 0 || eqFftInit(&eng->fft, size) != 0)
+        return -1;
+    memset(eng->fftBuf, 0, sizeof(eng->fftBuf));
+    eng->engine = EQ_ENGINE_FFT;
+    return 0;
+#endif
+}
+
+#ifndef EQ_FIXED
+/*
+ *  eqFftStereo() - eqFirStereo() by overlap-save: each channel's history
+ *                  and new samples go to the end of the block, and the
+ *                  last m outputs of the circular convolution are valid.
+ */
+static void eqFftStereo(EqEngine *eng, const float *spec, Int16 *y, Uint32 n)
+{
+    Uint32 m = n / EQ_CHANNELS, c;
+    float *out = eng->fftBuf + eng->fft.n - m;
+
+    for (c = 0; c < EQ_CHANNELS; c++)
+    {
+        memcpy(out - (EQ_FIR_TAPS - 1),
+               eqFirPlane(&eng->fir, c) - (EQ_FIR_TAPS - 1),
+               (m + EQ_FIR_TAPS - 1) * sizeof(float));
+        eqFftConvolve(&eng->fft, spec, eng->fftBuf);
+        memcpy(eng->fir.out[c], out, m * sizeof(float));
+    }
+    eqFirInterleave(eng->fir.out[0], eng->fir.out[1], y, m);
+}
+#endif
+
+/*
+ *  eqRender() - Output of one coefficient set for the loaded frame, which
+ *               is also at x as received.  y may be x.
+ */
+static void eqRender(EqEngine *eng, const EqCoefSet *set, const Int16 *x,
+                     Int16 *y, Uint32 n)
+{
+    switch (set->mode)
+    {
+    case EQ_MODE_FILTER:
+        if (eng->audioPath == EQ_PATH_IIR && set->nband == NULL)
+        {
+            eqIirRender(&eng->iir, set->bands, y, n);
+            break;
+        }
+#ifdef EQ_FIXED
+        eqFirStereo(&eng->fir, set->q, set->qShift, y, n);
+#else
+        if (eng->engine == EQ_ENGINE_FFT && set->spectrum)
+            eqFftStereo(eng, set->spectrum, y, n);
+        else
+            eqFirStereo(&eng->fir, set->h, set->symmetric, y, n);
+#endif
+        break;
+    case EQ_MODE_BYPASS:
+        if (y != x)
+            memcpy(y, x, n * sizeof(Int16));
+        break;
+    default:
+        memset(y, 0, n * sizeof(Int16));
+        break;
+    }
+}
+
+/*
+ *  eqCrossfade() - Ramp from the old output in fade to the new one in y
+ *                  over len words, keeping each stereo pair on one gain.
+ */
+static void eqCrossfade(const Int16 *fade, Int16 *y, Uint32 len)
+{
+    float step = 2.0f / (len + 2);
+    Uint32 i;
+
+    for (i = 0; i < len; i++)
+    {
+        float g = (i / 2 + 1) * step;
+        y[i] = (Int16)(fade[i] + g * (y[i] - fade[i]));
+    }
+}
+
+/*
+ *  eqEngineRun() - Process a frame into xmt, which may be rcv.  With
+ *                  zeroCopy a bypass or mute leaves xmt alone unless a
+ *                  crossfade needs it.  Returns the mode of the output, as
+ *                  eqEngineProcessInPlace().
+ */
+static Uint32 eqEngineRun(EqEngine *eng, const EqCoefSet *set,
+                          const Int16 *rcv, Int16 *xmt, Uint32 n,
+                          EqMeters *meters, Uint32 zeroCopy)
+{
+    Uint32 fading = set != eng->current && eng->xfadeWords;
+    Uint32 len = eng->xfadeWords < n ? eng->xfadeWords : n;
+    Uint32 mode = fading ? EQ_MODE_FILTER : set->mode;
+
+    /* the FIR meters are measured as the frame is loaded */
+    eqFirLoad(&eng->fir, rcv, n,
+              eng->meterPath == EQ_PATH_FIR ? eng->meter : NULL,
+              eng->meterSymmetric, meters->power);
+    meters->bands = set->bands;
+
+    if (eng->audioPath == EQ_PATH_IIR || eng->meterPath == EQ_PATH_IIR)
+        eqIirSplit(&eng->iir, &eng->fir, n);
+    if (eng->meterPath == EQ_PATH_IIR)
+        eqIirPower(&eng->iir, n, meters->power);
+
+    /* the old set first, while rcv is intact; the FFT renders whole
+       frames only */
+    if (fading)
+        eqRender(eng, eng->current, rcv, eng->fade,
+                 eng->engine == EQ_ENGINE_FFT ? n : len);
+    if (!zeroCopy || mode == EQ_MODE_FILTER)
+        eqRender(eng, set, rcv, xmt, n);
+    if (fading)
+        eqCrossfade(eng->fade, xmt, len);
+    eng->current = set;
+
+    meters->nbands = 0;
+    if (set->nband)
+    {
+        eqNBandMeasure(set->nband, &eng->fir, n, meters->energy);
+        meters->nbands = set->nband->bands;
+    }
+
+    eqFirCommit(&eng->fir, n);
+    return mode;
+}
+
+void eqEngineProcess(EqEngine *eng, const EqCoefSet *set, const Int16 *rcv,
+                     Int16 *xmt, Uint32 n, EqMeters *meters)
+{
+    eqEngineRun(eng, set, rcv, xmt, n, meters, 0);
+}
+
+Uint32 eqEngineProcessInPlace(EqEngine *eng, const EqCoefSet *set,
+                              Int16 *buf, Uint32 n, EqMeters *meters)
+{
+    return eqEngineRun(eng, set, buf, buf, n, meters, 1);
+}
@@ -0,0 +1,109 @@
+/*
+ *  ======== eq_engine.h ========
+ *
+ *  Per-stream equalizer engine: joins each frame to the filter history,
+ *  renders the output with the active coefficient set, and measures the
+ *  LED band powers.  When the set changes between frames the old and new
+ *  outputs are crossfaded over the first xfadeWords words of the frame,
+ *  so flipping a DIP switch mid-stream does not click.
+ *
+ *  Filtering runs either in direct form (eqFirStereo) or, after
+ *  eqEngineSetFft(), by overlap-save FFT convolution with the spectrum
+ *  precomputed for each coefficient set.  Sets built from an N-band bank
+ *  also report each band's energy per frame.
+ *
+ *  The audio output and the LED band meters each pick a path on their
+ *  own (eqEngineSetPaths()): the FIRs above, or the Linkwitz-Riley biquad
+ *  splitter of eq_iir.h, which trades linear phase for a few samples of
+ *  delay and fewer multiplies.
+ *
+ *  eqEngineProcessInPlace() works on the received frame itself, for a
+ *  caller that can send from it: filtering overwrites it, a bypass leaves
+ *  it as it is, and a mute leaves it too and says so, so the caller sends
+ *  silence from elsewhere.  No frame is copied or cleared unless a
+ *  crossfade needs it.
+ */
+#ifndef EQ_ENGINE_H
+#define EQ_ENGINE_H
+
+#include "eq_bank.h"
+#include "eq_iir.h"
+
+#define EQ_XFADE_WORDS  256     // default crossfade, 16 ms of stereo at 8 kHz
+
+/* How filtering entries are rendered */
+#define EQ_ENGINE_DIRECT    0   // time-domain MAC per tap
+#define EQ_ENGINE_FFT       1   // overlap-save, one FFT pair per channel
+
+/* Filter family of the audio and meter paths */
+#define EQ_PATH_FIR         0   // 101-tap audio sets, 13-tap meters
+#define EQ_PATH_IIR         1   // biquad crossovers at EQ_IIR_LO/HI_HZ
+
+#define EQ_IIR_LO_HZ        1000.0f     // the encoder's 0-1k/1-2k/2-4k bins
+#define EQ_IIR_HI_HZ        2000.0f
+
+typedef struct EqMeters {
+    float  power[EQ_NUM_BANDS]; // sum of squares over the frame, by EQ_LP..
+    Uint32 bands;               // EQ_BAND_* bits the set passes
+    Uint32 nbands;              // bands in energy (0 unless set->nband)
+    float  energy[EQ_NBAND_MAX];    // N-band energies, see eqNBandMeasure()
+} EqMeters;
+
+typedef struct EqEngine {
+    EqFir           fir;
+    const float     *meter[EQ_NUM_BANDS];   // EQ_LED_TAPS-tap meter filters
+    Uint32          meterSymmetric;         // all meters fold
+    const EqCoefSet *current;   // set that rendered the previous frame
+    Uint32          xfadeWords; // 0 switches sets on a frame boundary
+    Uint32          engine;     // EQ_ENGINE_*
+    Uint32          audioPath;  // EQ_PATH_* for filtering sets
+    Uint32          meterPath;  // EQ_PATH_* for EqMeters.power
+    Int16           fade[EQ_MAX_FRAME];     // old set's output while fading
+    EqFftPlan       fft;        // EQ_ENGINE_FFT transform
+    float           fftBuf[EQ_FFT_MAX];     // one channel's overlap-save block
+    EqIir           iir;        // EQ_PATH_IIR splitter and its state
+} EqEngine;
+
+/*
+ *  eqEngineInit() - Start a stream from silence with set as the current
+ *                   coefficients.  lp1/bp1/hp1 are the meter filters.
+ */
+void eqEngineInit(EqEngine *eng, const EqCoefSet *set, const float *lp1,
+                  const float *bp1, const float *hp1, Uint32 xfadeWords);
+
+/*
+ *  eqEngineSetFft() - Switch to the FFT mode for frames of n words.  The
+ *                     sets passed to eqEngineProcess() must then have been
+ *                     through eqBankPrepareFft() with eng->fft.  Returns 0,
+ *                     or -1 if n is too large for the transform or the
+ *                     build is EQ_FIXED.
+ */
+int  eqEngineSetFft(EqEngine *eng, Uint32 n);
+
+/*
+ *  eqEngineSetPaths() - Choose EQ_PATH_FIR or EQ_PATH_IIR for the audio of
+ *                       three-band filtering sets (N-band sets stay FIR)
+ *                       and for the meters, at sample rate rate.  Returns
+ *                       0, or -1 for an unknown path.
+ */
+int  eqEngineSetPaths(EqEngine *eng, Uint32 audio, Uint32 meter, float rate);
+
+/*
+ *  eqEngineProcess() - Process n interleaved words from rcv into xmt using
+ *                      set.  Every band is measured, whether or not the
+ *                      set passes it; meters->bands says which it does.
+ */
+void eqEngineProcess(EqEngine *eng, const EqCoefSet *set, const Int16 *rcv,
+                     Int16 *xmt, Uint32 n, EqMeters *meters);
+
+/*
+ *  eqEngineProcessInPlace() - eqEngineProcess() with the output in buf.
+ *                             Returns EQ_MODE_MUTE if the output is
+ *                             silence and buf was not written, or else
+ *                             the mode of set (EQ_MODE_FILTER while a
+ *                             crossfade has written buf).
+ */
+Uint32 eqEngineProcessInPlace(EqEngine *eng, const EqCoefSet *set,
+                              Int16 *buf, Uint32 n, EqMeters *meters);
+
+#endif /* EQ_ENGINE_H */
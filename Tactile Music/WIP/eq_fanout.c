@@ -0,0 +1,112 @@
+/*
+ *  ======== eq_fanout.c ========
+ *
+ *  Multi-device tactile encoder.  See eq_fanout.h.
+ */
+#include <string.h>
+
+#include "eq_fanout.h"
+
+int eqFanoutInit(EqFanout *f, float rate, float interval, float warmup)
+{
+    float samples = rate * interval;
+
+    memset(f, 0, sizeof(*f));
+    if (!(samples >= 1.0f))
+        return -1;
+    f->rate = rate;
+    f->interval = (Uint32)samples;
+    if ((float)f->interval < samples)
+        f->interval++;
+    eqAdaptBankInit(&f->adapt, f->interval / rate, EQ_ADAPT_TAU, EQ_ADAPT_K,
+                    warmup);
+    return 0;
+}
+
+int eqFanoutAdd(EqFanout *f, const Uint8 map[EQ_TACTILE_MOTORS],
+                Uint16 duty, EqTactileSink sink, void *arg)
+{
+    Uint32 d = f->devices, m;
+
+    if (d == EQ_FAN_MAX_DEVICES)
+        return -1;
+    for (m = 0; m < EQ_TACTILE_MOTORS; m++)
+        f->set[m][d] = map[m] & (EQ_FAN_SETS - 1);
+    f->duty[d] = duty;
+    f->sink[d] = sink;
+    f->arg[d] = arg;
+    f->devices++;
+    return (int)d;
+}
+
+/*
+ *  eqFanoutEmit() - Close the interval: decide each band set once, then
+ *                   build and send every device's packet from those.
+ */
+static void eqFanoutEmit(EqFanout *f)
+{
+    float ms[EQ_FAN_SETS];
+    Uint32 s, d, m, on;
+
+    for (s = 0; s < EQ_FAN_SETS; s++)
+    {
+        ms[s] = f->sum[s] / f->interval;
+        f->sum[s] = 0.0f;
+    }
+    f->fill = 0;
+    on = f->on = eqAdaptBankStep(&f->adapt, ms);
+    f->packets++;
+
+    for (m = 0; m < EQ_TACTILE_MOTORS; m++)
+        for (d = 0; d < f->devices; d++)
+        {
+            Uint32 duty = (on >> f->set[m][d]) & 1 ? f->duty[d] : 0;
+
+            f->last[d][2 * m] = (Uint8)(duty >> 8);
+            f->last[d][2 * m + 1] = (Uint8)duty;
+        }
+    for (d = 0; d < f->devices; d++)
+        if (f->sink[d])
+            f->sink[d](f->arg[d], f->last[d]);
+}
+
+Uint32 eqFanoutPush(EqFanout *f, const EqMeters *meters, Uint32 words)
+{
+    Uint32 m = words / EQ_CHANNELS, done = 0, packets = f->packets, s;
+    float band[EQ_NUM_BANDS], ms[EQ_FAN_SETS];
+
+    if (words == 0)
+        return 0;
+
+    /* mean square per sample of every band set over the frame, summed in
+       band order as eqTactilePush() sums the whole signal */
+    for (s = 0; s < EQ_NUM_BANDS; s++)
+        band[s] = meters->power[s] / words / EQ_FULL_SCALE2;
+    for (s = 0; s < EQ_FAN_SETS; s++)
+    {
+        ms[s] = 0.0f;
+        if (s & EQ_BAND_LP)
+            ms[s] += band[EQ_LP];
+        if (s & EQ_BAND_BP)
+            ms[s] += band[EQ_BP];
+        if (s & EQ_BAND_HP)
+            ms[s] += band[EQ_HP];
+    }
+
+    /* split the frame at interval ends */
+    while (done < m)
+    {
+        Uint32 take = m - done;
+
+        if (take > f->interval - f->fill)
+            take = f->interval - f->fill;
+        for (s = 0; s < EQ_FAN_SETS; s++)
+            f->sum[s] += ms[s] * take;
+
+        f->fill += take;
+        done += take;
+        if (f->fill == f->interval)
+            eqFanoutEmit(f);
+    }
+    return f->packets - packets;
+}
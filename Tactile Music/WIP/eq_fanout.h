@@ -0,0 +1,74 @@
+/*
+ *  ======== eq_fanout.h ========
+ *
+ *  One audio stream driving many tactile sleeves.  eq_tactile.h encodes
+ *  a stream for the one sleeve that play_file() in
+ *  TactileMusic_Preprocessed.py connects to.  Here each device has its
+ *  own map from motors to bands: any set of the low, mid and high bands,
+ *  or none.  A device can then put the bass on every motor, or swap two
+ *  motors, while the others keep the script's layout.
+ *
+ *  A motor's signal is the sum of its set's band powers, and its on/off
+ *  decision is the adaptive threshold (eq_adapt.h) of that signal.  There
+ *  are only eight sets, so the stream keeps one tracker per set
+ *  (EqAdaptBank) and measures each interval once, whatever the number of
+ *  devices.  Each device then only looks up the decisions of its motors'
+ *  sets.  A device with the script's map (EQ_FAN_MAP_SCRIPT) gets the
+ *  same packets as eqTactilePush().
+ *
+ *  The device state is stored by field: one array per motor of band
+ *  sets, one of duties and one of sinks, indexed by device.  Streams
+ *  share nothing, so separate streams can run on separate cores.
+ */
+#ifndef EQ_FANOUT_H
+#define EQ_FANOUT_H
+
+#include "eq_tactile.h"
+
+#define EQ_FAN_MAX_DEVICES  64
+#define EQ_FAN_SETS         EQ_ADAPT_BANK   // band sets, EQ_BAND_* masks
+
+/* The script's map: whole signal, low, mid, high */
+#define EQ_FAN_MAP_SCRIPT   { EQ_BAND_LP | EQ_BAND_BP | EQ_BAND_HP, \
+                              EQ_BAND_LP, EQ_BAND_BP, EQ_BAND_HP }
+
+typedef struct EqFanout {
+    float         rate;                     // Hz
+    Uint32        interval;                 // samples per packet
+    Uint32        fill;                     // samples in the current one
+    float         sum[EQ_FAN_SETS];         // mean square x samples
+    EqAdaptBank   adapt;                    // tracker per band set
+    Uint32        on;                       // bit s: set s on, last packet
+    Uint32        packets;                  // packets completed per device
+    Uint32        devices;
+    Uint8         set[EQ_TACTILE_MOTORS][EQ_FAN_MAX_DEVICES];
+    Uint16        duty[EQ_FAN_MAX_DEVICES];
+    EqTactileSink sink[EQ_FAN_MAX_DEVICES];
+    void          *arg[EQ_FAN_MAX_DEVICES];
+    Uint8         last[EQ_FAN_MAX_DEVICES][EQ_TACTILE_PACKET];
+} EqFanout;
+
+/*
+ *  eqFanoutInit() - As eqTactileInit(), for a stream with no devices yet.
+ *                   Returns 0, or -1 if the interval is shorter than a
+ *                   sample.
+ */
+int  eqFanoutInit(EqFanout *f, float rate, float interval, float warmup);
+
+/*
+ *  eqFanoutAdd() - Attach a device whose motor m runs on the band set
+ *                  map[m] (EQ_BAND_* bits, 0 for never) at duty.  sink
+ *                  gets its packets and may be NULL.  Returns the device
+ *                  index, or -1 if the stream has EQ_FAN_MAX_DEVICES.
+ */
+int  eqFanoutAdd(EqFanout *f, const Uint8 map[EQ_TACTILE_MOTORS],
+                 Uint16 duty, EqTactileSink sink, void *arg);
+
+/*
+ *  eqFanoutPush() - eqTactilePush() for every device: add a frame of
+ *                   words interleaved words measured in meters.  Returns
+ *                   the number of packets completed per device.
+ */
+Uint32 eqFanoutPush(EqFanout *f, const EqMeters *meters, Uint32 words);
+
+#endif /* EQ_FANOUT_H */
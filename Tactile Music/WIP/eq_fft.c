@@ -0,0 +1,210 @@
+/*
+ *  ======== eq_fft.c ========
+ *
+ *  Radix-2 real FFT and overlap-save convolution.  See eq_fft.h.
+ */
+#include <math.h>
+#include <string.h>
+
+#include "eq_fft.h"
+
+Uint32 eqFftSize(Uint32 m, Uint32 taps)
+{
+    Uint32 n = 4;
+
+    while (n < m + taps - 1)
+        n <<= 1;
+    return n <= EQ_FFT_MAX ? n : 0;
+}
+
+int eqFftInit(EqFftPlan *plan, Uint32 n)
+{
+    const double pi = 3.14159265358979323846;
+    Uint32 k;
+
+    if (n < 4 || n > EQ_FFT_MAX || (n & (n - 1)))
+        return -1;
+
+    plan->n = n;
+    for (k = 0; k < n / 2; k++)
+    {
+        plan->cosTab[k] = (float)cos(2.0 * pi * k / n);
+        plan->sinTab[k] = (float)sin(2.0 * pi * k / n);
+    }
+    return 0;
+}
+
+/*
+ *  eqFftComplex() - In-place radix-2 FFT of the m = n/2 complex values in
+ *                   z (re, im interleaved).  sign is -1 for the forward
+ *                   transform and +1 for the (unscaled) inverse.
+ */
+static void eqFftComplex(const EqFftPlan *plan, float *z, float sign)
+{
+    Uint32 m = plan->n / 2;
+    Uint32 i, j, k, size, half, step;
+
+    /* bit-reverse permutation */
+    for (i = 1, j = 0; i < m; i++)
+    {
+        Uint32 bit = m >> 1;
+
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+        if (i < j)
+        {
+            float tr = z[2 * i], ti = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = tr;
+            z[2 * j + 1] = ti;
+        }
+    }
+
+    /* butterflies; the size-m twiddles are every other size-n entry */
+    for (size = 2; size <= m; size <<= 1)
+    {
+        half = size / 2;
+        step = 2 * (m / size);
+        for (i = 0; i < m; i += size)
+        {
+            for (k = 0; k < half; k++)
+            {
+                float wr = plan->cosTab[k * step];
+                float wi = sign * plan->sinTab[k * step];
+                float *a = z + 2 * (i + k);
+                float *b = z + 2 * (i + k + half);
+                float tr = wr * b[0] - wi * b[1];
+                float ti = wr * b[1] + wi * b[0];
+
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+void eqFftForward(const EqFftPlan *plan, float *buf)
+{
+    Uint32 m = plan->n / 2;
+    Uint32 k;
+    float r0, i0;
+
+    /* even samples as the real part, odd samples as the imaginary part */
+    eqFftComplex(plan, buf, -1.0f);
+
+    r0 = buf[0];
+    i0 = buf[1];
+    buf[0] = r0 + i0;
+    buf[1] = r0 - i0;
+
+    for (k = 1; k <= m / 2; k++)
+    {
+        float *zk = buf + 2 * k;
+        float *zm = buf + 2 * (m - k);
+        float wr = plan->cosTab[k], wi = -plan->sinTab[k];
+        /* E = (Z[k] + conj Z[m-k]) / 2, O = -i (Z[k] - conj Z[m-k]) / 2 */
+        float er = 0.5f * (zk[0] + zm[0]), ei = 0.5f * (zk[1] - zm[1]);
+        float or_ = 0.5f * (zk[1] + zm[1]), oi = -0.5f * (zk[0] - zm[0]);
+        float tr = wr * or_ - wi * oi;
+        float ti = wr * oi + wi * or_;
+
+        /* X[k] = E + W O, X[m-k] = conj(E - W O) */
+        zk[0] = er + tr;
+        zk[1] = ei + ti;
+        if (k != m - k)
+        {
+            zm[0] = er - tr;
+            zm[1] = ti - ei;
+        }
+    }
+}
+
+/*
+ *  eqFftInverseRaw() - Inverse of eqFftForward() without the 1/m scale.
+ */
+static void eqFftInverseRaw(const EqFftPlan *plan, float *buf)
+{
+    Uint32 m = plan->n / 2;
+    Uint32 k;
+    float x0, xm;
+
+    x0 = buf[0];
+    xm = buf[1];
+    buf[0] = 0.5f * (x0 + xm);
+    buf[1] = 0.5f * (x0 - xm);
+
+    for (k = 1; k <= m / 2; k++)
+    {
+        float *xk = buf + 2 * k;
+        float *xr = buf + 2 * (m - k);
+        float wr = plan->cosTab[k], wi = plan->sinTab[k];
+        /* E = (X[k] + conj X[m-k]) / 2, O = conj(W) (X[k] - conj X[m-k]) / 2 */
+        float er = 0.5f * (xk[0] + xr[0]), ei = 0.5f * (xk[1] - xr[1]);
+        float dr = 0.5f * (xk[0] - xr[0]), di = 0.5f * (xk[1] + xr[1]);
+        float or_ = wr * dr - wi * di;
+        float oi = wr * di + wi * dr;
+
+        /* Z[k] = E + i O, Z[m-k] = conj E + i conj O */
+        xk[0] = er - oi;
+        xk[1] = ei + or_;
+        if (k != m - k)
+        {
+            xr[0] = er + oi;
+            xr[1] = or_ - ei;
+        }
+    }
+
+    eqFftComplex(plan, buf, 1.0f);
+}
+
+void eqFftInverse(const EqFftPlan *plan, float *buf)
+{
+    float scale = 2.0f / plan->n;
+    Uint32 i;
+
+    eqFftInverseRaw(plan, buf);
+    for (i = 0; i < plan->n; i++)
+        buf[i] *= scale;
+}
+
+/*
+ *  The spectrum carries the inverse transform's 1/m scale, so that
+ *  eqFftConvolve() does not need a separate pass for it.
+ */
+void eqFftSpectrum(const EqFftPlan *plan, const float *h, Uint32 taps,
+                   float *spec)
+{
+    float scale = 2.0f / plan->n;
+    Uint32 i;
+
+    memset(spec, 0, plan->n * sizeof(float));
+    for (i = 0; i < taps && i < plan->n; i++)
+        spec[i] = h[i];
+    eqFftForward(plan, spec);
+    for (i = 0; i < plan->n; i++)
+        spec[i] *= scale;
+}
+
+void eqFftConvolve(const EqFftPlan *plan, const float *spec, float *buf)
+{
+    Uint32 n = plan->n;
+    Uint32 k;
+
+    eqFftForward(plan, buf);
+
+    buf[0] *= spec[0];
+    buf[1] *= spec[1];
+    for (k = 2; k < n; k += 2)
+    {
+        float br = buf[k], bi = buf[k + 1];
+
+        buf[k]     = br * spec[k] - bi * spec[k + 1];
+        buf[k + 1] = br * spec[k + 1] + bi * spec[k];
+    }
+
+    eqFftInverseRaw(plan, buf);
+}
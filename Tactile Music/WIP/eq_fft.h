@@ -0,0 +1,65 @@
+/*
+ *  ======== eq_fft.h ========
+ *
+ *  Real FFT and overlap-save convolution for the equalizer's frequency
+ *  domain mode.  A length-n real transform is computed as an n/2 point
+ *  complex FFT plus a split step.  Spectra are packed in place:
+ *
+ *      buf[0] = X[0]   buf[1] = X[n/2]   buf[2k], buf[2k+1] = Re, Im X[k]
+ *
+ *  for k = 1 .. n/2-1, the remaining bins being the conjugate mirror.
+ */
+#ifndef EQ_FFT_H
+#define EQ_FFT_H
+
+#include "eq_types.h"
+
+#define EQ_FFT_MAX      4096    // largest supported transform
+
+typedef struct EqFftPlan {
+    Uint32 n;                   // real transform length, a power of 2
+    float  cosTab[EQ_FFT_MAX / 2];  // cos(2 pi k / n), k < n/2
+    float  sinTab[EQ_FFT_MAX / 2];  // sin(2 pi k / n), k < n/2
+} EqFftPlan;
+
+/*
+ *  eqFftSize() - Smallest transform that filters m new samples per block
+ *                with a taps-long filter; 0 if above EQ_FFT_MAX.
+ */
+Uint32 eqFftSize(Uint32 m, Uint32 taps);
+
+/*
+ *  eqFftInit() - Build the tables for a length-n transform.  Returns 0, or
+ *                -1 if n is not a power of 2 between 4 and EQ_FFT_MAX.
+ */
+int  eqFftInit(EqFftPlan *plan, Uint32 n);
+
+/*
+ *  eqFftForward() - Real samples buf[0..n-1] to the packed spectrum.
+ */
+void eqFftForward(const EqFftPlan *plan, float *buf);
+
+/*
+ *  eqFftInverse() - Packed spectrum back to real samples; the inverse of
+ *                   eqFftForward(), scale included.
+ */
+void eqFftInverse(const EqFftPlan *plan, float *buf);
+
+/*
+ *  eqFftSpectrum() - Packed spectrum of the taps-long filter h,
+ *                    zero-padded to the plan length, into spec[0..n-1].
+ *                    The inverse transform's scale is folded in, so spec
+ *                    is only meant for eqFftConvolve().
+ */
+void eqFftSpectrum(const EqFftPlan *plan, const float *h, Uint32 taps,
+                   float *spec);
+
+/*
+ *  eqFftConvolve() - Overlap-save block.  On entry buf[n-m-taps+1 .. n-1]
+ *                    holds the taps-1 previous samples followed by m new
+ *                    ones (the rest is ignored); on return buf[n-m .. n-1]
+ *                    holds the m filtered outputs.
+ */
+void eqFftConvolve(const EqFftPlan *plan, const float *spec, float *buf);
+
+#endif /* EQ_FFT_H */
@@ -0,0 +1,458 @@
+/*
+ *  ======== eq_fir.c ========
+ *
+ *  Contiguous-history FIR engine.  See eq_fir.h.
+ */
+#include <string.h>
+
+/* Vector kernels; EQ_FIR_SCALAR forces the portable loops the DSK runs */
+#if !defined(EQ_FIR_SCALAR) && defined(__AVX__)
+#define EQ_FIR_AVX
+#endif
+#if !defined(EQ_FIR_SCALAR) && defined(__SSE2__)
+#define EQ_FIR_SSE
+#endif
+#if defined(EQ_FIR_AVX) || defined(EQ_FIR_SSE)
+#include <immintrin.h>
+#endif
+
+#include "eq_fir.h"
+#include "eq_fir_sym.h"
+
+#define EQ_Q15_SHIFT    15
+
+void eqFirInit(EqFir *fir)
+{
+    memset(fir->plane, 0, sizeof(fir->plane));
+}
+
+Uint32 eqFirIsSymmetric(const float *h, Uint32 taps)
+{
+    Uint32 j;
+
+    for (j = 0; j < taps / 2; j++)
+        if (h[j] != h[taps - 1 - j])
+            return 0;
+    return 1;
+}
+
+/*
+ *  The meter window w[j] = x[i - j] slides along the codec words and is
+ *  only ever shifted, so with EQ_LED_TAPS fixed the compiler keeps it in
+ *  registers and unrolls the tap loops.  It starts from the last words
+ *  of the previous frame, taken back out of the plane history.
+ */
+void eqFirLoad(EqFir *fir, const Int16 *frame, Uint32 n,
+               const float *meter[EQ_METERS], Uint32 symmetric,
+               float power[EQ_METERS])
+{
+    EqSample *plane[EQ_CHANNELS];
+    float w[EQ_LED_TAPS];
+    float p0 = 0.0f, p1 = 0.0f, p2 = 0.0f;
+    const float *h0, *h1, *h2;
+    Uint32 i;
+    int j;
+
+    plane[0] = eqFirPlane(fir, 0);
+    plane[1] = eqFirPlane(fir, 1);
+
+    if (meter == NULL)
+    {
+        for (i = 0; i < n; i++)
+            plane[i & 1][i >> 1] = frame[i];
+        return;
+    }
+
+    h0 = meter[0];
+    h1 = meter[1];
+    h2 = meter[2];
+
+    /* word k < 0 is plane[k & 1][(k - (k & 1)) / 2] */
+    for (j = 1; j < EQ_LED_TAPS; j++)
+        w[j - 1] = plane[(-j) & 1][(-j - ((-j) & 1)) / 2];
+
+    for (i = 0; i < n; i++)
+    {
+        float o0 = 0.0f, o1 = 0.0f, o2 = 0.0f;
+
+        for (j = EQ_LED_TAPS - 1; j > 0; j--)
+            w[j] = w[j - 1];
+        w[0] = frame[i];
+        plane[i & 1][i >> 1] = frame[i];
+
+        if (symmetric)
+        {
+            EQ_FIR_SYM_SUM(o0, h0, w, 1, EQ_LED_TAPS);
+            EQ_FIR_SYM_SUM(o1, h1, w, 1, EQ_LED_TAPS);
+            EQ_FIR_SYM_SUM(o2, h2, w, 1, EQ_LED_TAPS);
+        }
+        else
+        {
+            for (j = 0; j < EQ_LED_TAPS; j++)
+            {
+                o0 += h0[j] * w[j];
+                o1 += h1[j] * w[j];
+                o2 += h2[j] * w[j];
+            }
+        }
+        p0 += o0 * o0;
+        p1 += o1 * o1;
+        p2 += o2 * o2;
+    }
+    power[0] = p0;
+    power[1] = p1;
+    power[2] = p2;
+}
+
+void eqFirCommit(EqFir *fir, Uint32 n)
+{
+    Uint32 c;
+
+    for (c = 0; c < EQ_CHANNELS; c++)
+        memmove(fir->plane[c], fir->plane[c] + n / EQ_CHANNELS,
+                EQ_PLANE_HIST * sizeof(EqSample));
+}
+
+/*
+ *  Each channel is filtered on its plane, so output i of a channel is
+ *  sum(h[j] * x[i - j]), then the two are interleaved back together with
+ *  the right channel on even words and the left on odd ones.
+ */
+#ifdef EQ_FIXED
+void eqFirStereo(EqFir *fir, const Int16 *q, Uint32 shift, Int16 *y,
+                 Uint32 n)
+{
+    Uint32 m = n / EQ_CHANNELS, c;
+
+    for (c = 0; c < EQ_CHANNELS; c++)
+        eqFirQ15(eqFirPlane(fir, c), q, EQ_FIR_TAPS, shift, fir->out[c], m);
+    eqFirInterleave(fir->out[0], fir->out[1], y, m);
+}
+
+/* The fixed-point kernel has already saturated */
+void eqFirInterleave(const EqSample *right, const EqSample *left, Int16 *y,
+                     Uint32 m)
+{
+    Uint32 i;
+
+    for (i = 0; i < m; i++)
+    {
+        y[2 * i]     = right[i];
+        y[2 * i + 1] = left[i];
+    }
+}
+#else
+void eqFirStereo(EqFir *fir, const float *h, Uint32 symmetric, Int16 *y,
+                 Uint32 n)
+{
+    Uint32 m = n / EQ_CHANNELS, c;
+
+    for (c = 0; c < EQ_CHANNELS; c++)
+    {
+        if (symmetric)
+            eqFirSymmetric(eqFirPlane(fir, c), h, fir->out[c], m);
+        else
+            eqFirFloat(eqFirPlane(fir, c), h, EQ_FIR_TAPS, fir->out[c], m);
+    }
+    eqFirInterleave(fir->out[0], fir->out[1], y, m);
+}
+
+static Int16 eqSaturate(float v)
+{
+    if (v >= 32767.0f)
+        return 32767;
+    if (v <= -32768.0f)
+        return -32768;
+    return (Int16)v;
+}
+
+void eqFirInterleave(const float *right, const float *left, Int16 *y,
+                     Uint32 m)
+{
+    Uint32 i = 0;
+
+#if defined(EQ_FIR_SSE)
+    /* truncating conversion, then the saturating pack */
+    for (; i + 8 <= m; i += 8)
+    {
+        __m128i r = _mm_packs_epi32(_mm_cvttps_epi32(_mm_loadu_ps(right + i)),
+                                    _mm_cvttps_epi32(_mm_loadu_ps(right + i + 4)));
+        __m128i l = _mm_packs_epi32(_mm_cvttps_epi32(_mm_loadu_ps(left + i)),
+                                    _mm_cvttps_epi32(_mm_loadu_ps(left + i + 4)));
+
+        _mm_storeu_si128((__m128i *)(y + 2 * i), _mm_unpacklo_epi16(r, l));
+        _mm_storeu_si128((__m128i *)(y + 2 * i + 8), _mm_unpackhi_epi16(r, l));
+    }
+#endif
+    for (; i < m; i++)
+    {
+        y[2 * i]     = eqSaturate(right[i]);
+        y[2 * i + 1] = eqSaturate(left[i]);
+    }
+}
+#endif /* EQ_FIXED */
+
+EQ_FIR_SYM_DEFINE(eqFirSym, EQ_FIR_TAPS, float)
+
+/*
+ *  The vector loops below follow eqFirSym() exactly: the same folded sum
+ *  in the same order, on runs of consecutive outputs as in eqFirFloat().
+ */
+void eqFirSymmetric(const float *x, const float *h, float *y, Uint32 n)
+{
+    Uint32 i = 0;
+
+#if defined(EQ_FIR_AVX)
+    for (; i + 32 <= n; i += 32)
+    {
+        const float *xi = x + i;
+        __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+        __m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+        __m256 hj;
+        int j;
+
+        for (j = 0; j < EQ_FIR_TAPS / 2; j++)
+        {
+            const float *p = xi - j, *q = xi - (EQ_FIR_TAPS - 1 - j);
+
+            hj = _mm256_set1_ps(h[j]);
+            a0 = _mm256_add_ps(a0, _mm256_mul_ps(hj,
+                     _mm256_add_ps(_mm256_loadu_ps(p), _mm256_loadu_ps(q))));
+            a1 = _mm256_add_ps(a1, _mm256_mul_ps(hj,
+                     _mm256_add_ps(_mm256_loadu_ps(p + 8), _mm256_loadu_ps(q + 8))));
+            a2 = _mm256_add_ps(a2, _mm256_mul_ps(hj,
+                     _mm256_add_ps(_mm256_loadu_ps(p + 16), _mm256_loadu_ps(q + 16))));
+            a3 = _mm256_add_ps(a3, _mm256_mul_ps(hj,
+                     _mm256_add_ps(_mm256_loadu_ps(p + 24), _mm256_loadu_ps(q + 24))));
+        }
+        if (EQ_FIR_TAPS & 1)
+        {
+            const float *p = xi - EQ_FIR_TAPS / 2;
+
+            hj = _mm256_set1_ps(h[EQ_FIR_TAPS / 2]);
+            a0 = _mm256_add_ps(a0, _mm256_mul_ps(hj, _mm256_loadu_ps(p)));
+            a1 = _mm256_add_ps(a1, _mm256_mul_ps(hj, _mm256_loadu_ps(p + 8)));
+            a2 = _mm256_add_ps(a2, _mm256_mul_ps(hj, _mm256_loadu_ps(p + 16)));
+            a3 = _mm256_add_ps(a3, _mm256_mul_ps(hj, _mm256_loadu_ps(p + 24)));
+        }
+        _mm256_storeu_ps(y + i, a0);
+        _mm256_storeu_ps(y + i + 8, a1);
+        _mm256_storeu_ps(y + i + 16, a2);
+        _mm256_storeu_ps(y + i + 24, a3);
+    }
+#elif defined(EQ_FIR_SSE)
+    for (; i + 16 <= n; i += 16)
+    {
+        const float *xi = x + i;
+        __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+        __m128 a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+        __m128 hj;
+        int j;
+
+        for (j = 0; j < EQ_FIR_TAPS / 2; j++)
+        {
+            const float *p = xi - j, *q = xi - (EQ_FIR_TAPS - 1 - j);
+
+            hj = _mm_set1_ps(h[j]);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(hj,
+                     _mm_add_ps(_mm_loadu_ps(p), _mm_loadu_ps(q))));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(hj,
+                     _mm_add_ps(_mm_loadu_ps(p + 4), _mm_loadu_ps(q + 4))));
+            a2 = _mm_add_ps(a2, _mm_mul_ps(hj,
+                     _mm_add_ps(_mm_loadu_ps(p + 8), _mm_loadu_ps(q + 8))));
+            a3 = _mm_add_ps(a3, _mm_mul_ps(hj,
+                     _mm_add_ps(_mm_loadu_ps(p + 12), _mm_loadu_ps(q + 12))));
+        }
+        if (EQ_FIR_TAPS & 1)
+        {
+            const float *p = xi - EQ_FIR_TAPS / 2;
+
+            hj = _mm_set1_ps(h[EQ_FIR_TAPS / 2]);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(hj, _mm_loadu_ps(p)));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(hj, _mm_loadu_ps(p + 4)));
+            a2 = _mm_add_ps(a2, _mm_mul_ps(hj, _mm_loadu_ps(p + 8)));
+            a3 = _mm_add_ps(a3, _mm_mul_ps(hj, _mm_loadu_ps(p + 12)));
+        }
+        _mm_storeu_ps(y + i, a0);
+        _mm_storeu_ps(y + i + 4, a1);
+        _mm_storeu_ps(y + i + 8, a2);
+        _mm_storeu_ps(y + i + 12, a3);
+    }
+#endif
+    eqFirSym(x + i, h, y + i, n - i);
+}
+
+/*
+ *  The vector loops work on runs of consecutive outputs: for each tap,
+ *  h[j] is broadcast and multiplied into x[i - j .. i - j + width - 1].
+ *  Four runs are kept in flight to cover the add latency.
+ */
+void eqFirFloat(const float *x, const float *h, Uint32 taps, float *y,
+                Uint32 n)
+{
+    Uint32 i = 0, j;
+
+#if defined(EQ_FIR_AVX)
+    for (; i + 32 <= n; i += 32)
+    {
+        const float *xi = x + i;
+        __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+        __m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+
+        for (j = 0; j < taps; j++, xi--)
+        {
+            __m256 hj = _mm256_set1_ps(h[j]);
+
+            a0 = _mm256_add_ps(a0, _mm256_mul_ps(hj, _mm256_loadu_ps(xi)));
+            a1 = _mm256_add_ps(a1, _mm256_mul_ps(hj, _mm256_loadu_ps(xi + 8)));
+            a2 = _mm256_add_ps(a2, _mm256_mul_ps(hj, _mm256_loadu_ps(xi + 16)));
+            a3 = _mm256_add_ps(a3, _mm256_mul_ps(hj, _mm256_loadu_ps(xi + 24)));
+        }
+        _mm256_storeu_ps(y + i, a0);
+        _mm256_storeu_ps(y + i + 8, a1);
+        _mm256_storeu_ps(y + i + 16, a2);
+        _mm256_storeu_ps(y + i + 24, a3);
+    }
+#elif defined(EQ_FIR_SSE)
+    for (; i + 16 <= n; i += 16)
+    {
+        const float *xi = x + i;
+        __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+        __m128 a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+
+        for (j = 0; j < taps; j++, xi--)
+        {
+            __m128 hj = _mm_set1_ps(h[j]);
+
+            a0 = _mm_add_ps(a0, _mm_mul_ps(hj, _mm_loadu_ps(xi)));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(hj, _mm_loadu_ps(xi + 4)));
+            a2 = _mm_add_ps(a2, _mm_mul_ps(hj, _mm_loadu_ps(xi + 8)));
+            a3 = _mm_add_ps(a3, _mm_mul_ps(hj, _mm_loadu_ps(xi + 12)));
+        }
+        _mm_storeu_ps(y + i, a0);
+        _mm_storeu_ps(y + i + 4, a1);
+        _mm_storeu_ps(y + i + 8, a2);
+        _mm_storeu_ps(y + i + 12, a3);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        const float *xi = x + i;
+        float acc = 0.0f;
+
+        for (j = 0; j < taps; j++)
+            acc += h[j] * xi[-(int)j];
+        y[i] = acc;
+    }
+}
+
+float eqFirDot(const float *x, const float *h, Uint32 taps)
+{
+    float lane[8] EQ_ALIGNED(32);
+    Uint32 j;
+
+#if defined(EQ_FIR_AVX)
+    __m256 a = _mm256_setzero_ps();
+
+    for (j = 0; j < taps; j += 8)
+        a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_loadu_ps(h + j),
+                                           _mm256_loadu_ps(x + j)));
+    _mm256_store_ps(lane, a);
+#elif defined(EQ_FIR_SSE)
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+
+    for (j = 0; j < taps; j += 8)
+    {
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(h + j),
+                                       _mm_loadu_ps(x + j)));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(h + j + 4),
+                                       _mm_loadu_ps(x + j + 4)));
+    }
+    _mm_store_ps(lane, a0);
+    _mm_store_ps(lane + 4, a1);
+#else
+    Uint32 k;
+
+    for (k = 0; k < 8; k++)
+        lane[k] = 0.0f;
+    for (j = 0; j < taps; j += 8)
+        for (k = 0; k < 8; k++)
+            lane[k] += h[j + k] * x[j + k];
+#endif
+    return ((lane[0] + lane[4]) + (lane[2] + lane[6])) +
+           ((lane[1] + lane[5]) + (lane[3] + lane[7]));
+}
+
+Uint32 eqFirQuantize(const float *h, Uint32 taps, Int16 *q)
+{
+    Uint32 shift = EQ_Q15_SHIFT, j;
+    float gain = 0.0f;
+
+    for (j = 0; j < taps; j++)
+        gain += h[j] < 0.0f ? -h[j] : h[j];
+
+    /* worst-case accumulator is gain * 32768 * 2^shift (plus rounding) */
+    while (shift > 0 && gain * 32768.0f * (float)(1u << shift) >= 2147418112.0f)
+        shift--;
+
+    for (j = 0; j < taps; j++)
+    {
+        float v = h[j] * (float)(1u << shift);
+
+        v += v < 0.0f ? -0.5f : 0.5f;
+        q[j] = v >= 32767.0f ? 32767 : v <= -32768.0f ? -32768 : (Int16)v;
+    }
+    return shift;
+}
+
+/*
+ *  The SSE2 loop pairs taps for _mm_madd_epi16: interleaving the words of
+ *  x[i - j] and x[i - j - 1] lines up each output's two samples with the
+ *  broadcast pair (q[j], q[j + 1]), giving four 32-bit sums per madd.
+ */
+void eqFirQ15(const Int16 *x, const Int16 *q, Uint32 taps, Uint32 shift,
+              Int16 *y, Uint32 n)
+{
+    Int32 round = shift ? 1 << (shift - 1) : 0;
+    Uint32 i = 0, j;
+
+#if defined(EQ_FIR_SSE)
+    for (; i + 8 <= n; i += 8)
+    {
+        const Int16 *xi = x + i;
+        __m128i lo = _mm_set1_epi32(round), hi = lo;
+
+        for (j = 0; j + 1 < taps; j += 2, xi -= 2)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)xi);
+            __m128i b = _mm_loadu_si128((const __m128i *)(xi - 1));
+            __m128i qq = _mm_set1_epi32((Uint16)q[j] |
+                                        ((Uint32)(Uint16)q[j + 1] << 16));
+
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), qq));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), qq));
+        }
+        if (j < taps)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)xi);
+            __m128i qq = _mm_set1_epi32((Uint16)q[j]);
+
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, a), qq));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, a), qq));
+        }
+        lo = _mm_sra_epi32(lo, _mm_cvtsi32_si128(shift));
+        hi = _mm_sra_epi32(hi, _mm_cvtsi32_si128(shift));
+        _mm_storeu_si128((__m128i *)(y + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        const Int16 *xi = x + i;
+        Int32 acc = round;
+
+        for (j = 0; j < taps; j++)
+            acc += (Int32)q[j] * xi[-(int)j];
+        acc >>= shift;
+        y[i] = acc > 32767 ? 32767 : acc < -32768 ? -32768 : (Int16)acc;
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ *  ======== eq_fir.h ========
+ *
+ *  FIR engine for the equalizer.  Each received frame is converted once
+ *  to one float plane per channel and appended to a persistent tail of
+ *  the previous frame, so every tap of every output sample reads
+ *  contiguous memory:
+ *
+ *      plane[c]:  [ history (EQ_PLANE_HIST samples) | frame (n/2 samples) ]
+ *                                                    ^ x[0]
+ *
+ *  x[-1] .. x[-EQ_PLANE_HIST] are the last samples of the previous frame,
+ *  and the filter loops carry no Ping/Pong boundary checks.  Consecutive
+ *  outputs read consecutive samples, so the audio filters vectorize, and
+ *  eqFirInterleave() saturates the results back into codec words (right
+ *  on even words, left on odd ones).
+ *
+ *  The LED meter filters are measured during the same sweep that fills
+ *  the planes (see eqFirLoad()).
+ *
+ *  Building with EQ_FIXED defined keeps the planes as Int16 and filters
+ *  them with Q15 coefficients and 32-bit accumulators (eqFirQ15), for
+ *  targets without a fast FPU.  Both kernels are always compiled, so they
+ *  can be compared on the host.
+ */
+#ifndef EQ_FIR_H
+#define EQ_FIR_H
+
+#include "eq_types.h"
+
+#define EQ_CHANNELS     2
+#define EQ_FIR_TAPS     101     // audio filter taps per channel
+#define EQ_LED_TAPS     13      // LED meter filter taps
+#define EQ_METERS       3       // meter filters measured per frame
+#ifndef EQ_MAX_FRAME
+#define EQ_MAX_FRAME    4096    // largest frame, in interleaved words
+#endif
+#define EQ_MAX_BLOCK    (EQ_MAX_FRAME / EQ_CHANNELS)    // samples per channel
+
+/* Plane history: EQ_FIR_TAPS - 1 samples, rounded up so x[0] is 32-byte
+   aligned */
+#define EQ_PLANE_HIST   ((EQ_FIR_TAPS - 1 + 7) & ~7)
+
+/* Plane sample: float, or the codec word itself in the fixed-point build */
+#ifdef EQ_FIXED
+typedef Int16 EqSample;
+#else
+typedef float EqSample;
+#endif
+
+typedef struct EqFir {
+    EqSample plane[EQ_CHANNELS][EQ_PLANE_HIST + EQ_MAX_BLOCK] EQ_ALIGNED(32);
+    EqSample out[EQ_CHANNELS][EQ_MAX_BLOCK] EQ_ALIGNED(32);
+} EqFir;
+
+/*
+ *  eqFirInit() - Clear the history (the stream starts from silence).
+ */
+void eqFirInit(EqFir *fir);
+
+/*
+ *  eqFirLoad() - Join n words of a new frame to the planes, and in the same
+ *                pass measure the EQ_METERS EQ_LED_TAPS-tap meter filters.
+ *                The meters run straight over the interleaved words, as
+ *                the LED code always has: output i is sum(h[j] * x[i - j])
+ *                with x the codec words, and power[k] is the sum of
+ *                squares of meter k's outputs over the frame.  If all
+ *                the meters are symmetric, pass symmetric to fold them.
+ *                With meter NULL the frame is only loaded.
+ */
+void eqFirLoad(EqFir *fir, const Int16 *frame, Uint32 n,
+               const float *meter[EQ_METERS], Uint32 symmetric,
+               float power[EQ_METERS]);
+
+/*
+ *  eqFirCommit() - Keep the tail of the loaded frame as the history for
+ *                  the next one.  Call once the frame is fully processed.
+ */
+void eqFirCommit(EqFir *fir, Uint32 n);
+
+/*
+ *  eqFirPlane() - Channel c of the loaded frame; p[-EQ_PLANE_HIST] is
+ *                 valid.
+ */
+#define eqFirPlane(fir, c)  ((fir)->plane[c] + EQ_PLANE_HIST)
+
+/*
+ *  eqFirStereo() - Filter the loaded frame of n words with the
+ *                  EQ_FIR_TAPS-tap h, each channel separately, and write
+ *                  the result to y.  A symmetric h (see
+ *                  eqFirIsSymmetric()) is folded.  The fixed-point build
+ *                  takes the Q15 form of the taps instead (see eqFirQ15()).
+ */
+#ifdef EQ_FIXED
+void eqFirStereo(EqFir *fir, const Int16 *q, Uint32 shift, Int16 *y,
+                 Uint32 n);
+#else
+void eqFirStereo(EqFir *fir, const float *h, Uint32 symmetric, Int16 *y,
+                 Uint32 n);
+#endif
+
+/*
+ *  eqFirInterleave() - Write m samples of right and left to y as codec
+ *                      words, truncated toward zero and saturated to the
+ *                      Int16 range.
+ */
+void eqFirInterleave(const EqSample *right, const EqSample *left, Int16 *y,
+                     Uint32 m);
+
+/*
+ *  eqFirFloat() - Single-channel direct form for any tap count:
+ *                 y[i] = sum(h[j] * x[i - j]), x[-(taps-1)] valid.  Uses
+ *                 AVX or SSE where the compiler targets them; each output
+ *                 is summed in tap order either way, so all builds give
+ *                 the same result.
+ */
+void eqFirFloat(const float *x, const float *h, Uint32 taps, float *y,
+                Uint32 n);
+
+/*
+ *  eqFirSymmetric() - eqFirFloat() for a symmetric EQ_FIR_TAPS-tap h,
+ *                     folded (see eq_fir_sym.h), with the same vector
+ *                     paths and the same result in every build.
+ */
+void eqFirSymmetric(const float *x, const float *h, float *y, Uint32 n);
+
+/*
+ *  eqFirDot() - sum(h[j] * x[j]) for j < taps, taps a multiple of 8.  The
+ *               products go to eight running sums by j % 8, added up in a
+ *               fixed order at the end, in every build, so the AVX, SSE
+ *               and scalar results are the same.
+ */
+float eqFirDot(const float *x, const float *h, Uint32 taps);
+
+/*
+ *  eqFirIsSymmetric() - 1 if h[j] == h[taps - 1 - j] for every j.
+ */
+Uint32 eqFirIsSymmetric(const float *h, Uint32 taps);
+
+/*
+ *  eqFirQ15() - Fixed-point direct form: y[i] = sum(q[j] * x[i - j]) in a
+ *               32-bit accumulator, rounded down by shift bits and
+ *               saturated to Int16.  q holds the taps scaled by
+ *               2^shift; the caller picks shift so that sum(|q[j]|) *
+ *               32768 stays below 2^31, which keeps the accumulator from
+ *               overflowing for any input (see eqFirQuantize()).
+ */
+void eqFirQ15(const Int16 *x, const Int16 *q, Uint32 taps, Uint32 shift,
+              Int16 *y, Uint32 n);
+
+/*
+ *  eqFirQuantize() - Convert taps h to q for eqFirQ15(): Q15, or fewer
+ *                    fractional bits if the taps need the headroom.
+ *                    Returns the shift.
+ */
+Uint32 eqFirQuantize(const float *h, Uint32 taps, Int16 *q);
+
+#endif /* EQ_FIR_H */
@@ -0,0 +1,60 @@
+/*
+ *  ======== eq_fir_sym.h ========
+ *
+ *  Symmetric (linear-phase) FIR kernels specialized at compile time on
+ *  the tap count and the sample type.  Every design in Gupta_Nair.c has
+ *  h[j] == h[taps - 1 - j], so mirrored samples are added before the
+ *  multiply and a 101-tap filter costs 51 multiplies per output instead
+ *  of 101.  With the tap count a constant the compiler unrolls short
+ *  filters, such as the 13-tap meters, completely.
+ *
+ *  Filters that are not symmetric, or whose length is only known at run
+ *  time, go through the generic eqFirFloat().
+ */
+#ifndef EQ_FIR_SYM_H
+#define EQ_FIR_SYM_H
+
+#include "eq_types.h"
+
+/*
+ *  EQ_FIR_SYM_SUM() - acc += sum(h[j] * x[step * j]) over TAPS symmetric
+ *                     taps, folded.  step is -1 to walk back from the
+ *                     newest sample of a plane, or 1 for a window whose
+ *                     element j is the sample j steps old.
+ */
+#define EQ_FIR_SYM_SUM(acc, h, x, step, TAPS)                           \
+    do {                                                                \
+        int k_;                                                         \
+                                                                        \
+        EQ_UNROLL                                                       \
+        for (k_ = 0; k_ < (TAPS) / 2; k_++)                             \
+            (acc) += (h)[k_] * ((x)[(step) * k_] +                      \
+                                (x)[(step) * ((TAPS) - 1 - k_)]);       \
+        if ((TAPS) & 1)                                                 \
+            (acc) += (h)[(TAPS) / 2] * (x)[(step) * ((TAPS) / 2)];      \
+    } while (0)
+
+/*
+ *  EQ_FIR_SYM_DEFINE() - Define
+ *
+ *      static void name(const T *x, const float *h, float *y, Uint32 n)
+ *
+ *  computing y[i] = sum(h[j] * x[i - j]) for the TAPS-tap symmetric h,
+ *  with x[-(TAPS-1)] valid.  Mirrored samples are added in T before the
+ *  multiply, which is exact for float and for Int16 (promoted to int).
+ */
+#define EQ_FIR_SYM_DEFINE(name, TAPS, T)                                \
+static void name(const T *x, const float *h, float *y, Uint32 n)        \
+{                                                                       \
+    Uint32 i;                                                           \
+                                                                        \
+    for (i = 0; i < n; i++)                                             \
+    {                                                                   \
+        float acc = 0.0f;                                               \
+                                                                        \
+        EQ_FIR_SYM_SUM(acc, h, x + i, -1, TAPS);                        \
+        y[i] = acc;                                                     \
+    }                                                                   \
+}
+
+#endif /* EQ_FIR_SYM_H */
@@ -0,0 +1,145 @@
+/*
+ *  ======== eq_iir.c ========
+ *
+ *  Biquad-cascade band splitter.  See eq_iir.h.
+ */
+#include <math.h>
+#include <string.h>
+
+#include "eq_iir.h"
+
+#define EQ_PI           3.14159265358979323846
+#define EQ_BUTTERWORTH  0.70710678118654752     // Q of each LR4 half
+
+/*
+ *  A tiny constant added at every section input keeps decaying state out
+ *  of the denormal range, which is very slow on x86.  It is 10^-18 of
+ *  an LSB; the C67x FPU flushes denormals itself.
+ */
+#define EQ_ANTI_DENORMAL    1e-18f
+
+/* Section order in z[] */
+enum { EQ_S_LPLO1, EQ_S_LPLO2, EQ_S_APHI, EQ_S_HPLO1, EQ_S_HPLO2,
+       EQ_S_LPHI1, EQ_S_LPHI2, EQ_S_HPHI1, EQ_S_HPHI2 };
+
+/* Biquad types, from the Audio EQ Cookbook */
+#define EQ_BQ_LOWPASS   0
+#define EQ_BQ_HIGHPASS  1
+#define EQ_BQ_ALLPASS   2
+
+static void eqBiquad(EqBiquad *bq, int type, double rate, double hz, double q)
+{
+    double w0 = 2.0 * EQ_PI * hz / rate;
+    double c = cos(w0), alpha = sin(w0) / (2.0 * q), a0 = 1.0 + alpha;
+
+    switch (type)
+    {
+    case EQ_BQ_LOWPASS:
+        bq->b0 = (float)((1.0 - c) / 2.0 / a0);
+        bq->b1 = (float)((1.0 - c) / a0);
+        bq->b2 = bq->b0;
+        break;
+    case EQ_BQ_HIGHPASS:
+        bq->b0 = (float)((1.0 + c) / 2.0 / a0);
+        bq->b1 = (float)(-(1.0 + c) / a0);
+        bq->b2 = bq->b0;
+        break;
+    default:
+        bq->b0 = (float)((1.0 - alpha) / a0);
+        bq->b1 = (float)(-2.0 * c / a0);
+        bq->b2 = 1.0f;
+        break;
+    }
+    bq->a1 = (float)(-2.0 * c / a0);
+    bq->a2 = (float)((1.0 - alpha) / a0);
+}
+
+void eqIirDesign(EqIir *iir, float rate, float loHz, float hiHz)
+{
+    eqBiquad(&iir->lpLo, EQ_BQ_LOWPASS, rate, loHz, EQ_BUTTERWORTH);
+    eqBiquad(&iir->hpLo, EQ_BQ_HIGHPASS, rate, loHz, EQ_BUTTERWORTH);
+    eqBiquad(&iir->lpHi, EQ_BQ_LOWPASS, rate, hiHz, EQ_BUTTERWORTH);
+    eqBiquad(&iir->hpHi, EQ_BQ_HIGHPASS, rate, hiHz, EQ_BUTTERWORTH);
+    eqBiquad(&iir->apHi, EQ_BQ_ALLPASS, rate, hiHz, EQ_BUTTERWORTH);
+    memset(iir->z, 0, sizeof(iir->z));
+}
+
+/*
+ *  eqSection() - One transposed direct form II step.
+ */
+#define eqSection(bq, z, x, y)                                          \
+    do {                                                                \
+        float in_ = (x) + EQ_ANTI_DENORMAL;                             \
+                                                                        \
+        (y) = (bq)->b0 * in_ + (z)[0];                                  \
+        (z)[0] = (bq)->b1 * in_ - (bq)->a1 * (y) + (z)[1];              \
+        (z)[1] = (bq)->b2 * in_ - (bq)->a2 * (y);                       \
+    } while (0)
+
+/*
+ *  The state of each channel is copied to locals for the frame and back
+ *  at the end, so the sample loop keeps it in registers.
+ */
+void eqIirSplit(EqIir *iir, EqFir *fir, Uint32 n)
+{
+    Uint32 m = n / EQ_CHANNELS, c, i;
+
+    for (c = 0; c < EQ_CHANNELS; c++)
+    {
+        const EqSample *x = eqFirPlane(fir, c);
+        float *lo = iir->band[0][c], *mid = iir->band[1][c];
+        float *hi = iir->band[2][c];
+        float z[EQ_IIR_SECTIONS][2];
+
+        memcpy(z, iir->z[c], sizeof(z));
+        for (i = 0; i < m; i++)
+        {
+            float t, u, h;
+
+            eqSection(&iir->lpLo, z[EQ_S_LPLO1], x[i], t);
+            eqSection(&iir->lpLo, z[EQ_S_LPLO2], t, u);
+            eqSection(&iir->apHi, z[EQ_S_APHI], u, lo[i]);
+
+            eqSection(&iir->hpLo, z[EQ_S_HPLO1], x[i], t);
+            eqSection(&iir->hpLo, z[EQ_S_HPLO2], t, h);
+
+            eqSection(&iir->lpHi, z[EQ_S_LPHI1], h, t);
+            eqSection(&iir->lpHi, z[EQ_S_LPHI2], t, mid[i]);
+
+            eqSection(&iir->hpHi, z[EQ_S_HPHI1], h, t);
+            eqSection(&iir->hpHi, z[EQ_S_HPHI2], t, hi[i]);
+        }
+        memcpy(iir->z[c], z, sizeof(z));
+    }
+}
+
+void eqIirRender(const EqIir *iir, Uint32 mask, Int16 *y, Uint32 n)
+{
+    Uint32 i, b;
+
+    for (i = 0; i < n; i++)
+    {
+        Uint32 c = i % EQ_CHANNELS, t = i / EQ_CHANNELS;
+        float v = 0.0f;
+
+        for (b = 0; b < EQ_IIR_BANDS; b++)
+            if (mask & (1u << b))
+                v += iir->band[b][c][t];
+        y[i] = v >= 32767.0f ? 32767 : v <= -32768.0f ? -32768 : (Int16)v;
+    }
+}
+
+void eqIirPower(const EqIir *iir, Uint32 n, float power[EQ_IIR_BANDS])
+{
+    Uint32 m = n / EQ_CHANNELS, b, c, i;
+
+    for (b = 0; b < EQ_IIR_BANDS; b++)
+    {
+        float p = 0.0f;
+
+        for (c = 0; c < EQ_CHANNELS; c++)
+            for (i = 0; i < m; i++)
+                p += iir->band[b][c][i] * iir->band[b][c][i];
+        power[b] = p;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ *  ======== eq_iir.h ========
+ *
+ *  Biquad-cascade band splitter: a low-latency alternative to the 101-tap
+ *  FIRs for paths where phase does not matter (the haptic output and the
+ *  band-power meters).  Fourth-order Linkwitz-Riley crossovers at loHz
+ *  and hiHz split each channel into the same three bands as the DIP
+ *  switches:
+ *
+ *      low  = AP(hi) . LP4(lo)         (AP(hi) matches the phase of the
+ *      mid  = LP4(hi) . HP4(lo)         hi crossover, so the three bands
+ *      high = HP4(hi) . HP4(lo)         sum to an allpass)
+ *
+ *  where LP4/HP4 are two Butterworth biquads in cascade: nine sections
+ *  per channel in all, with the HP4(lo) pair shared by mid and high.
+ *
+ *  eqIirSplit() runs once per frame and keeps the band outputs, so the
+ *  output for any band mask, and the crossfade between two masks, can be
+ *  rendered from them without advancing the filter state twice.  The
+ *  state persists from frame to frame in the EqIir.
+ */
+#ifndef EQ_IIR_H
+#define EQ_IIR_H
+
+#include "eq_fir.h"
+
+#define EQ_IIR_BANDS    3       // low, mid, high: EQ_LP, EQ_BP, EQ_HP
+#define EQ_IIR_SECTIONS 9
+
+/* Transposed direct form II section, normalized so a0 = 1 */
+typedef struct EqBiquad {
+    float b0, b1, b2, a1, a2;
+} EqBiquad;
+
+typedef struct EqIir {
+    EqBiquad lpLo, hpLo, lpHi, hpHi, apHi;
+    float    z[EQ_CHANNELS][EQ_IIR_SECTIONS][2];
+    float    band[EQ_IIR_BANDS][EQ_CHANNELS][EQ_MAX_BLOCK];
+} EqIir;
+
+/*
+ *  eqIirDesign() - Set the crossovers (Hz, below rate / 2) and clear the
+ *                  state.
+ */
+void eqIirDesign(EqIir *iir, float rate, float loHz, float hiHz);
+
+/*
+ *  eqIirSplit() - Split the frame of n words loaded in fir into the three
+ *                 bands, advancing the state by one frame.
+ */
+void eqIirSplit(EqIir *iir, EqFir *fir, Uint32 n);
+
+/*
+ *  eqIirRender() - Write the first n words of the sum of the bands in mask
+ *                  (EQ_BAND_* bits) to y, truncated and saturated like the
+ *                  FIR output.
+ */
+void eqIirRender(const EqIir *iir, Uint32 mask, Int16 *y, Uint32 n);
+
+/*
+ *  eqIirPower() - Sum of squares of each band over the frame of n words,
+ *                 both channels.
+ */
+void eqIirPower(const EqIir *iir, Uint32 n, float power[EQ_IIR_BANDS]);
+
+#endif /* EQ_IIR_H */
@@ -0,0 +1,246 @@
+/*
+ *  ======== eq_link.c ========
+ *
+ *  Batched motor frame protocol.  See eq_link.h.
+ */
+#include <string.h>
+
+#include "eq_link.h"
+
+#define EQ_LINK_FOREVER     0xffff      // hold of a legacy packet
+
+static void eqPut16(Uint8 *p, Uint32 v)
+{
+    p[0] = (Uint8)(v >> 8);
+    p[1] = (Uint8)v;
+}
+
+static void eqPut32(Uint8 *p, Uint32 v)
+{
+    eqPut16(p, v >> 16);
+    eqPut16(p + 2, v);
+}
+
+static Uint32 eqGet16(const Uint8 *p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+static Uint32 eqGet32(const Uint8 *p)
+{
+    return (eqGet16(p) << 16) | eqGet16(p + 2);
+}
+
+int eqLinkEncoderInit(EqLinkEncoder *e, float rate, Uint32 interval,
+                      Uint32 batch, Uint32 lead, Uint32 delay, Uint32 hold,
+                      EqLinkSend send, void *arg)
+{
+    memset(e, 0, sizeof(*e));
+    if (!(rate > 0.0f) || interval == 0 || batch == 0 ||
+        batch > EQ_LINK_MAX_INTERVALS || lead > 0xffff || delay > 0xff ||
+        hold > 0xff)
+        return -1;
+    e->rate = rate;
+    e->interval = interval;
+    e->batch = batch;
+    e->lead = lead;
+    e->delay = delay;
+    e->hold = hold;
+    e->flags = EQ_LINK_RESTART;
+    e->send = send;
+    e->arg = arg;
+    return 0;
+}
+
+Uint32 eqLinkStreamMs(const EqLinkEncoder *e, Uint32 i)
+{
+    return (Uint32)((double)i * e->interval * 1000.0 / e->rate);
+}
+
+void eqLinkFlush(EqLinkEncoder *e)
+{
+    Uint32 len = EQ_LINK_HEADER + e->count * EQ_LINK_ENTRY;
+
+    if (e->count == 0)
+        return;
+    e->msg[1] = (Uint8)e->count;
+    if (e->send)
+        e->send(e->arg, e->msg, len);
+    e->count = 0;
+    e->seq++;
+    e->flags = 0;
+    e->messages++;
+    e->bytes += len;
+}
+
+void eqLinkPacket(EqLinkEncoder *e, const Uint8 *packet)
+{
+    Uint32 now = eqLinkStreamMs(e, e->packets);
+    Uint8 *entry;
+
+    if (e->count == 0)
+    {
+        e->msg[0] = EQ_LINK_VERSION;
+        eqPut16(e->msg + 2, e->seq);
+        eqPut32(e->msg + 4, now);
+        eqPut16(e->msg + 8, e->lead);
+        eqPut16(e->msg + 10, e->flags);
+    }
+    entry = e->msg + EQ_LINK_HEADER + e->count * EQ_LINK_ENTRY;
+    eqPut16(entry, now - eqGet32(e->msg + 4));
+    entry[2] = (Uint8)e->delay;
+    entry[3] = (Uint8)e->hold;
+    memcpy(entry + 4, packet, EQ_TACTILE_PACKET);
+    e->packets++;
+    if (++e->count == e->batch)
+        eqLinkFlush(e);
+}
+
+void eqLinkSink(void *e, const Uint8 *packet)
+{
+    eqLinkPacket(e, packet);
+}
+
+void eqLinkRestart(EqLinkEncoder *e)
+{
+    eqLinkFlush(e);
+    e->flags |= EQ_LINK_RESTART;
+}
+
+void eqLinkDecoderInit(EqLinkDecoder *d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+/*
+ *  eqLinkQueue() - Add a slot in due order: a slot due at the same time
+ *                  as a queued one replaces it, an earlier one is dropped.
+ */
+static void eqLinkQueue(EqLinkDecoder *d, const EqLinkSlot *s)
+{
+    Uint32 i;
+
+    for (i = 0; i < d->count; i++)
+    {
+        EqLinkSlot *q = &d->slot[(d->head + i) % EQ_LINK_QUEUE];
+
+        if (q->due == s->due)
+        {
+            *q = *s;
+            return;
+        }
+    }
+    if (d->count > 0 &&
+        (Int32)(s->due - d->slot[(d->head + d->count - 1) %
+                                 EQ_LINK_QUEUE].due) < 0)
+    {
+        d->dropped++;
+        return;
+    }
+    if (d->count == EQ_LINK_QUEUE)
+    {
+        d->dropped++;
+        return;
+    }
+    d->slot[(d->head + d->count) % EQ_LINK_QUEUE] = *s;
+    d->count++;
+}
+
+int eqLinkReceive(EqLinkDecoder *d, const Uint8 *msg, Uint32 len,
+                  Uint32 now)
+{
+    EqLinkSlot s;
+    Uint32 n, i, k, start, seq, offset;
+
+    /* a packet as processWrite() takes it: now, until the next one */
+    if (len == EQ_TACTILE_PACKET)
+    {
+        s.due = now;
+        s.delay = 0;
+        s.hold = EQ_LINK_FOREVER;
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+            s.duty[k] = (Uint16)eqGet16(msg + 2 * k);
+        d->count = 0;
+        d->synced = 0;
+        eqLinkQueue(d, &s);
+        return 0;
+    }
+
+    n = len >= EQ_LINK_HEADER ? msg[1] : 0;
+    if (len < EQ_LINK_HEADER || msg[0] != EQ_LINK_VERSION || n == 0 ||
+        n > EQ_LINK_MAX_INTERVALS || len != EQ_LINK_HEADER + n * EQ_LINK_ENTRY)
+    {
+        d->dropped++;
+        return -1;
+    }
+    seq = eqGet16(msg + 2);
+    start = eqGet32(msg + 4);
+    offset = now + eqGet16(msg + 8) - start;
+    if (!d->synced || (eqGet16(msg + 10) & EQ_LINK_RESTART))
+    {
+        d->offset = offset;
+        d->synced = 1;
+        d->count = 0;
+    }
+    else
+    {
+        if (seq != d->seq)
+            d->gaps += (Uint16)(seq - d->seq);
+
+        /* a message that came quicker than the one the clock was set by:
+           the link's least delay is the best estimate of the sender's
+           clock, so move the queue earlier to it */
+        if ((Int32)(offset - d->offset) < 0)
+        {
+            for (i = 0; i < d->count; i++)
+                d->slot[(d->head + i) % EQ_LINK_QUEUE].due -=
+                    d->offset - offset;
+            d->offset = offset;
+        }
+    }
+    d->seq = (Uint16)(seq + 1);
+    d->messages++;
+
+    for (i = 0; i < n; i++)
+    {
+        const Uint8 *entry = msg + EQ_LINK_HEADER + i * EQ_LINK_ENTRY;
+
+        s.due = start + eqGet16(entry) + d->offset;
+        s.delay = entry[2];
+        s.hold = entry[3];
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+            s.duty[k] = (Uint16)eqGet16(entry + 4 + 2 * k);
+        if ((Int32)(now - s.due) > 0)
+            d->late++;
+        eqLinkQueue(d, &s);
+    }
+    return 0;
+}
+
+void eqLinkDuties(EqLinkDecoder *d, Uint32 now,
+                  Uint16 duty[EQ_TACTILE_MOTORS])
+{
+    const EqLinkSlot *s;
+    Int32 t;
+    Uint32 k;
+    int on;
+
+    /* the current interval is the last one due */
+    while (d->count >= 2 &&
+           (Int32)(now - d->slot[(d->head + 1) % EQ_LINK_QUEUE].due) >= 0)
+    {
+        d->head = (d->head + 1) % EQ_LINK_QUEUE;
+        d->count--;
+    }
+
+    s = &d->slot[d->head];
+    t = (Int32)(now - s->due) - s->delay;
+    if (d->count == 0 || t < 0)
+        on = 0;
+    else if (s->hold == EQ_LINK_FOREVER)
+        on = 1;
+    else
+        on = t < (s->hold ? s->hold : EQ_LINK_STALE_MS);
+    for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+        duty[k] = on ? s->duty[k] : 0;
+}
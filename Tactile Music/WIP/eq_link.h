@@ -0,0 +1,150 @@
+/*
+ *  ======== eq_link.h ========
+ *
+ *  Batched, timestamped motor frames for the link to the sleeve.
+ *  play_file() in TactileMusic_Preprocessed.py writes every interval's
+ *  8-byte packet as it is due, then an all-zero one 25 ms later, and the
+ *  ESP32's processWrite() applies each on arrival.  Every interval
+ *  therefore costs two writes, and any delay on the link reaches the
+ *  motors.  A link message instead carries the next few intervals, each
+ *  with the time it is due and its envelope, sent ahead of time.  The
+ *  receiver queues them and plays each one at its time, so a late write
+ *  only has to arrive before its first interval is due.
+ *
+ *  A message is big-endian, like the packets:
+ *
+ *      header  EQ_LINK_HEADER bytes
+ *           0  u8  version (EQ_LINK_VERSION)
+ *           1  u8  intervals n, 1..EQ_LINK_MAX_INTERVALS
+ *           2  u16 sequence number, + 1 per message
+ *           4  u32 start, ms of stream time of the first interval
+ *           8  u16 lead, ms from sending to start on the sender's clock
+ *          10  u16 flags (EQ_LINK_RESTART)
+ *      n entries of EQ_LINK_ENTRY bytes
+ *           0  u16 ms from start to the interval
+ *           2  u8  delay, ms from the interval to the motors starting
+ *           3  u8  hold, ms the motors run (0: to the next interval)
+ *           4  u16 x EQ_TACTILE_MOTORS duties, in packet order
+ *
+ *  A message is never EQ_TACTILE_PACKET bytes long, so a receiver can
+ *  take both.  The receiver ties stream time to its own clock on the
+ *  first message and on each restart: start is due lead ms after that
+ *  message arrives.  Later messages keep that mapping, so their delays
+ *  on the link do not move the motors, except that one which arrives
+ *  sooner than the mapping expects moves it earlier: the mapping settles
+ *  on the link's least delay.
+ */
+#ifndef EQ_LINK_H
+#define EQ_LINK_H
+
+#include "eq_tactile.h"
+
+#define EQ_LINK_VERSION         1
+#define EQ_LINK_HEADER          12
+#define EQ_LINK_ENTRY           (4 + EQ_TACTILE_PACKET)
+#define EQ_LINK_MAX_INTERVALS   16
+#define EQ_LINK_MAX_MESSAGE     (EQ_LINK_HEADER + \
+                                 EQ_LINK_MAX_INTERVALS * EQ_LINK_ENTRY)
+#define EQ_LINK_QUEUE           64      // intervals a receiver holds
+#define EQ_LINK_STALE_MS        500     // most a hold-0 interval runs
+
+#define EQ_LINK_RESTART         0x0001  // resynchronise, drop the queue
+
+/*
+ *  EqLinkSend - Transport: send one message of len bytes.
+ */
+typedef void (*EqLinkSend)(void *arg, const Uint8 *msg, Uint32 len);
+
+typedef struct EqLinkEncoder {
+    float      rate;                    // Hz
+    Uint32     interval;                // samples per packet
+    Uint32     batch;                   // intervals per message
+    Uint32     lead;                    // ms
+    Uint32     delay;                   // envelope, ms
+    Uint32     hold;
+    Uint32     packets;                 // packets taken
+    Uint32     count;                   // in the open message
+    Uint16     seq;
+    Uint16     flags;                   // of the next message
+    Uint32     messages;
+    Uint32     bytes;
+    EqLinkSend send;
+    void       *arg;
+    Uint8      msg[EQ_LINK_MAX_MESSAGE];
+} EqLinkEncoder;
+
+typedef struct EqLinkSlot {
+    Uint32 due;                         // local ms
+    Uint16 delay;
+    Uint16 hold;
+    Uint16 duty[EQ_TACTILE_MOTORS];
+} EqLinkSlot;
+
+typedef struct EqLinkDecoder {
+    EqLinkSlot slot[EQ_LINK_QUEUE];     // by due time
+    Uint32     head;
+    Uint32     count;
+    int        synced;
+    Uint32     offset;                  // local ms - stream ms
+    Uint16     seq;                     // expected next
+    Uint32     messages;
+    Uint32     gaps;                    // messages missing by sequence
+    Uint32     late;                    // intervals due before arrival
+    Uint32     dropped;                 // queue full or malformed
+} EqLinkDecoder;
+
+/*
+ *  eqLinkEncoderInit() - Send the packets of a stream at rate Hz and
+ *                        interval samples per packet, batch intervals
+ *                        per message (1..EQ_LINK_MAX_INTERVALS), each
+ *                        message lead ms before its first interval, with
+ *                        the envelope delay and hold (ms, up to 255).
+ *                        Returns 0, or -1 for an invalid setting.
+ */
+int  eqLinkEncoderInit(EqLinkEncoder *e, float rate, Uint32 interval,
+                       Uint32 batch, Uint32 lead, Uint32 delay, Uint32 hold,
+                       EqLinkSend send, void *arg);
+
+/*
+ *  eqLinkStreamMs() - Stream time in ms of interval i: when its message
+ *                     entry is due, and lead ms later than it is sent.
+ */
+Uint32 eqLinkStreamMs(const EqLinkEncoder *e, Uint32 i);
+
+/*
+ *  eqLinkPacket() - Add the next interval's packet; sends the message
+ *                   once it holds batch intervals.  eqLinkSink() is the
+ *                   same thing with the EqTactileSink signature.
+ */
+void eqLinkPacket(EqLinkEncoder *e, const Uint8 *packet);
+void eqLinkSink(void *e, const Uint8 *packet);
+
+/*
+ *  eqLinkFlush() - Send the open message now, if it holds any interval.
+ */
+void eqLinkFlush(EqLinkEncoder *e);
+
+/*
+ *  eqLinkRestart() - Make the next message resynchronise the receiver,
+ *                    after a seek or a pause.
+ */
+void eqLinkRestart(EqLinkEncoder *e);
+
+void eqLinkDecoderInit(EqLinkDecoder *d);
+
+/*
+ *  eqLinkReceive() - Take a message (or a legacy 8-byte packet, applied
+ *                    at once and held) that arrived at local time now,
+ *                    in ms.  Returns 0, or -1 if it was malformed.
+ */
+int  eqLinkReceive(EqLinkDecoder *d, const Uint8 *msg, Uint32 len,
+                   Uint32 now);
+
+/*
+ *  eqLinkDuties() - The motor duties at local time now (non-decreasing
+ *                   from call to call), into duty.
+ */
+void eqLinkDuties(EqLinkDecoder *d, Uint32 now,
+                  Uint16 duty[EQ_TACTILE_MOTORS]);
+
+#endif /* EQ_LINK_H */
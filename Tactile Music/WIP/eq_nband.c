@@ -0,0 +1,205 @@
+/*
+ *  ======== eq_nband.c ========
+ *
+ *  N-band equalizer bank.  See eq_nband.h.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "eq_nband.h"
+
+#define EQ_PI   3.14159265358979323846
+
+/*
+ *  eqNBandFinish() - Derive the per-band kernel data once h is filled.
+ */
+static void eqNBandFinish(EqNBand *nb)
+{
+    Uint32 b;
+
+    for (b = 0; b < nb->bands; b++)
+    {
+        nb->qShift[b] = eqFirQuantize(nb->h[b], nb->taps, nb->q[b]);
+        nb->symmetric[b] = nb->taps == EQ_FIR_TAPS &&
+                           eqFirIsSymmetric(nb->h[b], nb->taps);
+    }
+}
+
+/*
+ *  eqLowpass() - Windowed-sinc low-pass with cutoff fc (as a fraction of
+ *                the sample rate) added into h, times sign.
+ */
+static void eqLowpass(float *h, Uint32 taps, double fc, double sign)
+{
+    double mid = (taps - 1) / 2.0;
+    Uint32 i;
+
+    for (i = 0; i < taps; i++)
+    {
+        double t = i - mid;
+        double w = 0.54 - 0.46 * cos(2.0 * EQ_PI * i / (taps - 1));
+        double s = t == 0.0 ? 2.0 * fc : sin(2.0 * EQ_PI * fc * t) / (EQ_PI * t);
+
+        h[i] += (float)(sign * s * w);
+    }
+}
+
+int eqNBandDesign(EqNBand *nb, Uint32 bands, Uint32 taps, float rate,
+                  float lowHz)
+{
+    double nyq = rate / 2.0, r;
+    Uint32 b;
+
+    if (bands < EQ_NBAND_MIN || bands > EQ_NBAND_MAX || taps < 3 ||
+        taps > EQ_NBAND_TAPS || lowHz <= 0.0f || lowHz >= nyq)
+        return -1;
+
+    memset(nb, 0, sizeof(*nb));
+    nb->bands = bands;
+    nb->taps = taps;
+    r = pow(nyq / lowHz, 1.0 / (bands - 1));
+
+    for (b = 0; b < bands; b++)
+    {
+        double lo = b == 0 ? 0.0 : lowHz * pow(r, b - 1);
+        double hi = b == bands - 1 ? nyq : lowHz * pow(r, b);
+
+        /* band = lowpass(hi) - lowpass(lo), so adjacent bands telescope */
+        eqLowpass(nb->h[b], taps, hi / rate, 1.0);
+        if (b > 0)
+            eqLowpass(nb->h[b], taps, lo / rate, -1.0);
+        nb->gain[b] = 1.0f;
+        nb->lowHz[b] = (float)lo;
+        nb->highHz[b] = (float)hi;
+    }
+    eqNBandFinish(nb);
+    return 0;
+}
+
+/*
+ *  eqToken() - Next whitespace-separated token of *text, skipping '#'
+ *              comments; NULL at the end.  The token ends at *len.
+ */
+static const char *eqToken(const char **text, Uint32 *len)
+{
+    const char *p = *text, *start;
+
+    for (;;)
+    {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+            p++;
+        if (*p != '#')
+            break;
+        while (*p && *p != '\n')
+            p++;
+    }
+    if (*p == '\0')
+        return NULL;
+    start = p;
+    while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+        p++;
+    *len = p - start;
+    *text = p;
+    return start;
+}
+
+static int eqKeyword(const char **text, const char *word)
+{
+    Uint32 len;
+    const char *t = eqToken(text, &len);
+
+    return t && len == strlen(word) && !strncmp(t, word, len);
+}
+
+static int eqNumber(const char **text, double *v)
+{
+    Uint32 len;
+    const char *t = eqToken(text, &len);
+    char *end;
+
+    if (t == NULL)
+        return -1;
+    *v = strtod(t, &end);
+    return end == t + len ? 0 : -1;
+}
+
+int eqNBandParse(EqNBand *nb, const char *text)
+{
+    double v, bands, taps;
+    Uint32 b, i, len;
+
+    memset(nb, 0, sizeof(*nb));
+    if (!eqKeyword(&text, "bands") || eqNumber(&text, &bands) ||
+        !eqKeyword(&text, "taps") || eqNumber(&text, &taps))
+        return -1;
+    if (bands < EQ_NBAND_MIN || bands > EQ_NBAND_MAX || taps < 1 ||
+        taps > EQ_NBAND_TAPS)
+        return -1;
+    nb->bands = (Uint32)bands;
+    nb->taps = (Uint32)taps;
+
+    for (b = 0; b < nb->bands; b++)
+    {
+        if (!eqKeyword(&text, "band") || eqNumber(&text, &v))
+            return -1;
+        nb->gain[b] = (float)v;
+        for (i = 0; i < nb->taps; i++)
+        {
+            if (eqNumber(&text, &v))
+                return -1;
+            nb->h[b][i] = (float)v;
+        }
+    }
+    if (eqToken(&text, &len) != NULL)
+        return -1;
+    eqNBandFinish(nb);
+    return 0;
+}
+
+void eqNBandSetGain(EqNBand *nb, Uint32 band, float gain)
+{
+    if (band < nb->bands)
+        nb->gain[band] = gain;
+}
+
+void eqNBandMix(const EqNBand *nb, float mix[EQ_FIR_TAPS])
+{
+    Uint32 b, i;
+
+    memset(mix, 0, EQ_FIR_TAPS * sizeof(float));
+    for (b = 0; b < nb->bands; b++)
+        for (i = 0; i < nb->taps; i++)
+            mix[i] += nb->gain[b] * nb->h[b][i];
+}
+
+/*
+ *  Each band is filtered into the plane scratch output, which the frame's
+ *  rendering is finished with, and squared as it is summed.
+ */
+void eqNBandMeasure(const EqNBand *nb, EqFir *fir, Uint32 n, float *energy)
+{
+    Uint32 m = n / EQ_CHANNELS, b, c, i;
+    EqSample *y = fir->out[0];
+
+    for (b = 0; b < nb->bands; b++)
+    {
+        float e = 0.0f;
+
+        for (c = 0; c < EQ_CHANNELS; c++)
+        {
+#ifdef EQ_FIXED
+            eqFirQ15(eqFirPlane(fir, c), nb->q[b], nb->taps, nb->qShift[b],
+                     y, m);
+#else
+            if (nb->symmetric[b])
+                eqFirSymmetric(eqFirPlane(fir, c), nb->h[b], y, m);
+            else
+                eqFirFloat(eqFirPlane(fir, c), nb->h[b], nb->taps, y, m);
+#endif
+            for (i = 0; i < m; i++)
+                e += (float)y[i] * y[i];
+        }
+        energy[b] = e;
+    }
+}
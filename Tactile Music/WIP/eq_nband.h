@@ -0,0 +1,82 @@
+/*
+ *  ======== eq_nband.h ========
+ *
+ *  N-band graphic equalizer bank (EQ_NBAND_MIN..EQ_NBAND_MAX bands), for
+ *  driving one actuator per band on multi-actuator sleeves.
+ *
+ *  The audio output is the sum of the bands weighted by their gains.
+ *  That sum is one FIR, so eqBankBuildNBand() stores it as an ordinary
+ *  filtering bank entry and every engine mode renders it at the cost of
+ *  the three-band equalizer.  What grows with the band count is the
+ *  per-band energy each frame (eqNBandMeasure()), one filter per band.
+ *
+ *  Bands come from a text file (eqNBandParse()) or from the windowed-sinc
+ *  designer (eqNBandDesign()).  The file is whitespace separated, with
+ *  '#' starting a comment:
+ *
+ *      bands <N> taps <T>
+ *      band <gain> <h[0]> ... <h[T-1]>         (N times)
+ *
+ *  T is at most EQ_FIR_TAPS, the history the planes keep.
+ */
+#ifndef EQ_NBAND_H
+#define EQ_NBAND_H
+
+#include "eq_fir.h"
+
+#define EQ_NBAND_MIN    8
+#define EQ_NBAND_MAX    32
+#define EQ_NBAND_TAPS   EQ_FIR_TAPS     // longest band filter
+
+typedef struct EqNBand {
+    Uint32 bands;
+    Uint32 taps;
+    float  h[EQ_NBAND_MAX][EQ_NBAND_TAPS + 3] EQ_ALIGNED(16);
+    Int16  q[EQ_NBAND_MAX][EQ_NBAND_TAPS + 3]; // eqFirQ15() form of h
+    Uint32 qShift[EQ_NBAND_MAX];
+    Uint32 symmetric[EQ_NBAND_MAX];
+    float  gain[EQ_NBAND_MAX];
+    float  lowHz[EQ_NBAND_MAX];     // band edges, when designed
+    float  highHz[EQ_NBAND_MAX];
+} EqNBand;
+
+/*
+ *  eqNBandDesign() - Design bands Hamming-windowed sinc band-passes of
+ *                    taps taps, with edges spaced logarithmically from
+ *                    lowHz to the Nyquist frequency.  The first band
+ *                    extends down to DC.  With unity gains the bands sum
+ *                    to a pure delay.  A band narrower than the window's
+ *                    transition (about 3.3 * rate / taps) cannot be
+ *                    resolved and shares its energy with its neighbours.
+ *                    Returns 0, or -1 if a size is out of range.
+ */
+int  eqNBandDesign(EqNBand *nb, Uint32 bands, Uint32 taps, float rate,
+                   float lowHz);
+
+/*
+ *  eqNBandParse() - Load bands from text in the format above.  Returns 0,
+ *                   or -1 if the text is malformed or a size is out of
+ *                   range (nb is then unusable).
+ */
+int  eqNBandParse(EqNBand *nb, const char *text);
+
+/*
+ *  eqNBandSetGain() - Set one band's gain.  Rebuild any bank entry made
+ *                     from nb with eqBankBuildNBand() afterwards.
+ */
+void eqNBandSetGain(EqNBand *nb, Uint32 band, float gain);
+
+/*
+ *  eqNBandMix() - The gain-weighted sum of the bands, as EQ_FIR_TAPS taps
+ *                 (shorter bands are zero-padded).
+ */
+void eqNBandMix(const EqNBand *nb, float mix[EQ_FIR_TAPS]);
+
+/*
+ *  eqNBandMeasure() - Energy of each band (before its gain) over the
+ *                     frame of n words loaded in fir, both channels
+ *                     summed, into energy[0..nb->bands-1].
+ */
+void eqNBandMeasure(const EqNBand *nb, EqFir *fir, Uint32 n, float *energy);
+
+#endif /* EQ_NBAND_H */
@@ -0,0 +1,71 @@
+/*
+ *  ======== eq_onset.c ========
+ *
+ *  Band onset detector.  See eq_onset.h.
+ */
+#include <math.h>
+#include <string.h>
+
+#include "eq_onset.h"
+
+#define EQ_ONSET_TINY       1e-12f  // keeps log10 of silence finite
+
+void eqOnsetInit(EqOnset *o, float rate, float tau, float k, float hold,
+                 float warmup, EqOnsetSink sink, void *arg)
+{
+    memset(o, 0, sizeof(*o));
+    o->rate = rate;
+    o->tau = tau;
+    o->k = k;
+    o->hold = (Uint32)(hold * rate);
+    o->warmup = (Uint32)(warmup * rate);
+    o->sink = sink;
+    o->arg = arg;
+}
+
+Uint32 eqOnsetPush(EqOnset *o, const EqMeters *meters, Uint32 words)
+{
+    Uint32 m = words / EQ_CHANNELS, found = 0, b;
+    float alpha, rise, d, threshold;
+
+    if (m == 0)
+        return 0;
+    o->clock += m;
+    o->frames++;
+
+    /* running average until the EWMA weight takes over */
+    alpha = (float)(1.0 - exp(-(double)m / o->rate / o->tau));
+    if (alpha < 1.0f / o->frames)
+        alpha = 1.0f / o->frames;
+
+    for (b = 0; b < EQ_NUM_BANDS; b++)
+    {
+        float db = 10.0f * (float)log10(meters->power[b] / words /
+                                        EQ_FULL_SCALE2 + EQ_ONSET_TINY);
+
+        /* the first frame has nothing to rise from */
+        rise = o->frames > 1 ? db - o->db[b] : 0.0f;
+        if (rise < 0.0f)
+            rise = 0.0f;
+        o->db[b] = db;
+
+        threshold = o->mean[b] + o->k * (float)sqrt(o->var[b]);
+        if (threshold < EQ_ONSET_MIN_DB)
+            threshold = EQ_ONSET_MIN_DB;
+        if (o->clock > o->warmup && db > EQ_ADAPT_FLOOR_DB &&
+            rise > threshold &&
+            (o->onsets[b] == 0 || o->clock - o->last[b] >= o->hold))
+        {
+            found |= 1u << b;
+            o->last[b] = o->clock;
+            o->onsets[b]++;
+            if (o->sink)
+                o->sink(o->arg, b, rise - threshold, o->clock);
+        }
+
+        d = rise - o->mean[b];
+        o->mean[b] += alpha * d;
+        o->var[b] = (1.0f - alpha) * (o->var[b] + alpha * d * d);
+    }
+    return found;
+}
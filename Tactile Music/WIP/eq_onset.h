@@ -0,0 +1,77 @@
+/*
+ *  ======== eq_onset.h ========
+ *
+ *  Onset detector on the band powers.  The motors follow each band's
+ *  level over an interval (eq_tactile.h), so a passage that stays loud
+ *  keeps them running, and an attack inside an interval only counts for
+ *  as much as it raises the interval's mean.  The detector looks for the
+ *  attacks themselves: the rise in dB of each band's mean square from
+ *  one frame to the next, the log-energy derivative, with the falls
+ *  dropped.
+ *
+ *  A rise is an onset when it stands out from the recent rises of its
+ *  band: an exponentially weighted mean and variance of the rectified
+ *  rise, as eq_adapt.h keeps of the level, with a threshold k standard
+ *  deviations above the mean and at least EQ_ONSET_MIN_DB.  A band then
+ *  stays quiet for the hold time, so one attack spread over two frames
+ *  counts once.  Each onset goes to the sink with its band, its strength
+ *  (the dB by which the rise clears the threshold) and the sample count
+ *  at the end of its frame.
+ *
+ *  The hop is the frame: each frame is decided when it is measured, with
+ *  no lookahead.  A frame costs EQ_NUM_BANDS logarithms and a few
+ *  multiplies, whatever its length.
+ */
+#ifndef EQ_ONSET_H
+#define EQ_ONSET_H
+
+#include "eq_adapt.h"
+#include "eq_engine.h"
+
+#define EQ_ONSET_TAU        2.0f    // default time constant, seconds
+#define EQ_ONSET_K          2.0f    // default standard deviations
+#define EQ_ONSET_HOLD       0.1f    // default seconds between onsets
+#define EQ_ONSET_MIN_DB     6.0f    // least rise that is an onset
+
+/*
+ *  EqOnsetSink - Called with each onset: band EQ_LP..EQ_HP, strength in
+ *                dB above the threshold, and the samples (per channel)
+ *                pushed when it was found.
+ */
+typedef void (*EqOnsetSink)(void *arg, Uint32 band, float strength,
+                            Uint32 sample);
+
+typedef struct EqOnset {
+    float       rate;                   // Hz
+    float       tau;
+    float       k;
+    Uint32      hold;                   // samples
+    Uint32      warmup;                 // samples before any onset
+    Uint32      clock;                  // samples pushed
+    Uint32      frames;
+    float       db[EQ_NUM_BANDS];       // last frame's level
+    float       mean[EQ_NUM_BANDS];     // of the rises, dB
+    float       var[EQ_NUM_BANDS];
+    Uint32      last[EQ_NUM_BANDS];     // clock of the last onset
+    Uint32      onsets[EQ_NUM_BANDS];
+    EqOnsetSink sink;
+    void        *arg;
+} EqOnset;
+
+/*
+ *  eqOnsetInit() - Detect onsets at rate Hz with time constant tau and a
+ *                  threshold k standard deviations up, at least hold
+ *                  seconds apart in a band, none in the first warmup
+ *                  seconds.  sink may be NULL.
+ */
+void eqOnsetInit(EqOnset *o, float rate, float tau, float k, float hold,
+                 float warmup, EqOnsetSink sink, void *arg);
+
+/*
+ *  eqOnsetPush() - Take a frame of words interleaved words measured in
+ *                  meters.  Returns bit b set (EQ_BAND_* order) for each
+ *                  band with an onset in the frame.
+ */
+Uint32 eqOnsetPush(EqOnset *o, const EqMeters *meters, Uint32 words);
+
+#endif /* EQ_ONSET_H */
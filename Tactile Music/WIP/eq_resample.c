@@ -0,0 +1,165 @@
+/*
+ *  ======== eq_resample.c ========
+ *
+ *  Polyphase sample rate converter.  See eq_resample.h.
+ */
+#include <math.h>
+#include <string.h>
+
+#include "eq_resample.h"
+
+#define EQ_PI   3.14159265358979323846
+
+static Uint32 eqGcd(Uint32 a, Uint32 b)
+{
+    while (b)
+    {
+        Uint32 t = a % b;
+
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+ *  eqBesselI0() - Modified Bessel function of the first kind, order 0.
+ */
+static double eqBesselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    Uint32 k;
+
+    for (k = 1; k < 50 && term > 1e-12 * sum; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+int eqResamplePlan(EqResamplePlan *p, Uint32 inRate, Uint32 outRate)
+{
+    double lower, rate, dw, beta, center, wc, len;
+    Uint32 g, n, m, k, j;
+
+    memset(p, 0, sizeof(*p));
+    if (inRate == 0 || outRate == 0)
+        return -1;
+    g = eqGcd(inRate, outRate);
+    p->inRate = inRate;
+    p->outRate = outRate;
+    p->up = outRate / g;
+    p->down = inRate / g;
+
+    /* Kaiser's estimate of the length for the attenuation and width */
+    lower = inRate < outRate ? inRate : outRate;
+    rate = (double)p->up * inRate;
+    dw = 2.0 * EQ_PI * EQ_RESAMPLE_WIDTH * lower / rate;
+    len = (EQ_RESAMPLE_ATTEN - 8.0) / (2.285 * dw) + 1.0;
+    p->taps = ((Uint32)ceil(len / p->up) + 7) & ~7u;
+    if (p->taps > EQ_RESAMPLE_MAX_TAPS ||
+        (double)p->taps * p->up > EQ_RESAMPLE_MAX_COEFS)
+        return -1;
+
+    /* the sinc is centred on a whole output frame, so that seeking past
+       the delay lines the output up with the input exactly */
+    n = p->taps * p->up;
+    beta = 0.1102 * (EQ_RESAMPLE_ATTEN - 8.7);
+    center = (n - 1) / 2.0;
+    p->delay = (Uint32)(center / p->down + 0.5);
+    wc = 2.0 * EQ_PI * (lower / 2.0) / rate;
+    for (m = 0; m < n; m++)
+    {
+        double d = (double)m - (double)p->delay * p->down;
+        double r = (m - center) / center;
+        double h = d == 0.0 ? wc / EQ_PI : sin(wc * d) / (EQ_PI * d);
+
+        h *= p->up * eqBesselI0(beta * sqrt(1.0 - r * r)) / eqBesselI0(beta);
+
+        /* phase m % up, in input order: tap k meets x[b - k] */
+        k = m / p->up;
+        j = p->taps - 1 - k;
+        p->h[(m % p->up) * p->taps + j] = (float)h;
+    }
+    return 0;
+}
+
+void eqResampleInit(EqResampler *r, const EqResamplePlan *p,
+                    Uint32 channels)
+{
+    r->plan = p;
+    r->channels = channels;
+    eqResampleSeek(r, 0);
+}
+
+Uint32 eqResampleSeek(EqResampler *r, Uint32 out)
+{
+    const EqResamplePlan *p = r->plan;
+    Uint32 b = out / p->up * p->down + out % p->up * p->down / p->up;
+    Uint32 c, start = 0;
+
+    r->phase = out % p->up * p->down % p->up;
+    r->pos = p->taps - 1;
+    r->fill = 0;
+    if (b >= p->taps - 1)
+        start = b - (p->taps - 1);
+    else
+        r->fill = p->taps - 1 - b;
+    for (c = 0; c < r->channels; c++)
+        memset(r->x[c], 0, r->fill * sizeof(float));
+    return start;
+}
+
+static Int16 eqRound(float v)
+{
+    v = floorf(v + 0.5f);
+    if (v >= 32767.0f)
+        return 32767;
+    if (v <= -32768.0f)
+        return -32768;
+    return (Int16)v;
+}
+
+Uint32 eqResamplePush(EqResampler *r, const Int16 *in, Uint32 frames,
+                      Int16 *out)
+{
+    const EqResamplePlan *p = r->plan;
+    Uint32 nch = r->channels, made = 0, i, c, keep;
+
+    while (frames > 0)
+    {
+        Uint32 take = frames < EQ_RESAMPLE_CHUNK ? frames : EQ_RESAMPLE_CHUNK;
+
+        for (i = 0; i < take; i++)
+            for (c = 0; c < nch; c++)
+                r->x[c][r->fill + i] = in[i * nch + c];
+        r->fill += take;
+        in += take * nch;
+        frames -= take;
+
+        while (r->pos < r->fill)
+        {
+            const float *h = p->h + r->phase * p->taps;
+
+            for (c = 0; c < nch; c++)
+                *out++ = eqRound(eqFirDot(r->x[c] + r->pos - (p->taps - 1),
+                                          h, p->taps));
+            made++;
+            r->phase += p->down;
+            r->pos += r->phase / p->up;
+            r->phase %= p->up;
+        }
+
+        /* keep the taps - 1 inputs before the next output */
+        keep = r->pos - (p->taps - 1);
+        if (keep > r->fill)
+            keep = r->fill;
+        for (c = 0; c < nch; c++)
+            memmove(r->x[c], r->x[c] + keep,
+                    (r->fill - keep) * sizeof(float));
+        r->fill -= keep;
+        r->pos -= keep;
+    }
+    return made;
+}
@@ -0,0 +1,97 @@
+/*
+ *  ======== eq_resample.h ========
+ *
+ *  Polyphase sample rate converter for audio that does not arrive at
+ *  the analysis rate.  The FIR tables (lp/bp/hp, lp1/bp1/hp1), the
+ *  biquad crossover and the tactile bands are all laid out for 8 kHz,
+ *  the AIC23 rate the DSK runs at and the rate TactileMusic_Preprocessed.py
+ *  loads its songs at.  Converting 44.1, 48 or 96 kHz audio to that rate
+ *  first lets everything after it keep those tables, at the cost of the
+ *  8 kHz path.
+ *
+ *  A change of rate by up / down (reduced) puts up - 1 zeros after every
+ *  input sample, low-passes the result and keeps every down-th sample.
+ *  Only the kept outputs are computed, and of each one only the taps
+ *  that meet non-zero inputs: output n is
+ *
+ *      y[n] = sum(h[p + k up] x[b - k]),  b = n down / up,  p = n down % up
+ *
+ *  for k < taps, so each output costs one taps-long dot product
+ *  (eqFirDot(), vectorized) against contiguous input.  The filter is a
+ *  Kaiser-windowed sinc with its transition band centred on half the
+ *  lower rate, EQ_RESAMPLE_ATTEN dB down beyond it.
+ */
+#ifndef EQ_RESAMPLE_H
+#define EQ_RESAMPLE_H
+
+#include "eq_fir.h"
+
+#define EQ_RESAMPLE_RATE        8000    // the analysis rate, Hz
+#define EQ_RESAMPLE_MAX_TAPS    1024    // taps per phase
+#define EQ_RESAMPLE_MAX_COEFS   20480   // taps of all phases
+#define EQ_RESAMPLE_CHUNK       256     // input frames per pass
+#define EQ_RESAMPLE_ATTEN       70.0    // stop band, dB
+#define EQ_RESAMPLE_WIDTH       0.2     // transition band / lower rate
+
+typedef struct EqResamplePlan {
+    Uint32 inRate;
+    Uint32 outRate;
+    Uint32 up;                  // up / down = outRate / inRate, reduced
+    Uint32 down;
+    Uint32 taps;                // per phase, a multiple of 8
+    Uint32 delay;               // of the filter, in output frames
+    float  h[EQ_RESAMPLE_MAX_COEFS] EQ_ALIGNED(32);  // phase p at p * taps
+} EqResamplePlan;
+
+typedef struct EqResampler {
+    const EqResamplePlan *plan;
+    Uint32 channels;            // 1 or 2, interleaved
+    Uint32 fill;                // samples in x
+    Uint32 pos;                 // b of the next output, in x
+    Uint32 phase;               // p of the next output
+    float  x[EQ_CHANNELS][EQ_RESAMPLE_MAX_TAPS + EQ_RESAMPLE_CHUNK]
+           EQ_ALIGNED(32);
+} EqResampler;
+
+/*
+ *  eqResamplePlan() - Design the filter from inRate to outRate Hz.
+ *                     Returns 0, or -1 if the rates do not reduce to a
+ *                     filter of at most EQ_RESAMPLE_MAX_TAPS taps per
+ *                     phase and EQ_RESAMPLE_MAX_COEFS in all.
+ */
+int  eqResamplePlan(EqResamplePlan *p, Uint32 inRate, Uint32 outRate);
+
+/*
+ *  eqResampleInit() - Start a stream of channels-channel frames from
+ *                     silence.  Output frame 0 lines up with input frame
+ *                     0 on the up-sampled grid, so the audio comes out
+ *                     plan->delay frames late; eqResampleSeek() to the
+ *                     delay to drop it.
+ */
+void eqResampleInit(EqResampler *r, const EqResamplePlan *p,
+                    Uint32 channels);
+
+/*
+ *  eqResampleSeek() - Restart the stream so that the next output is
+ *                     frame out.  Returns the input frame to push from;
+ *                     the input before it is taken as silence if the
+ *                     filter reaches back past the start.
+ */
+Uint32 eqResampleSeek(EqResampler *r, Uint32 out);
+
+/*
+ *  eqResampleMaxOut() - Most output frames eqResamplePush() makes from
+ *                       frames input frames.
+ */
+#define eqResampleMaxOut(p, frames) \
+    ((Uint32)(((frames) * (double)(p)->up) / (p)->down) + 1)
+
+/*
+ *  eqResamplePush() - Convert frames interleaved input frames, writing
+ *                     every output frame they complete to out (rounded
+ *                     and saturated).  Returns the number written.
+ */
+Uint32 eqResamplePush(EqResampler *r, const Int16 *in, Uint32 frames,
+                      Int16 *out);
+
+#endif /* EQ_RESAMPLE_H */
@@ -0,0 +1,217 @@
+/*
+ *  ======== eq_sched.c ========
+ *
+ *  Sample-clock motor scheduler.  See eq_sched.h.
+ */
+#include <string.h>
+
+#include "eq_sched.h"
+
+#ifndef HOST_SIM
+#include <hwi.h>
+#include <swi.h>
+#endif
+
+void eqSchedInit(EqSched *s, float rate, Uint32 frame, float tickMs,
+                 Uint32 interval, Uint32 delay, EqTactileSink sink,
+                 void *arg)
+{
+    memset(s, 0, sizeof(*s));
+    s->rate = rate;
+    s->frame = frame;
+    s->tickSamples = rate * tickMs / 1000.0f;
+    s->interval = interval;
+    s->delay = delay;
+    s->sink = sink;
+    s->arg = arg;
+}
+
+/*
+ *  eqSchedBin() - Log2 histogram bin of samples, in microseconds.
+ */
+static Uint32 eqSchedBin(const EqSched *s, float samples)
+{
+    Uint32 us = (Uint32)(samples * 1e6f / s->rate), bin = 0;
+
+    while (us > 1 && bin < EQ_SCHED_BINS - 1)
+    {
+        us >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+/*
+ *  eqSchedNow() - The sample clock: the frames, and the ticks since the
+ *                 last one up to the end of the frame in progress.  The
+ *                 pair is read with eqSchedFrame() held off.
+ */
+static Uint32 eqSchedNow(const EqSched *s)
+{
+    Uns csr = HWI_disable();
+    Uint32 clock = s->clock, sub = (Uint32)s->sub;
+
+    HWI_restore(csr);
+    return clock + (sub < s->frame ? sub : s->frame);
+}
+
+static void eqSchedRelease(EqSched *s, const EqSchedEvent *e, Uint32 now)
+{
+    Uint32 error = now - e->due;
+
+    s->released++;
+    s->sumError += error;
+    if (error > s->maxError)
+        s->maxError = error;
+    s->errorHist[eqSchedBin(s, (float)error)]++;
+    if (s->sink)
+        s->sink(s->arg, e->packet);
+}
+
+/*
+ *  eqSchedRun() - Release every queued packet that is due.  SWIs must be
+ *                 disabled.
+ */
+static void eqSchedRun(EqSched *s)
+{
+    Uint32 now = eqSchedNow(s);
+
+    while (s->count && (Int32)(now - s->queue[s->head].due) >= 0)
+    {
+        eqSchedRelease(s, &s->queue[s->head], now);
+        s->head = (s->head + 1) % EQ_SCHED_QUEUE;
+        s->count--;
+    }
+}
+
+void eqSchedFrame(EqSched *s)
+{
+    float skew = s->sub - s->frame;
+
+    /* the drift counts from the first frame, when the codec's clock is
+       known to be running */
+    if (s->frames == 0)
+        s->tickTotal = 0.0;
+    else
+    {
+        if (skew < 0.0f)
+            skew = -skew;
+        if (skew > s->maxSkew)
+            s->maxSkew = skew;
+        s->skewHist[eqSchedBin(s, skew)]++;
+    }
+
+    s->frames++;
+    s->clock += s->frame;
+    s->sub = 0.0f;
+}
+
+void eqSchedTick(EqSched *s)
+{
+    Uns csr = HWI_disable();
+
+    /* eqSchedFrame() must not reset sub between the read and the write */
+    s->ticks++;
+    s->tickTotal += s->tickSamples;
+    s->sub += s->tickSamples;
+    HWI_restore(csr);
+
+    SWI_disable();
+    eqSchedRun(s);
+    SWI_enable();
+}
+
+void eqSchedSink(void *arg, const Uint8 *packet)
+{
+    EqSched *s = arg;
+    EqSchedEvent *e;
+    Uint32 due = (s->posted + 1) * s->interval + s->delay;
+
+    s->posted++;
+    SWI_disable();
+    if ((Int32)(eqSchedNow(s) - due) >= 0)
+    {
+        EqSchedEvent now;
+
+        now.due = due;
+        memcpy(now.packet, packet, EQ_TACTILE_PACKET);
+        s->late++;
+        eqSchedRun(s);
+        eqSchedRelease(s, &now, eqSchedNow(s));
+    }
+    else if (s->count == EQ_SCHED_QUEUE)
+        s->dropped++;
+    else
+    {
+        e = &s->queue[(s->head + s->count) % EQ_SCHED_QUEUE];
+        e->due = due;
+        memcpy(e->packet, packet, EQ_TACTILE_PACKET);
+        s->count++;
+    }
+    SWI_enable();
+}
+
+/*
+ *  eqSchedAudio() - Samples of the sample clock since the first frame.
+ */
+static double eqSchedAudio(const EqSched *s)
+{
+    Uns csr = HWI_disable();
+    double audio = s->frames ? (double)(s->clock - s->frame) + s->sub : 0.0;
+
+    HWI_restore(csr);
+    return audio;
+}
+
+void eqSchedFlush(EqSched *s)
+{
+    SWI_disable();
+    while (s->count)
+    {
+        EqSchedEvent *e = &s->queue[s->head];
+
+        s->head = (s->head + 1) % EQ_SCHED_QUEUE;
+        s->count--;
+        if (s->sink)
+            s->sink(s->arg, e->packet);
+    }
+    SWI_enable();
+}
+
+float eqSchedDriftPpm(const EqSched *s)
+{
+    double audio = eqSchedAudio(s), ticks;
+    Uns csr = HWI_disable();
+
+    ticks = s->tickTotal;
+    HWI_restore(csr);
+    return audio > 0.0 ? (float)((ticks / audio - 1.0) * 1e6) : 0.0f;
+}
+
+static void eqSchedHist(const char *name, const Uint32 *hist, FILE *f)
+{
+    Uint32 b, last;
+
+    for (last = EQ_SCHED_BINS; last > 1 && hist[last - 1] == 0; last--)
+        ;
+    fprintf(f, "%s", name);
+    for (b = 0; b < last; b++)
+        fprintf(f, " %u", hist[b]);
+    fprintf(f, "\n");
+}
+
+void eqSchedDump(const EqSched *s, FILE *f)
+{
+    float us = 1e6f / s->rate;
+
+    fprintf(f, "eqsched frames %u ticks %u drift_ppm %.1f drift_us %.1f "
+            "max_frame_skew_us %.1f packets %u late %u dropped %u "
+            "mean_error_us %.1f max_error_us %.1f\n", s->frames, s->ticks,
+            eqSchedDriftPpm(s),
+            (s->tickTotal - eqSchedAudio(s)) * us,
+            s->maxSkew * us, s->released, s->late, s->dropped,
+            s->released ? s->sumError / s->released * us : 0.0,
+            s->maxError * us);
+    eqSchedHist("error_hist", s->errorHist, f);
+    eqSchedHist("skew_hist", s->skewHist, f);
+}
@@ -0,0 +1,124 @@
+/*
+ *  ======== eq_sched.h ========
+ *
+ *  Motor packets released on the audio sample clock.  play_file() in
+ *  TactileMusic_Preprocessed.py paces its writes with time.time() and
+ *  asyncio.sleep(), so the motors follow the host's wall clock while the
+ *  audio follows the sound card's, and the two drift apart.  On the DSK
+ *  the codec's clock is exact: every edmaHwi() completes gBuffSize / 2
+ *  more samples.  The scheduler keeps that count as its time base:
+ *
+ *      eqSchedFrame()  edmaHwi(), for each frame completed: the clock
+ *                      moves on by a frame
+ *      eqSchedTick()   a periodic timer thread (PRD), every tickMs: the
+ *                      clock moves on by a tick's worth of samples, but
+ *                      never past the end of the frame in progress
+ *
+ *  Ticks only fill in between frames, so the clock always comes back to
+ *  the codec's count and cannot drift from the audio; a late frame holds
+ *  the motors rather than running ahead of it.  The encoder's packets
+ *  come in through eqSchedSink(), each due delay samples after the end
+ *  of its interval, and each is released to the sink on the first tick
+ *  at or past that point (never from the interrupt).  A packet that
+ *  comes in after it is due goes out at once and is counted as late.
+ *
+ *  The timer is what a wall-clock scheduler would follow, so the ticks
+ *  also measure the drift: the ticks' samples minus the frames' samples,
+ *  in total and over each frame.  The release errors and the per-frame
+ *  differences are kept in log2 histograms of microseconds, as in
+ *  eq_stats.h.
+ *
+ *  Three threads share the state.  eqSchedFrame() runs in the interrupt
+ *  and alone writes the frame count, so eqSchedTick() advances the ticks
+ *  and every reader takes the clock with interrupts disabled.  The queue
+ *  is filled from the audio SWI and emptied from the PRD's, each with
+ *  SWIs disabled; the sink is called that way too, so packets reach it in
+ *  order.
+ */
+#ifndef EQ_SCHED_H
+#define EQ_SCHED_H
+
+#include <stdio.h>
+
+#include "eq_tactile.h"
+
+#define EQ_SCHED_QUEUE  32      // packets waiting
+#define EQ_SCHED_BINS   20      // bin k: [2^k, 2^(k+1)) us; 0 from 0, last open
+
+typedef struct EqSchedEvent {
+    Uint32 due;                 // sample clock
+    Uint8  packet[EQ_TACTILE_PACKET];
+} EqSchedEvent;
+
+typedef struct EqSched {
+    float         rate;         // Hz
+    Uint32        frame;        // samples per frame
+    float         tickSamples;  // samples per tick
+    Uint32        interval;     // samples per packet
+    Uint32        delay;        // samples from an interval's end to release
+    Uint32        clock;        // samples at the last frame
+    float         sub;          // samples of ticks since
+    Uint32        frames;
+    Uint32        ticks;
+    double        tickTotal;    // samples of all ticks
+    Uint32        posted;       // packets in
+    Uint32        head;
+    Uint32        count;
+    EqSchedEvent  queue[EQ_SCHED_QUEUE];
+    EqTactileSink sink;
+    void          *arg;
+    Uint32        released;
+    Uint32        late;
+    Uint32        dropped;      // queue full
+    double        sumError;     // release error, samples
+    Uint32        maxError;
+    float         maxSkew;      // largest per-frame drift, samples
+    Uint32        errorHist[EQ_SCHED_BINS];
+    Uint32        skewHist[EQ_SCHED_BINS];
+} EqSched;
+
+/*
+ *  eqSchedInit() - Schedule packets of interval samples each, released
+ *                  delay samples after their interval ends, to sink, on a
+ *                  clock of frame samples per frame at rate Hz and a tick
+ *                  every tickMs.
+ */
+void eqSchedInit(EqSched *s, float rate, Uint32 frame, float tickMs,
+                 Uint32 interval, Uint32 delay, EqTactileSink sink,
+                 void *arg);
+
+void eqSchedFrame(EqSched *s);
+void eqSchedTick(EqSched *s);
+
+/*
+ *  eqSchedSink() - Take the encoder's next packet (EqTactileSink).
+ */
+void eqSchedSink(void *s, const Uint8 *packet);
+
+/*
+ *  eqSchedFlush() - Send every packet still waiting, at the end of the
+ *                   stream.  They are not counted as released.
+ */
+void eqSchedFlush(EqSched *s);
+
+/*
+ *  eqSchedDriftPpm() - Timer against sample clock so far, parts per
+ *                      million; positive if the timer runs fast.
+ */
+float eqSchedDriftPpm(const EqSched *s);
+
+/*
+ *  eqSchedDump() - Write the statistics to f:
+ *
+ *      eqsched frames <n> ticks <t> drift_ppm <d> drift_us <u>
+ *              max_frame_skew_us <k> packets <p> late <l> dropped <x>
+ *              mean_error_us <e> max_error_us <m>
+ *      error_hist <b0> ...
+ *      skew_hist <b0> ...
+ *
+ *                  (the first is one line).  Trailing empty histogram bins
+ *                  are left out.
+ */
+void eqSchedDump(const EqSched *s, FILE *f);
+
+#endif /* EQ_SCHED_H */
@@ -0,0 +1,114 @@
+/*
+ *  ======== eq_sdft.c ========
+ *
+ *  Sliding DFT band energies.  See eq_sdft.h.
+ */
+#include <math.h>
+#include <string.h>
+
+#include "eq_sdft.h"
+
+#define EQ_PI           3.14159265358979323846
+#define EQ_FULL_SCALE   32768.0f
+
+int eqSdftInit(EqSdft *s, float rate, float loHz, float hiHz, float hop,
+               float window, EqSdftSink out, void *arg)
+{
+    float samples = rate * hop, hops;
+    Uint32 k;
+
+    memset(s, 0, sizeof(*s));
+    if (!(samples >= 1.0f))
+        return -1;
+    s->hop = (Uint32)samples;
+    if ((float)s->hop < samples)
+        s->hop++;
+    hops = window * rate / s->hop;
+    s->hops = (Uint32)hops;
+    if ((float)s->hops < hops)
+        s->hops++;
+    if (s->hops == 0)
+        s->hops = 1;
+    if (s->hops > EQ_SDFT_MAX_HOPS)
+        return -1;
+
+    for (k = 0; k < EQ_SDFT_BINS; k++)
+    {
+        double w = 2.0 * EQ_PI * k / EQ_SDFT_SIZE;
+        float hz = (float)k * rate / EQ_SDFT_SIZE;
+
+        s->cosw[k] = (float)cos(w);
+        s->sinw[k] = (float)sin(w);
+        s->weight[k] = (k == 0 || k == EQ_SDFT_SIZE / 2 ? 1.0f : 2.0f) /
+                       ((float)EQ_SDFT_SIZE * EQ_SDFT_SIZE);
+        s->band[k] = hz < loHz ? EQ_LP : hz < hiHz ? EQ_BP : EQ_HP;
+    }
+    s->dampN = (float)pow(EQ_SDFT_DAMP, EQ_SDFT_SIZE);
+    s->out = out;
+    s->arg = arg;
+    return 0;
+}
+
+/*
+ *  eqSdftHop() - Close the current hop and report the window.
+ */
+static void eqSdftHop(EqSdft *s)
+{
+    float ms[EQ_NUM_BANDS] = { 0.0f, 0.0f, 0.0f };
+    Uint32 b, h;
+
+    for (b = 0; b < EQ_NUM_BANDS; b++)
+    {
+        s->hist[s->next][b] = s->acc[b];
+        s->acc[b] = 0.0f;
+    }
+    s->next = (s->next + 1) % s->hops;
+    if (s->seen < s->hops)
+        s->seen++;
+    s->fill = 0;
+
+    /* summed afresh each time, so nothing drifts */
+    for (h = 0; h < s->hops; h++)
+        for (b = 0; b < EQ_NUM_BANDS; b++)
+            ms[b] += s->hist[h][b];
+    for (b = 0; b < EQ_NUM_BANDS; b++)
+        ms[b] /= (float)(s->seen * s->hop);
+    if (s->out)
+        s->out(s->arg, ms);
+}
+
+Uint32 eqSdftPush(EqSdft *s, const Int16 *words, Uint32 n)
+{
+    Uint32 i, k, hops = 0;
+
+    for (i = 0; i + 1 < n; i += EQ_CHANNELS)
+    {
+        float x = (words[i] + words[i + 1]) * (0.5f / EQ_FULL_SCALE);
+        float d = x - s->dampN * s->x[s->pos];
+        float e[EQ_NUM_BANDS] = { 0.0f, 0.0f, 0.0f };
+
+        s->x[s->pos] = x;
+        s->pos = (s->pos + 1) % EQ_SDFT_SIZE;
+
+        for (k = 0; k < EQ_SDFT_BINS; k++)
+        {
+            float re = EQ_SDFT_DAMP * s->re[k] + d;
+            float im = EQ_SDFT_DAMP * s->im[k];
+
+            s->re[k] = re * s->cosw[k] - im * s->sinw[k];
+            s->im[k] = re * s->sinw[k] + im * s->cosw[k];
+            e[s->band[k]] += s->weight[k] *
+                             (s->re[k] * s->re[k] + s->im[k] * s->im[k]);
+        }
+        s->acc[EQ_LP] += e[EQ_LP];
+        s->acc[EQ_BP] += e[EQ_BP];
+        s->acc[EQ_HP] += e[EQ_HP];
+
+        if (++s->fill == s->hop)
+        {
+            eqSdftHop(s);
+            hops++;
+        }
+    }
+    return hops;
+}
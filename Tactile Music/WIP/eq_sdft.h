@@ -0,0 +1,78 @@
+/*
+ *  ======== eq_sdft.h ========
+ *
+ *  Sliding-window band energies for the haptic path, at a fixed cost per
+ *  sample.  audio_to_tactile() takes an FFT of every 100 ms interval and
+ *  adds up the bins of each band.  Here a sliding DFT of EQ_SDFT_SIZE
+ *  points is updated with every sample instead:
+ *
+ *      X[k] = W^k (r X[k] + x[n] - r^N x[n - N]),  W = e^(2 pi j / N)
+ *
+ *  for the bins 0..N/2.  The damping r < 1 (EQ_SDFT_DAMP) keeps float
+ *  round-off from building up in the recursion.  By Parseval, the bins
+ *  of a band give that band's mean square over the last N samples.  It
+ *  is added up over each hop, and the last window / hop hops are summed
+ *  into the band powers of a window that slides by one hop.  N = 64
+ *  puts the bins 125 Hz apart at 8 kHz, so the 1 and 2 kHz band edges
+ *  fall on bins.
+ *
+ *  Each sample costs the same N/2 + 1 complex updates, whatever the hop
+ *  and window are.  Hops can therefore be a few milliseconds long while
+ *  windows overlap by any amount.  Each window costs window / hop adds.
+ *  Stereo input is analysed as the mean of the two channels.
+ */
+#ifndef EQ_SDFT_H
+#define EQ_SDFT_H
+
+#include "eq_bank.h"
+
+#define EQ_SDFT_SIZE        64      // N, points of the sliding DFT
+#define EQ_SDFT_BINS        (EQ_SDFT_SIZE / 2 + 1)
+#define EQ_SDFT_MAX_HOPS    128     // hops in a window: 1 ms hops over 100 ms
+#define EQ_SDFT_DAMP        0.9999f
+
+/*
+ *  EqSdftSink - Called at the end of each hop with the mean square of
+ *               each band (EQ_LP..EQ_HP, full scale = 1) over the window
+ *               that ends there.
+ */
+typedef void (*EqSdftSink)(void *arg, const float ms[EQ_NUM_BANDS]);
+
+typedef struct EqSdft {
+    float      re[EQ_SDFT_BINS];
+    float      im[EQ_SDFT_BINS];
+    float      cosw[EQ_SDFT_BINS];      // W^k
+    float      sinw[EQ_SDFT_BINS];
+    float      weight[EQ_SDFT_BINS];    // 1 or 2 (both sides), / N^2
+    Uint32     band[EQ_SDFT_BINS];      // EQ_LP.. of each bin
+    float      dampN;                   // r^N
+    float      x[EQ_SDFT_SIZE];         // the last N samples
+    Uint32     pos;
+    Uint32     hop;                     // samples per hop
+    Uint32     fill;                    // samples in the current hop
+    float      acc[EQ_NUM_BANDS];       // current hop
+    float      hist[EQ_SDFT_MAX_HOPS][EQ_NUM_BANDS];    // past hops
+    Uint32     hops;                    // hops in a window
+    Uint32     next;                    // oldest entry of hist
+    Uint32     seen;                    // hops so far, up to hops
+    EqSdftSink out;
+    void       *arg;
+} EqSdft;
+
+/*
+ *  eqSdftInit() - Bands split at loHz and hiHz, at rate Hz, reported
+ *                 every hop seconds over the last window seconds (both
+ *                 rounded to whole samples and hops).  Returns 0, or -1
+ *                 if the hop is shorter than a sample or the window
+ *                 holds more than EQ_SDFT_MAX_HOPS hops.
+ */
+int  eqSdftInit(EqSdft *s, float rate, float loHz, float hiHz, float hop,
+                float window, EqSdftSink out, void *arg);
+
+/*
+ *  eqSdftPush() - Analyse n interleaved codec words.  Returns the number
+ *                 of hops completed.
+ */
+Uint32 eqSdftPush(EqSdft *s, const Int16 *words, Uint32 n);
+
+#endif /* EQ_SDFT_H */
@@ -0,0 +1,117 @@
+/*
+ *  ======== eq_stats.c ========
+ *
+ *  Frame timing statistics.  See eq_stats.h.
+ */
+#include <string.h>
+
+#include "eq_stats.h"
+
+/*
+ *  With the 12 MHz clock in USB mode the AIC23 register holds USB in bit 0,
+ *  BOSR in bit 1, SR in bits 2-5 and CLKIN (halve the clock) in bit 6.
+ *  These are the rates the DSK6713 BSL's frequency table uses.
+ */
+Uint32 eqStatsCodecRate(Uint32 reg)
+{
+    Uint32 bosr = (reg >> 1) & 1, sr = (reg >> 2) & 0xf, rate;
+
+    if (!(reg & 1))
+        return 0;
+    switch (sr)
+    {
+    case 0:  rate = bosr ? 0 : 48000; break;
+    case 3:  rate = bosr ? 8021 : 8000; break;
+    case 6:  rate = bosr ? 0 : 32000; break;
+    case 7:  rate = bosr ? 0 : 96000; break;
+    case 8:  rate = bosr ? 44100 : 0; break;
+    default: rate = 0; break;
+    }
+    return (reg & 0x40) ? rate / 2 : rate;
+}
+
+void eqStatsInit(EqStats *st, float countsPerMs, Uint32 frameSamples,
+                 Uint32 depth, Uint32 rate)
+{
+    memset(st, 0, sizeof(*st));
+    st->countsPerUs = countsPerMs / 1000.0f;
+    st->rate = rate;
+    if (rate)
+    {
+        st->period = (Uint32)(countsPerMs * 1000.0f * frameSamples / rate);
+        st->deadline = st->period * (depth - 1);
+    }
+}
+
+void eqStatsIsr(EqStats *st, Uint32 now, Uint32 buf)
+{
+    Uint32 bit = 1u << (buf % EQ_STATS_RING);
+
+    if (st->pending & bit)
+        st->overruns++;
+    st->isrTime[buf % EQ_STATS_RING] = now;
+    st->pending |= bit;
+    st->isrs++;
+}
+
+void eqStatsStart(EqStats *st, Uint32 now, Uint32 buf)
+{
+    Uint32 latency = now - st->isrTime[buf % EQ_STATS_RING];
+
+    st->startTime[buf % EQ_STATS_RING] = now;
+    if (latency > st->maxLatency)
+        st->maxLatency = latency;
+}
+
+void eqStatsEnd(EqStats *st, Uint32 now, Uint32 buf, Uint32 mode)
+{
+    EqStatsMode *m = &st->mode[mode % EQ_STATS_MODES];
+    Uint32 b = buf % EQ_STATS_RING;
+    Uint32 exec = now - st->startTime[b], response = now - st->isrTime[b];
+    Uint32 us = (Uint32)(exec / st->countsPerUs), bin = 0;
+
+    st->pending &= ~(1u << b);
+    if (response > st->maxResponse)
+        st->maxResponse = response;
+
+    m->frames++;
+    if (st->deadline && response > st->deadline)
+        m->misses++;
+    if (exec > m->maxExec)
+        m->maxExec = exec;
+    m->sumExec += exec;
+
+    while (us > 1 && bin < EQ_STATS_BINS - 1)
+    {
+        us >>= 1;
+        bin++;
+    }
+    m->hist[bin]++;
+}
+
+void eqStatsDump(const EqStats *st, FILE *f)
+{
+    float perUs = st->countsPerUs;
+    Uint32 i, b, last;
+
+    fprintf(f, "eqstats rate %u period_us %.0f deadline_us %.0f frames %u "
+            "overruns %u max_latency_us %.1f max_response_us %.1f\n",
+            st->rate, st->period / perUs, st->deadline / perUs, st->isrs,
+            st->overruns, st->maxLatency / perUs, st->maxResponse / perUs);
+
+    for (i = 0; i < EQ_STATS_MODES; i++)
+    {
+        const EqStatsMode *m = &st->mode[i];
+
+        if (m->frames == 0)
+            continue;
+        for (last = EQ_STATS_BINS; last > 1 && m->hist[last - 1] == 0; last--)
+            ;
+        fprintf(f, "mode %u frames %u misses %u mean_us %.1f max_us %.1f "
+                "hist", i, m->frames, m->misses,
+                m->sumExec / m->frames / perUs, m->maxExec / perUs);
+        for (b = 0; b < last; b++)
+            fprintf(f, " %u", m->hist[b]);
+        fprintf(f, "\n");
+    }
+}
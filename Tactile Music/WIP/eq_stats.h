@@ -0,0 +1,92 @@
+/*
+ *  ======== eq_stats.h ========
+ *
+ *  Frame timing of the EDMA -> SWI -> processBuffer() chain.  The caller
+ *  stamps three points of each frame with a free-running counter
+ *  (CLK_gethtime() on the DSK, CLOCK_MONOTONIC in the host simulation):
+ *
+ *      eqStatsIsr()    edmaHwi() entry, for the interrupt that completes
+ *                      a frame and posts processBufferSwi
+ *      eqStatsStart()  processBuffer() entry
+ *      eqStatsEnd()    processBuffer() exit
+ *
+ *  Each stamp names the ring buffer the frame is in.  With a ring of
+ *  depth buffers the transmit EDMA reaches a buffer depth - 1 frame
+ *  periods after the interrupt that handed it over, so a frame that ends
+ *  later than that misses its deadline.  Execution times are kept per
+ *  DIP mode in log2 histograms of microseconds.  An interrupt for a
+ *  buffer whose previous frame has not ended is counted as an overrun:
+ *  the ring has wrapped and a frame is lost.
+ *
+ *  Stamps are only ever subtracted, so a counter that wraps is fine as
+ *  long as one frame takes less than a full wrap.
+ */
+#ifndef EQ_STATS_H
+#define EQ_STATS_H
+
+#include <stdio.h>
+
+#include "eq_types.h"
+
+#define EQ_STATS_MODES  16      // DIP values
+#define EQ_STATS_RING   8       // deepest buffer ring
+#define EQ_STATS_BINS   20      // bin k: [2^k, 2^(k+1)) us; 0 from 0, last open
+
+typedef struct EqStatsMode {
+    Uint32 frames;
+    Uint32 misses;
+    Uint32 maxExec;             // counts
+    double sumExec;             // counts, for the mean
+    Uint32 hist[EQ_STATS_BINS];
+} EqStatsMode;
+
+typedef struct EqStats {
+    float       countsPerUs;    // stamp counts per microsecond
+    Uint32      rate;           // Hz, from the codec setting
+    Uint32      period;         // one frame, counts
+    Uint32      deadline;       // depth - 1 frames, counts
+    Uint32      isrTime[EQ_STATS_RING];     // stamps of the frames in flight
+    Uint32      startTime[EQ_STATS_RING];
+    Uint32      pending;        // bit b: buffer b's frame not yet ended
+    Uint32      isrs;
+    Uint32      overruns;
+    Uint32      maxLatency;     // interrupt to processBuffer() entry
+    Uint32      maxResponse;    // interrupt to processBuffer() exit
+    EqStatsMode mode[EQ_STATS_MODES];
+} EqStats;
+
+/*
+ *  eqStatsCodecRate() - Sample rate in Hz selected by the AIC23 sample rate
+ *                       control register value reg with the DSK's 12 MHz
+ *                       USB-mode clock, or 0 for a setting it does not
+ *                       know.
+ */
+Uint32 eqStatsCodecRate(Uint32 reg);
+
+/*
+ *  eqStatsInit() - Clear the statistics for a ring of depth buffers of
+ *                  frameSamples samples per channel at rate Hz, stamped by
+ *                  a counter running at countsPerMs.  rate 0 disables the
+ *                  deadline check.
+ */
+void eqStatsInit(EqStats *st, float countsPerMs, Uint32 frameSamples,
+                 Uint32 depth, Uint32 rate);
+
+void eqStatsIsr(EqStats *st, Uint32 now, Uint32 buf);
+void eqStatsStart(EqStats *st, Uint32 now, Uint32 buf);
+void eqStatsEnd(EqStats *st, Uint32 now, Uint32 buf, Uint32 mode);
+
+/*
+ *  eqStatsDump() - Write the statistics to f, one summary line and one
+ *                  line per DIP mode that ran:
+ *
+ *      eqstats rate <Hz> period_us <p> deadline_us <d> frames <n>
+ *              overruns <o> max_latency_us <l> max_response_us <r>
+ *      mode <m> frames <n> misses <x> mean_us <e> max_us <e> hist <b0> ...
+ *
+ *                  (the first is one line).  Trailing empty histogram bins
+ *                  are left out.
+ */
+void eqStatsDump(const EqStats *st, FILE *f);
+
+#endif /* EQ_STATS_H */
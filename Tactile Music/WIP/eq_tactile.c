@@ -0,0 +1,144 @@
+/*
+ *  ======== eq_tactile.c ========
+ *
+ *  Streaming vibrotactile encoder.  See eq_tactile.h.
+ */
+#include <string.h>
+
+#include "eq_tactile.h"
+
+int eqTactileInit(EqTactile *t, float rate, float interval, float warmup,
+                  EqTactileSink sink, void *arg)
+{
+    float samples = rate * interval;
+    Uint32 k;
+
+    memset(t, 0, sizeof(*t));
+    if (!(samples >= 1.0f))
+        return -1;
+    t->rate = rate;
+    t->interval = (Uint32)samples;
+    if ((float)t->interval < samples)
+        t->interval++;
+    for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+        eqAdaptInit(&t->adapt[k], t->interval / rate, EQ_ADAPT_TAU,
+                    EQ_ADAPT_K, warmup);
+    t->sink = sink;
+    t->arg = arg;
+    return 0;
+}
+
+/*
+ *  eqTactileDuty() - Duty of motor k for the interval, at level decision
+ *                    on.
+ */
+static Uint32 eqTactileDuty(const EqTactile *t, Uint32 k, int on)
+{
+    float s = t->strength[k] / EQ_TACTILE_ONSET_DB;
+
+    if (!((t->onset >> k) & 1))
+        return on && t->mode != EQ_TACTILE_ONSETS_ONLY ? EQ_TACTILE_ON : 0;
+    if (s > 1.0f)
+        s = 1.0f;
+    return EQ_TACTILE_ON + (Uint32)(s * (EQ_TACTILE_MAX - EQ_TACTILE_ON));
+}
+
+/*
+ *  eqTactileEmit() - Send the packet for mean squares ms, by motor.
+ */
+static void eqTactileEmit(EqTactile *t, const float ms[EQ_TACTILE_MOTORS])
+{
+    Uint32 k;
+
+    for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+    {
+        Uint32 duty = eqTactileDuty(t, k, eqAdaptStep(&t->adapt[k], ms[k]));
+
+        t->last[2 * k] = (Uint8)(duty >> 8);
+        t->last[2 * k + 1] = (Uint8)duty;
+    }
+    t->onset = 0;
+    t->packets++;
+    if (t->sink)
+        t->sink(t->arg, t->last);
+}
+
+void eqTactileStep(EqTactile *t, const float ms[EQ_NUM_BANDS])
+{
+    float m[EQ_TACTILE_MOTORS];
+
+    m[EQ_TACTILE_LP] = ms[EQ_LP];
+    m[EQ_TACTILE_BP] = ms[EQ_BP];
+    m[EQ_TACTILE_HP] = ms[EQ_HP];
+    m[EQ_TACTILE_ALL] = ms[EQ_LP] + ms[EQ_BP] + ms[EQ_HP];
+    eqTactileEmit(t, m);
+}
+
+void eqTactileSdftSink(void *t, const float ms[EQ_NUM_BANDS])
+{
+    eqTactileStep(t, ms);
+}
+
+void eqTactileOnsets(EqTactile *t, Uint32 mode)
+{
+    t->mode = mode;
+}
+
+void eqTactileOnsetSink(void *arg, Uint32 band, float strength, Uint32 sample)
+{
+    static const Uint32 motor[EQ_NUM_BANDS] = { EQ_TACTILE_LP, EQ_TACTILE_BP,
+                                                EQ_TACTILE_HP };
+    EqTactile *t = arg;
+    Uint32 k, m[2] = { motor[band % EQ_NUM_BANDS], EQ_TACTILE_ALL };
+
+    (void)sample;
+    if (t->mode == EQ_TACTILE_LEVEL)
+        return;
+    for (k = 0; k < 2; k++)
+    {
+        if (!((t->onset >> m[k]) & 1) || strength > t->strength[m[k]])
+            t->strength[m[k]] = strength;
+        t->onset |= 1u << m[k];
+    }
+}
+
+Uint32 eqTactilePush(EqTactile *t, const EqMeters *meters, Uint32 words)
+{
+    Uint32 m = words / EQ_CHANNELS, done = 0, packets = t->packets, k;
+    float ms[EQ_TACTILE_MOTORS], mean[EQ_TACTILE_MOTORS];
+
+    if (words == 0)
+        return 0;
+
+    /* mean square per sample of each motor's signal over the frame */
+    ms[EQ_TACTILE_LP] = meters->power[EQ_LP] / words / EQ_FULL_SCALE2;
+    ms[EQ_TACTILE_BP] = meters->power[EQ_BP] / words / EQ_FULL_SCALE2;
+    ms[EQ_TACTILE_HP] = meters->power[EQ_HP] / words / EQ_FULL_SCALE2;
+    ms[EQ_TACTILE_ALL] = ms[EQ_TACTILE_LP] + ms[EQ_TACTILE_BP] +
+                         ms[EQ_TACTILE_HP];
+
+    /* split the frame at interval ends */
+    while (done < m)
+    {
+        Uint32 take = m - done;
+
+        if (take > t->interval - t->fill)
+            take = t->interval - t->fill;
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+            t->sum[k] += ms[k] * take;
+
+        t->fill += take;
+        done += take;
+        if (t->fill == t->interval)
+        {
+            for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+            {
+                mean[k] = t->sum[k] / t->interval;
+                t->sum[k] = 0.0f;
+            }
+            t->fill = 0;
+            eqTactileEmit(t, mean);
+        }
+    }
+    return t->packets - packets;
+}
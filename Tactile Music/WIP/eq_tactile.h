@@ -0,0 +1,129 @@
+/*
+ *  ======== eq_tactile.h ========
+ *
+ *  Streaming vibrotactile encoder.  Turns the band powers measured by
+ *  eqEngineProcess() into the packets that the sleeve's ESP32
+ *  (ESP32_Code_TactileMusic/main.py, processWrite()) uses to set its four
+ *  motor duties.  Each packet is four big-endian 16-bit duties and covers
+ *  one interval of audio:
+ *
+ *      bytes 0-1   whole signal        (up)
+ *      bytes 2-3   low band, 0-1 kHz   (left)
+ *      bytes 4-5   mid band, 1-2 kHz   (down)
+ *      bytes 6-7   high band, 2-4 kHz  (right)
+ *
+ *  This is audio_to_tactile() from TactileMusic_Preprocessed.py, worked
+ *  out frame by frame as the audio arrives rather than over the whole
+ *  file before playback.  By Parseval, the script's per-interval FFT
+ *  power in a band is proportional to the band's mean square over the
+ *  interval, so the encoder works from the mean squares.  A motor runs
+ *  at EQ_TACTILE_ON for an interval that its band's adaptive threshold
+ *  (eq_adapt.h) marks as on.  The script compared against "Hotel
+ *  California" levels scaled by an FFT of the whole song; the adaptive
+ *  threshold follows the song as it plays instead.  No motor runs during
+ *  the warm-up.
+ *
+ *  With the biquad meters (EQ_PATH_IIR) the bands are the script's FFT
+ *  bins.  With the FIR meters they are the 13-tap LED filters.  The
+ *  whole-signal power is taken as the sum of the three bands.  Each
+ *  frame's power is spread evenly over its samples, so intervals do not
+ *  have to line up with frames.  The state has a fixed size.
+ *
+ *  The onsets of eq_onset.h can drive the motors as well, through
+ *  eqTactileOnsetSink(): a motor whose band had an onset during the
+ *  interval runs in its packet, harder the stronger the onset, from
+ *  EQ_TACTILE_ON up to EQ_TACTILE_MAX.  The whole-signal motor takes the
+ *  strongest onset of any band.  With EQ_TACTILE_ONSETS the onsets are
+ *  added to the level decisions, so an attack inside a quiet interval is
+ *  felt; with EQ_TACTILE_ONSETS_ONLY they replace them, and a passage
+ *  that stays loud no longer keeps the motors on.
+ */
+#ifndef EQ_TACTILE_H
+#define EQ_TACTILE_H
+
+#include "eq_adapt.h"
+#include "eq_engine.h"
+
+#define EQ_TACTILE_MOTORS   4
+#define EQ_TACTILE_PACKET   (2 * EQ_TACTILE_MOTORS)     // bytes
+#define EQ_TACTILE_ON       850     // duty of a running motor, of 1023
+#define EQ_TACTILE_MAX      1023
+#define EQ_TACTILE_ONSET_DB 12.0f   // onset strength that runs at MAX
+
+/* What runs the motors (eqTactileOnsets()) */
+#define EQ_TACTILE_LEVEL        0   // the adaptive level threshold
+#define EQ_TACTILE_ONSETS       1   // the level or an onset
+#define EQ_TACTILE_ONSETS_ONLY  2   // an onset
+
+/* Motor order in the packet */
+#define EQ_TACTILE_ALL      0
+#define EQ_TACTILE_LP       1
+#define EQ_TACTILE_BP       2
+#define EQ_TACTILE_HP       3
+
+/*
+ *  EqTactileSink - Called with each packet as it is completed; arg is the
+ *                  one given to eqTactileInit().
+ */
+typedef void (*EqTactileSink)(void *arg, const Uint8 *packet);
+
+typedef struct EqTactile {
+    float         rate;             // Hz
+    Uint32        interval;         // samples per packet
+    Uint32        fill;             // samples in the current interval
+    float         sum[EQ_TACTILE_MOTORS];   // mean square x samples
+    EqAdapt       adapt[EQ_TACTILE_MOTORS]; // threshold per motor
+    Uint32        packets;          // packets completed
+    Uint32        mode;             // EQ_TACTILE_LEVEL, ..
+    Uint32        onset;            // bit k: motor k had an onset
+    float         strength[EQ_TACTILE_MOTORS];  // the strongest, dB
+    Uint8         last[EQ_TACTILE_PACKET];
+    EqTactileSink sink;
+    void          *arg;
+} EqTactile;
+
+/*
+ *  eqTactileInit() - Start a stream at rate Hz with one packet every
+ *                    interval seconds, rounded up to whole samples as in
+ *                    the script.  The motors stay off for the first
+ *                    warmup seconds while the thresholds settle.  sink
+ *                    may be NULL; the latest packet is always in last.
+ *                    Returns 0, or -1 if the interval is shorter than a
+ *                    sample.
+ */
+int eqTactileInit(EqTactile *t, float rate, float interval, float warmup,
+                  EqTactileSink sink, void *arg);
+
+/*
+ *  eqTactilePush() - Add a frame of words interleaved words measured in
+ *                    meters, and pass each packet it completes to the
+ *                    sink.  Returns the number of packets completed.
+ */
+Uint32 eqTactilePush(EqTactile *t, const EqMeters *meters, Uint32 words);
+
+/*
+ *  eqTactileStep() - Send one packet for an interval whose band mean
+ *                    squares (EQ_LP..EQ_HP, full scale = 1) were measured
+ *                    elsewhere, such as by eq_sdft.h.  eqTactileSdftSink()
+ *                    is the same thing with the EqSdftSink signature.  Use
+ *                    this or eqTactilePush() on a stream, not both.
+ */
+void eqTactileStep(EqTactile *t, const float ms[EQ_NUM_BANDS]);
+void eqTactileSdftSink(void *t, const float ms[EQ_NUM_BANDS]);
+
+/*
+ *  eqTactileOnsets() - Choose what runs the motors: EQ_TACTILE_LEVEL (the
+ *                      default), EQ_TACTILE_ONSETS or
+ *                      EQ_TACTILE_ONSETS_ONLY.
+ */
+void eqTactileOnsets(EqTactile *t, Uint32 mode);
+
+/*
+ *  eqTactileOnsetSink() - EqOnsetSink that marks an onset in the interval
+ *                         in progress.  Push each frame to the detector
+ *                         before the encoder, so an onset counts for the
+ *                         first interval the frame completes.
+ */
+void eqTactileOnsetSink(void *t, Uint32 band, float strength, Uint32 sample);
+
+#endif /* EQ_TACTILE_H */
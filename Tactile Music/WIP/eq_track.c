@@ -0,0 +1,421 @@
+/*
+ *  ======== eq_track.c ========
+ *
+ *  TTRK tactile track writer and reader.  See eq_track.h.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "eq_track.h"
+
+static Uint32 getLe32(const Uint8 *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((Uint32)p[3] << 24);
+}
+
+static Uint32 getLe16(const Uint8 *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static void putLe32(Uint8 *p, Uint32 v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void putLe16(Uint8 *p, Uint32 v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+/* CRC-32 (IEEE, reflected), continued from crc; start from 0 */
+static Uint32 eqTrackCrc(Uint32 crc, const Uint8 *p, Uint32 n)
+{
+    Uint32 i;
+    int b;
+
+    crc = ~crc;
+    for (i = 0; i < n; i++)
+    {
+        crc ^= p[i];
+        for (b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+void eqTrackInfoTactile(EqTrackInfo *info, const EqTactile *t)
+{
+    Uint16 nyquist = (Uint16)(t->rate / 2.0f);
+
+    info->sampleRate = (Uint32)t->rate;
+    info->interval = t->interval;
+    info->lowHz[EQ_TACTILE_ALL] = 0;
+    info->highHz[EQ_TACTILE_ALL] = nyquist;
+    info->lowHz[EQ_TACTILE_LP] = 0;
+    info->highHz[EQ_TACTILE_LP] = (Uint16)EQ_IIR_LO_HZ;
+    info->lowHz[EQ_TACTILE_BP] = (Uint16)EQ_IIR_LO_HZ;
+    info->highHz[EQ_TACTILE_BP] = (Uint16)EQ_IIR_HI_HZ;
+    info->lowHz[EQ_TACTILE_HP] = (Uint16)EQ_IIR_HI_HZ;
+    info->highHz[EQ_TACTILE_HP] = nyquist;
+}
+
+/*
+ *  ---- writer ----
+ */
+
+static void eqTrackPutVarint(EqTrackWriter *w, Uint32 v)
+{
+    while (v >= 0x80)
+    {
+        w->block[w->blockLen++] = (Uint8)(v | 0x80);
+        v >>= 7;
+    }
+    w->block[w->blockLen++] = (Uint8)v;
+}
+
+/*
+ *  eqTrackEndRun() - Encode the open run into the block.
+ */
+static void eqTrackEndRun(EqTrackWriter *w)
+{
+    Uint32 mask = 0, at, k;
+
+    if (w->run == 0)
+        return;
+    at = w->blockLen++;
+    for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+    {
+        Int16 d = (Int16)(w->runValue[k] - w->prev[k]);
+
+        if (d == 0)
+            continue;
+        mask |= 1u << k;
+        /* zigzag, shifted unsigned: d may be negative */
+        eqTrackPutVarint(w, (Uint16)(((Uint16)d << 1) ^ (Uint16)(d >> 15)));
+        w->prev[k] = w->runValue[k];
+    }
+    w->block[at] = (Uint8)mask;
+    eqTrackPutVarint(w, w->run);
+    w->run = 0;
+}
+
+/*
+ *  eqTrackEndBlock() - Write the open block and list it in the index.
+ */
+static void eqTrackEndBlock(EqTrackWriter *w)
+{
+    eqTrackEndRun(w);
+    if (w->inBlock == 0)
+        return;
+
+    if (w->blocks == w->indexCap)
+    {
+        Uint32 cap = w->indexCap ? 2 * w->indexCap : 256;
+        Uint32 *index = realloc(w->index, cap * sizeof(Uint32));
+
+        if (index == NULL)
+        {
+            w->error = 1;
+            return;
+        }
+        w->index = index;
+        w->indexCap = cap;
+    }
+    w->index[w->blocks++] = w->dataBytes;
+
+    if (fwrite(w->block, 1, w->blockLen, w->f) != w->blockLen)
+        w->error = 1;
+    w->crc = eqTrackCrc(w->crc, w->block, w->blockLen);
+    w->dataBytes += w->blockLen;
+    w->blockLen = 0;
+    w->inBlock = 0;
+    memset(w->prev, 0, sizeof(w->prev));
+}
+
+int eqTrackWriterOpen(EqTrackWriter *w, FILE *f, const EqTrackInfo *info)
+{
+    Uint8 hdr[EQ_TRACK_HEADER];
+
+    memset(w, 0, sizeof(*w));
+    w->f = f;
+    w->info = *info;
+    memset(hdr, 0, sizeof(hdr));
+    if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr))
+        w->error = 1;
+    return w->error ? -1 : 0;
+}
+
+void eqTrackWrite(EqTrackWriter *w, const Uint8 *packet)
+{
+    Uint16 v[EQ_TACTILE_MOTORS];
+    Uint32 k;
+
+    for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+        v[k] = (Uint16)((packet[2 * k] << 8) | packet[2 * k + 1]);
+
+    if (w->run == 0 || memcmp(v, w->runValue, sizeof(v)))
+    {
+        eqTrackEndRun(w);
+        memcpy(w->runValue, v, sizeof(v));
+    }
+    w->run++;
+    w->packets++;
+    if (++w->inBlock == EQ_TRACK_BLOCK)
+        eqTrackEndBlock(w);
+}
+
+void eqTrackSink(void *w, const Uint8 *packet)
+{
+    eqTrackWrite(w, packet);
+}
+
+int eqTrackWriterClose(EqTrackWriter *w)
+{
+    Uint8 hdr[EQ_TRACK_HEADER], word[4];
+    Uint32 i, k;
+
+    eqTrackEndBlock(w);
+    for (i = 0; i < w->blocks; i++)
+    {
+        putLe32(word, w->index[i]);
+        if (fwrite(word, 1, 4, w->f) != 4)
+            w->error = 1;
+    }
+
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, "TTRK", 4);
+    putLe16(hdr + 4, EQ_TRACK_VERSION);
+    putLe16(hdr + 6, EQ_TRACK_HEADER);
+    putLe32(hdr + 8, w->info.sampleRate);
+    putLe32(hdr + 12, w->info.interval);
+    putLe16(hdr + 16, EQ_TACTILE_MOTORS);
+    putLe16(hdr + 18, EQ_TRACK_BLOCK);
+    putLe32(hdr + 20, w->packets);
+    putLe32(hdr + 24, w->blocks);
+    putLe32(hdr + 28, EQ_TRACK_HEADER + w->dataBytes);
+    putLe32(hdr + 32, EQ_TRACK_HEADER);
+    putLe32(hdr + 36, w->dataBytes);
+    putLe32(hdr + 40, w->crc);
+    for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+    {
+        putLe16(hdr + 44 + 4 * k, w->info.lowHz[k]);
+        putLe16(hdr + 46 + 4 * k, w->info.highHz[k]);
+    }
+    if (fseek(w->f, 0, SEEK_SET) != 0 ||
+        fwrite(hdr, 1, sizeof(hdr), w->f) != sizeof(hdr) ||
+        fseek(w->f, 0, SEEK_END) != 0)
+        w->error = 1;
+
+    free(w->index);
+    w->index = NULL;
+    return w->error ? -1 : 0;
+}
+
+/*
+ *  ---- reader ----
+ */
+
+int eqTrackOpen(EqTrack *t, const void *base, Uint32 length)
+{
+    const Uint8 *p = base;
+    Uint32 headerBytes, indexOffset, dataOffset, k;
+
+    memset(t, 0, sizeof(*t));
+    if (length < EQ_TRACK_HEADER || memcmp(p, "TTRK", 4) ||
+        getLe16(p + 4) != EQ_TRACK_VERSION)
+        return -1;
+
+    headerBytes = getLe16(p + 6);
+    t->info.sampleRate = getLe32(p + 8);
+    t->info.interval = getLe32(p + 12);
+    t->blockPackets = getLe16(p + 18);
+    t->packets = getLe32(p + 20);
+    t->blocks = getLe32(p + 24);
+    indexOffset = getLe32(p + 28);
+    dataOffset = getLe32(p + 32);
+    t->dataBytes = getLe32(p + 36);
+    t->crc = getLe32(p + 40);
+    for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+    {
+        t->info.lowHz[k] = (Uint16)getLe16(p + 44 + 4 * k);
+        t->info.highHz[k] = (Uint16)getLe16(p + 46 + 4 * k);
+    }
+
+    if (headerBytes < EQ_TRACK_HEADER ||
+        getLe16(p + 16) != EQ_TACTILE_MOTORS ||
+        t->info.sampleRate == 0 || t->info.interval == 0 ||
+        t->blockPackets == 0 ||
+        t->blocks != t->packets / t->blockPackets +
+                     (t->packets % t->blockPackets != 0) ||
+        dataOffset < headerBytes || dataOffset > length ||
+        t->dataBytes > length - dataOffset ||
+        indexOffset > length || t->blocks > (length - indexOffset) / 4)
+        return -1;
+
+    t->base = p;
+    t->length = length;
+    t->index = p + indexOffset;
+    t->data = p + dataOffset;
+    return 0;
+}
+
+Uint32 eqTrackPacketAt(const EqTrack *t, float seconds)
+{
+    float packet = seconds * t->info.sampleRate / t->info.interval;
+
+    if (!(packet > 0.0f))
+        return 0;
+    return packet >= (float)t->packets ? t->packets : (Uint32)packet;
+}
+
+/*
+ *  eqTrackBlock() - Point c at the start of block b.
+ */
+static int eqTrackBlock(const EqTrack *t, EqTrackCursor *c, Uint32 b)
+{
+    Uint32 start = getLe32(t->index + 4 * b);
+    Uint32 end = b + 1 < t->blocks ? getLe32(t->index + 4 * (b + 1))
+                                   : t->dataBytes;
+
+    if (start > end || end > t->dataBytes)
+        return -1;
+    c->p = t->data + start;
+    c->end = t->data + end;
+    c->packet = b * t->blockPackets;
+    c->left = t->packets - c->packet;
+    if (c->left > t->blockPackets)
+        c->left = t->blockPackets;
+    c->run = 0;
+    memset(c->value, 0, sizeof(c->value));
+    return 0;
+}
+
+static int eqTrackGetVarint(EqTrackCursor *c, Uint32 *v)
+{
+    Uint32 shift;
+
+    *v = 0;
+    for (shift = 0; shift < 21; shift += 7)
+    {
+        if (c->p == c->end)
+            return -1;
+        *v |= (Uint32)(*c->p & 0x7f) << shift;
+        if (!(*c->p++ & 0x80))
+            return 0;
+    }
+    return -1;
+}
+
+int eqTrackSeek(const EqTrack *t, EqTrackCursor *c, Uint32 packet)
+{
+    Uint32 skip;
+
+    memset(c, 0, sizeof(*c));
+    c->track = t;
+    if (packet >= t->packets)
+    {
+        c->packet = t->packets;
+        return 0;
+    }
+    if (eqTrackBlock(t, c, packet / t->blockPackets) != 0)
+        return -1;
+    for (skip = packet % t->blockPackets; skip > 0; skip--)
+        if (eqTrackNext(c, NULL) != 1)
+            return -1;
+    return 0;
+}
+
+int eqTrackNext(EqTrackCursor *c, Uint8 *packet)
+{
+    const EqTrack *t = c->track;
+    Uint32 k, v;
+
+    if (c->packet >= t->packets)
+        return 0;
+    if (c->left == 0 && eqTrackBlock(t, c, c->packet / t->blockPackets) != 0)
+        return -1;
+
+    if (c->run == 0)
+    {
+        Uint32 mask;
+
+        if (c->p == c->end)
+            return -1;
+        mask = *c->p++;
+        if (mask >> EQ_TACTILE_MOTORS)
+            return -1;
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+        {
+            if (!(mask & (1u << k)))
+                continue;
+            if (eqTrackGetVarint(c, &v) != 0 || v > 0xffff)
+                return -1;
+            c->value[k] += (Uint16)((v >> 1) ^ (0u - (v & 1)));
+        }
+        if (eqTrackGetVarint(c, &c->run) != 0 || c->run == 0 ||
+            c->run > c->left)
+            return -1;
+    }
+
+    if (packet)
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+        {
+            packet[2 * k] = (Uint8)(c->value[k] >> 8);
+            packet[2 * k + 1] = (Uint8)c->value[k];
+        }
+    c->run--;
+    c->left--;
+    c->packet++;
+    return 1;
+}
+
+int eqTrackCheck(const EqTrack *t, FILE *f)
+{
+    EqTrackCursor c;
+    Uint32 b, n;
+
+    if (eqTrackCrc(0, t->data, t->dataBytes) != t->crc)
+    {
+        if (f)
+            fprintf(f, "data checksum mismatch\n");
+        return -1;
+    }
+    if (t->blocks && getLe32(t->index) != 0)
+    {
+        if (f)
+            fprintf(f, "first block is not at the data offset\n");
+        return -1;
+    }
+    for (b = 0; b < t->blocks; b++)
+    {
+        memset(&c, 0, sizeof(c));
+        c.track = t;
+        if (eqTrackBlock(t, &c, b) != 0)
+        {
+            if (f)
+                fprintf(f, "block %u: bad index entry\n", b);
+            return -1;
+        }
+        for (n = c.left; n > 0; n--)
+            if (eqTrackNext(&c, NULL) != 1)
+            {
+                if (f)
+                    fprintf(f, "block %u: corrupt at packet %u\n", b,
+                            c.packet);
+                return -1;
+            }
+        if (c.p != c.end)
+        {
+            if (f)
+                fprintf(f, "block %u: %u bytes left over\n", b,
+                        (Uint32)(c.end - c.p));
+            return -1;
+        }
+    }
+    return 0;
+}
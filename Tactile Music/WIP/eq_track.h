@@ -0,0 +1,162 @@
+/*
+ *  ======== eq_track.h ========
+ *
+ *  TTRK, the file format for precomputed tactile tracks: the packets of
+ *  eq_tactile.h for a whole song, small enough to keep and laid out so a
+ *  player can map the file and start at any time without decoding what
+ *  comes before.  All fields are little-endian.
+ *
+ *      header  EQ_TRACK_HEADER bytes
+ *           0  "TTRK"
+ *           4  u16 version (EQ_TRACK_VERSION), u16 header bytes
+ *           8  u32 sample rate, Hz
+ *          12  u32 interval, samples per packet
+ *          16  u16 channels (EQ_TACTILE_MOTORS), u16 packets per block
+ *          20  u32 packets
+ *          24  u32 blocks
+ *          28  u32 index offset, from the start of the file
+ *          32  u32 data offset, from the start of the file
+ *          36  u32 data bytes
+ *          40  u32 CRC-32 of the data
+ *          44  u16 low and high edge in Hz of each channel's band
+ *          60  u32 reserved, 0
+ *      data    the blocks, back to back
+ *      index   u32 offset of each block from the data offset
+ *
+ *  Every block holds the next "packets per block" packets (fewer in the
+ *  last) and starts from all-zero duties, so it decodes on its own and
+ *  the index is the seek table: reaching packet p takes one lookup and
+ *  at most a block's worth of decoding.  Inside a block, each run of
+ *  identical packets is one entry:
+ *
+ *      u8      mask, bit k set if channel k changed from the last run
+ *      varint  zigzag 16-bit delta of each changed channel, in order
+ *      varint  run length, >= 1
+ *
+ *  Varints are 7 bits per byte, low first, high bit set on all but the
+ *  last.  The tactile duties are mostly 0 or EQ_TACTILE_ON, so a run
+ *  usually costs two or three bytes.
+ */
+#ifndef EQ_TRACK_H
+#define EQ_TRACK_H
+
+#include <stdio.h>
+
+#include "eq_tactile.h"
+
+#define EQ_TRACK_VERSION    1
+#define EQ_TRACK_HEADER     64      // bytes
+#define EQ_TRACK_BLOCK      64      // packets per block the writer uses
+#define EQ_TRACK_ENTRY_MAX  (1 + 3 * EQ_TACTILE_MOTORS + 3)  // bytes
+#define EQ_TRACK_BLOCK_MAX  (EQ_TRACK_BLOCK * EQ_TRACK_ENTRY_MAX)
+
+typedef struct EqTrackInfo {
+    Uint32 sampleRate;
+    Uint32 interval;                    // samples per packet
+    Uint16 lowHz[EQ_TACTILE_MOTORS];    // band of each channel
+    Uint16 highHz[EQ_TACTILE_MOTORS];
+} EqTrackInfo;
+
+/* A track in memory, usually a mapped file; see eqTrackOpen() */
+typedef struct EqTrack {
+    const Uint8 *base;
+    Uint32      length;
+    EqTrackInfo info;
+    Uint32      packets;
+    Uint32      blockPackets;
+    Uint32      blocks;
+    const Uint8 *index;
+    const Uint8 *data;
+    Uint32      dataBytes;
+    Uint32      crc;
+} EqTrack;
+
+typedef struct EqTrackCursor {
+    const EqTrack *track;
+    const Uint8   *p;               // next entry
+    const Uint8   *end;             // end of the block
+    Uint32        packet;           // index of the next packet
+    Uint32        left;             // packets left in the block
+    Uint32        run;              // packets left in the current run
+    Uint16        value[EQ_TACTILE_MOTORS];
+} EqTrackCursor;
+
+typedef struct EqTrackWriter {
+    FILE        *f;
+    EqTrackInfo info;
+    Uint32      packets;
+    Uint32      dataBytes;
+    Uint32      crc;
+    Uint32      *index;             // block offsets so far
+    Uint32      blocks;
+    Uint32      indexCap;
+    Uint32      inBlock;            // packets in the open block
+    Uint32      run;                // packets in the open run
+    Uint16      runValue[EQ_TACTILE_MOTORS];
+    Uint16      prev[EQ_TACTILE_MOTORS];    // the run before it
+    Uint32      blockLen;
+    Uint8       block[EQ_TRACK_BLOCK_MAX];
+    int         error;
+} EqTrackWriter;
+
+/*
+ *  eqTrackInfoTactile() - The header of a track of t's packets: its rate
+ *                         and interval, and the encoder's bands.
+ */
+void eqTrackInfoTactile(EqTrackInfo *info, const EqTactile *t);
+
+/*
+ *  eqTrackWriterOpen() - Start a track on f, which must be seekable.
+ *                        Returns 0, or -1 on a write error.
+ */
+int  eqTrackWriterOpen(EqTrackWriter *w, FILE *f, const EqTrackInfo *info);
+
+/*
+ *  eqTrackWrite() - Append a packet.  eqTrackSink() is the same thing
+ *                   with the EqTactileSink signature, to take the packets
+ *                   straight from an encoder.
+ */
+void eqTrackWrite(EqTrackWriter *w, const Uint8 *packet);
+void eqTrackSink(void *w, const Uint8 *packet);
+
+/*
+ *  eqTrackWriterClose() - Write the index and the header.  Returns 0, or
+ *                         -1 if anything failed to write.  Does not close
+ *                         f.
+ */
+int  eqTrackWriterClose(EqTrackWriter *w);
+
+/*
+ *  eqTrackOpen() - Check the header and index of the length bytes at base
+ *                  and describe them in t; base must stay valid.  Returns
+ *                  0, or -1 if they are not a track this code reads.
+ */
+int  eqTrackOpen(EqTrack *t, const void *base, Uint32 length);
+
+/*
+ *  eqTrackPacketAt() - The packet that plays at seconds into the track.
+ */
+Uint32 eqTrackPacketAt(const EqTrack *t, float seconds);
+
+/*
+ *  eqTrackSeek() - Point c at packet (clamped to the end).  Returns 0, or
+ *                  -1 if the block is corrupt.
+ */
+int  eqTrackSeek(const EqTrack *t, EqTrackCursor *c, Uint32 packet);
+
+/*
+ *  eqTrackNext() - Copy the cursor's packet to packet (EQ_TACTILE_PACKET
+ *                  bytes, as sent) and advance.  Returns 1, 0 at the end,
+ *                  or -1 if the data is corrupt.
+ */
+int  eqTrackNext(EqTrackCursor *c, Uint8 *packet);
+
+/*
+ *  eqTrackCheck() - Validate the whole track: the data checksum, and that
+ *                   every block decodes to exactly its packets within its
+ *                   bounds.  Returns 0, or -1 after printing the first
+ *                   problem to f (if not NULL).
+ */
+int  eqTrackCheck(const EqTrack *t, FILE *f);
+
+#endif /* EQ_TRACK_H */
@@ -0,0 +1,64 @@
+/*
+ *  ======== eq_types.h ========
+ *
+ *  Basic DSP/BIOS types (Int16, Uint32, ...) for the equalizer engine
+ *  modules, which build both for the DSK and for the host simulation.
+ */
+#ifndef EQ_TYPES_H
+#define EQ_TYPES_H
+
+#ifdef HOST_SIM
+#include "host/dsk_sim.h"
+#else
+#include <std.h>
+#endif
+
+/*
+ *  EQ_ALIGNED(n) aligns a structure member for wide loads.  Globals on the
+ *  DSK are aligned with #pragma DATA_ALIGN where they are defined.
+ */
+#if defined(__GNUC__)
+#define EQ_ALIGNED(n)       __attribute__((aligned(n)))
+#else
+#define EQ_ALIGNED(n)
+#endif
+
+/*
+ *  EQ_UNROLL precedes a loop with a short constant trip count that should
+ *  be unrolled completely.
+ */
+#if defined(__clang__)
+#define EQ_UNROLL           _Pragma("unroll")
+#elif defined(__GNUC__)
+#define EQ_UNROLL           _Pragma("GCC unroll 16")
+#else
+#define EQ_UNROLL
+#endif
+
+/*
+ *  EQ_PUBLISH()/EQ_ACQUIRE() hand a pointer from a writer thread to the
+ *  audio thread.  On the C6x an aligned word store is a single access and
+ *  the reader sees either the old or the new value; on the host the
+ *  compiler's atomics also order the pointed-to data before the pointer.
+ */
+#if defined(__GNUC__) && !defined(_TMS320C6X)
+#define EQ_PUBLISH(p, v)    __atomic_store_n(&(p), (v), __ATOMIC_RELEASE)
+#define EQ_ACQUIRE(p)       __atomic_load_n(&(p), __ATOMIC_ACQUIRE)
+#else
+#define EQ_PUBLISH(p, v)    ((p) = (v))
+#define EQ_ACQUIRE(p)       (p)
+#endif
+
+/*
+ *  EQ_FENCE() keeps memory accesses from moving across it, for data that
+ *  is guarded by a sequence number rather than handed over by pointer.
+ *  The C6x has one core and the guarded data is volatile, so the compiler
+ *  already keeps the order.
+ */
+#if defined(__GNUC__) && !defined(_TMS320C6X)
+#define EQ_FENCE()          __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define EQ_FENCE()
+#endif
+
+#endif /* EQ_TYPES_H */
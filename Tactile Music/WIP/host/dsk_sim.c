@@ -0,0 +1,352 @@
+/*
+ *  ======== dsk_sim.c ========
+ *
+ *  Workstation implementation of the DSP/BIOS, CSL and BSL subset declared
+ *  in dsk_sim.h.  See that header for what is (and is not) simulated.
+ */
+#include <string.h>
+#include <time.h>
+
+#include "dsk_sim.h"
+
+extern void processBuffer(void);
+
+DskSim gDskSim;
+
+SWI_Obj processBufferSwi = { processBuffer, 0, 0, 0, 0 };
+
+static SWI_Obj *gCurrentSwi;    // SWI whose function is executing
+
+
+/* ------------------------------- SWI ---------------------------------- */
+
+/*
+ *  SWI_or() - OR mask into the mailbox and post the SWI.
+ */
+void SWI_or(SWI_Obj *swi, Uint32 mask)
+{
+    swi->mailbox |= mask;
+    swi->posted = 1;
+}
+
+/*
+ *  SWI_getmbox() - Mailbox value of the running SWI, as it was when the
+ *                  SWI started.
+ */
+Uint32 SWI_getmbox(void)
+{
+    return gCurrentSwi ? gCurrentSwi->runMailbox : 0;
+}
+
+void SWI_disable(void)
+{
+}
+
+void SWI_enable(void)
+{
+}
+
+/*
+ *  simHwiReturn() - Run any SWI posted by the interrupt that just returned.
+ */
+void simHwiReturn(void)
+{
+    SWI_Obj *swi = &processBufferSwi;
+
+    if (!swi->posted)
+        return;
+
+    swi->posted = 0;
+    swi->runMailbox = swi->mailbox;
+    swi->mailbox = swi->initMailbox;
+
+    gCurrentSwi = swi;
+    swi->fxn();
+    gCurrentSwi = NULL;
+}
+
+
+/* ------------------------------- HWI ---------------------------------- */
+
+Uns HWI_disable(void)
+{
+    return 1;
+}
+
+void HWI_restore(Uns oldCSR)
+{
+    (void)oldCSR;
+}
+
+
+/* ------------------------------- CLK ---------------------------------- */
+
+/*
+ *  CLK_gethtime() - High-resolution time: the low 32 bits of the monotonic
+ *                   clock in nanoseconds (it wraps every 4.3 s, which the
+ *                   callers' differences tolerate).
+ */
+LgUns CLK_gethtime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (LgUns)((Uint32)ts.tv_sec * 1000000000u + (Uint32)ts.tv_nsec);
+}
+
+float CLK_countspms(void)
+{
+    return 1e6f;
+}
+
+
+/* ------------------------------- CSL ---------------------------------- */
+
+void CSL_init(void)
+{
+}
+
+
+/* ------------------------------ EDMA ---------------------------------- */
+
+#define SIM_EDMA_CHANNELS   16
+#define SIM_EDMA_PARAMS     85      // 16 channel entries + 69 reload entries
+
+struct EDMA_Param {
+    EDMA_Config        cfg;
+    struct EDMA_Param *link;
+    Uint32             enabled;
+    Uint32             allocated;
+};
+
+static struct EDMA_Param gParamRam[SIM_EDMA_PARAMS];
+static Uint32 gCipr;                // channel interrupt pending register
+static Uint32 gCier;                // channel interrupt enable register
+static Uint32 gTccAllocated;
+
+EDMA_Handle EDMA_open(int chaNum, Uint32 flags)
+{
+    EDMA_Handle h = &gParamRam[chaNum];
+
+    if (flags & EDMA_OPEN_RESET)
+        memset(h, 0, sizeof(*h));
+    h->allocated = 1;
+    return h;
+}
+
+EDMA_Handle EDMA_allocTable(int tableNum)
+{
+    int i;
+
+    if (tableNum >= 0)
+    {
+        gParamRam[SIM_EDMA_CHANNELS + tableNum].allocated = 1;
+        return &gParamRam[SIM_EDMA_CHANNELS + tableNum];
+    }
+    for (i = SIM_EDMA_CHANNELS; i < SIM_EDMA_PARAMS; i++)
+    {
+        if (!gParamRam[i].allocated)
+        {
+            gParamRam[i].allocated = 1;
+            return &gParamRam[i];
+        }
+    }
+    return NULL;
+}
+
+void EDMA_config(EDMA_Handle hEdma, EDMA_Config *config)
+{
+    hEdma->cfg = *config;
+}
+
+void EDMA_link(EDMA_Handle parent, EDMA_Handle child)
+{
+    parent->link = child;
+}
+
+int EDMA_intAlloc(int tcc)
+{
+    int i;
+
+    if (tcc >= 0)
+    {
+        gTccAllocated |= 1u << tcc;
+        return tcc;
+    }
+    for (i = 0; i < 16; i++)
+    {
+        if (!(gTccAllocated & (1u << i)))
+        {
+            gTccAllocated |= 1u << i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void EDMA_intClear(Uint32 tccIntNum)
+{
+    gCipr &= ~(1u << tccIntNum);
+}
+
+void EDMA_intEnable(Uint32 tccIntNum)
+{
+    gCier |= 1u << tccIntNum;
+}
+
+Uint32 EDMA_intTest(Uint32 tccIntNum)
+{
+    return (gCipr >> tccIntNum) & 1;
+}
+
+void EDMA_enableChannel(EDMA_Handle hEdma)
+{
+    hEdma->enabled = 1;
+}
+
+/*
+ *  simEdmaComplete() - End of a channel's transfer: flag its TCC in CIPR
+ *                      and reload the channel from its link entry.
+ */
+static void simEdmaComplete(struct EDMA_Param *cha)
+{
+    gCipr |= 1u << ((cha->cfg.opt >> 16) & 0xf);
+
+    if (cha->link)
+    {
+        struct EDMA_Param *next = cha->link;
+        cha->cfg = next->cfg;
+        cha->link = next->link;
+    }
+}
+
+Uint32 simEdmaFrame(SimRcvFxn rcv, SimXmtFxn xmt, void *arg)
+{
+    struct EDMA_Param *x = &gParamRam[EDMA_CHA_XEVT1];
+    struct EDMA_Param *r = &gParamRam[EDMA_CHA_REVT1];
+    Uint32 xcnt = x->enabled ? (x->cfg.cnt & 0xffff) : 0;
+    Uint32 rcnt = r->enabled ? (r->cfg.cnt & 0xffff) : 0;
+    Uint32 n = xcnt > rcnt ? xcnt : rcnt;
+    Uint32 xinc = (x->cfg.opt & EDMA_FMKS(OPT, SUM, INC)) != 0;
+    Uint32 e;
+
+    for (e = 0; e < n; e++)
+    {
+        if (e < xcnt)
+            xmt(arg, ((Int16 *)x->cfg.src)[e * xinc]);
+        if (e < rcnt)
+            ((Int16 *)r->cfg.dst)[e] = rcv(arg);
+    }
+
+    if (xcnt)
+        simEdmaComplete(x);
+    if (rcnt)
+        simEdmaComplete(r);
+    return n;
+}
+
+
+/* ------------------------------- IRQ ---------------------------------- */
+
+void IRQ_clear(Uint32 eventId)
+{
+    (void)eventId;
+}
+
+void IRQ_enable(Uint32 eventId)
+{
+    (void)eventId;
+}
+
+Uint32 IRQ_globalDisable(void)
+{
+    return 1;
+}
+
+void IRQ_globalEnable(void)
+{
+}
+
+
+/* ------------------------------ McBSP --------------------------------- */
+
+struct MCBSP_Obj {
+    MCBSP_Config cfg;
+    Uint32       drr;           // data receive register
+    Uint32       dxr;           // data transmit register
+};
+
+static struct MCBSP_Obj gMcbsp1;
+
+MCBSP_Handle MCBSP_open(int devNum, Uint32 flags)
+{
+    (void)devNum;
+    (void)flags;
+    return &gMcbsp1;
+}
+
+void MCBSP_config(MCBSP_Handle hMcbsp, MCBSP_Config *config)
+{
+    hMcbsp->cfg = *config;
+}
+
+void MCBSP_start(MCBSP_Handle hMcbsp, Uint32 startMask, Uint32 delay)
+{
+    (void)hMcbsp;
+    (void)startMask;
+    (void)delay;
+}
+
+EDMA_Addr MCBSP_getXmtAddr(MCBSP_Handle hMcbsp)
+{
+    return (EDMA_Addr)&hMcbsp->dxr;
+}
+
+EDMA_Addr MCBSP_getRcvAddr(MCBSP_Handle hMcbsp)
+{
+    return (EDMA_Addr)&hMcbsp->drr;
+}
+
+void MCBSP_write(MCBSP_Handle hMcbsp, Uint32 val)
+{
+    hMcbsp->dxr = val;
+}
+
+
+/* ------------------------------- BSL ---------------------------------- */
+
+void DSK6713_init(void)
+{
+}
+
+void DSK6713_LED_init(void)
+{
+    gDskSim.ledState = 0;
+}
+
+void DSK6713_LED_on(Uint32 ledNum)
+{
+    if (!(gDskSim.ledState & (1u << ledNum)))
+        gDskSim.ledOnCount[ledNum & 3]++;
+    gDskSim.ledState |= 1u << ledNum;
+}
+
+void DSK6713_LED_off(Uint32 ledNum)
+{
+    gDskSim.ledState &= ~(1u << ledNum);
+}
+
+void DSK6713_DIP_init(void)
+{
+}
+
+/* The switches read 0 when depressed, as on the board. */
+Uint32 DSK6713_DIP_get(Uint32 dipNum)
+{
+    return !((gDskSim.dipSwitches >> dipNum) & 1);
+}
+
+void AIC23_setParams(AIC23_Params *params)
+{
+    gDskSim.codec = *params;
+}
@@ -0,0 +1,224 @@
+/*
+ *  ======== dsk_sim.h ========
+ *
+ *  Workstation stand-in for the DSP/BIOS, CSL and DSK6713 BSL interfaces
+ *  used by Gupta_Nair.c.  Only the calls the equalizer actually makes are
+ *  provided, and only with the behaviour the application relies on:
+ *
+ *  - SWI_or()/SWI_getmbox() keep a mailbox per SWI object exactly like
+ *    DSP/BIOS; a posted SWI runs when the simulated EDMA interrupt returns.
+ *  - Nothing preempts anything else, so HWI_disable()/HWI_restore() and
+ *    SWI_disable()/SWI_enable() only mark the critical sections.
+ *  - EDMA_config()/EDMA_link() build a parameter RAM image.  When a
+ *    simulated transfer completes, the channel reloads from its link entry,
+ *    so the Ping/Pong ordering is whatever initEdma() set up, and an entry
+ *    configured again before it is reached takes effect.
+ *  - CLK_gethtime() counts nanoseconds of CLOCK_MONOTONIC, so frame timing
+ *    measures the host's own processing time.
+ *  - DSK6713_DIP_get() reports the switch pattern requested on the command
+ *    line, and the LED calls are recorded for the run summary.
+ *
+ *  The frame loop that drives all of this lives in sim_main.c.
+ */
+#ifndef DSK_SIM_H
+#define DSK_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* ------------------------------ std.h --------------------------------- */
+
+typedef short           Int16;
+typedef unsigned short  Uint16;
+typedef int             Int;
+typedef int             Int32;
+typedef unsigned int    Uint32;
+typedef unsigned int    Uns;
+typedef unsigned char   Uint8;
+typedef int             Bool;
+
+#ifndef TRUE
+#define TRUE  1
+#define FALSE 0
+#endif
+
+/* The DSK application declares "void main()"; keep it out of the way of the
+ * harness entry point. */
+#ifndef DSK_SIM_HARNESS
+#define main dskAppMain
+#endif
+void dskAppMain();
+
+/* ------------------------------ swi.h --------------------------------- */
+
+typedef struct SWI_Obj {
+    void   (*fxn)(void);    // SWI function
+    Uint32 mailbox;         // current mailbox value
+    Uint32 initMailbox;     // value restored when the SWI starts running
+    Uint32 posted;          // set by SWI_or(), cleared when the SWI runs
+    Uint32 runMailbox;      // mailbox snapshot returned by SWI_getmbox()
+} SWI_Obj;
+
+extern SWI_Obj processBufferSwi;
+
+void   SWI_or(SWI_Obj *swi, Uint32 mask);
+Uint32 SWI_getmbox(void);
+void   SWI_disable(void);
+void   SWI_enable(void);
+
+/* ------------------------------ hwi.h --------------------------------- */
+
+Uns  HWI_disable(void);
+void HWI_restore(Uns oldCSR);
+
+/* ------------------------------ clk.h --------------------------------- */
+
+typedef unsigned int    LgUns;
+
+LgUns CLK_gethtime(void);
+float CLK_countspms(void);
+
+/* ------------------------------ csl.h --------------------------------- */
+
+void CSL_init(void);
+
+/* --------------------------- csl_edma.h ------------------------------- */
+
+typedef uintptr_t EDMA_Addr;
+
+typedef struct EDMA_Config {
+    Uint32    opt;
+    EDMA_Addr src;
+    Uint32    cnt;
+    EDMA_Addr dst;
+    Uint32    idx;
+    Uint32    rld;
+} EDMA_Config;
+
+typedef struct EDMA_Param *EDMA_Handle;
+
+#define EDMA_CHA_XEVT1      14
+#define EDMA_CHA_REVT1      15
+#define EDMA_OPEN_RESET     1
+
+/* Symbolic field values are irrelevant to the simulation except the
+ * source update mode (SUM NONE reads one word over and over); it and the
+ * numeric fields it needs (TCC and ELECNT) are encoded at their real
+ * positions. */
+#define EDMA_FMKS(REG, FIELD, SYM)      EDMA_FMKS_##REG##_##FIELD(SYM)
+#define EDMA_FMKS_OPT_SUM(SYM)          EDMA_FMKS_OPT_SUM_##SYM
+#define EDMA_FMKS_OPT_SUM_NONE          0u
+#define EDMA_FMKS_OPT_SUM_INC           (1u << 24)
+#define EDMA_FMKS_OPT_PRI(SYM)          0
+#define EDMA_FMKS_OPT_ESIZE(SYM)        0
+#define EDMA_FMKS_OPT_2DS(SYM)          0
+#define EDMA_FMKS_OPT_2DD(SYM)          0
+#define EDMA_FMKS_OPT_DUM(SYM)          0
+#define EDMA_FMKS_OPT_TCINT(SYM)        0
+#define EDMA_FMKS_OPT_TCC(SYM)          0
+#define EDMA_FMKS_OPT_LINK(SYM)         0
+#define EDMA_FMKS_OPT_FS(SYM)           0
+#define EDMA_FMKS_SRC_SRC(SYM)          0
+#define EDMA_FMKS_DST_DST(SYM)          0
+#define EDMA_FMKS_IDX_FRMIDX(SYM)       0
+#define EDMA_FMKS_IDX_ELEIDX(SYM)       0
+#define EDMA_FMK(REG, FIELD, x)         EDMA_FMK_##REG##_##FIELD(x)
+#define EDMA_FMK_OPT_TCC(x)             (((Uint32)(x) & 0xf) << 16)
+#define EDMA_FMK_CNT_FRMCNT(x)          0
+#define EDMA_FMK_CNT_ELECNT(x)          ((Uint32)(x) & 0xffff)
+#define EDMA_FMK_RLD_ELERLD(x)          0
+#define EDMA_FMK_RLD_LINK(x)            0
+#define EDMA_SRC_OF(x)                  ((EDMA_Addr)(x))
+#define EDMA_DST_OF(x)                  ((EDMA_Addr)(x))
+
+EDMA_Handle EDMA_open(int chaNum, Uint32 flags);
+EDMA_Handle EDMA_allocTable(int tableNum);
+void        EDMA_config(EDMA_Handle hEdma, EDMA_Config *config);
+void        EDMA_link(EDMA_Handle parent, EDMA_Handle child);
+int         EDMA_intAlloc(int tcc);
+void        EDMA_intClear(Uint32 tccIntNum);
+void        EDMA_intEnable(Uint32 tccIntNum);
+Uint32      EDMA_intTest(Uint32 tccIntNum);
+void        EDMA_enableChannel(EDMA_Handle hEdma);
+
+/* --------------------------- csl_irq.h -------------------------------- */
+
+#define IRQ_EVT_EDMAINT     8
+
+void   IRQ_clear(Uint32 eventId);
+void   IRQ_enable(Uint32 eventId);
+Uint32 IRQ_globalDisable(void);
+void   IRQ_globalEnable(void);
+
+/* -------------------------- csl_mcbsp.h ------------------------------- */
+
+typedef struct MCBSP_Config {
+    Uint32 spcr, rcr, xcr, srgr, mcr, rcer, xcer, pcr;
+} MCBSP_Config;
+
+typedef struct MCBSP_Obj *MCBSP_Handle;
+
+#define MCBSP_DEV1              1
+#define MCBSP_OPEN_RESET        1
+#define MCBSP_XMIT_START        0x01
+#define MCBSP_RCV_START         0x02
+#define MCBSP_SRGR_START        0x04
+#define MCBSP_SRGR_FRAMESYNC    0x08
+#define MCBSP_FMKS(REG, FIELD, SYM)     0
+#define MCBSP_MCR_DEFAULT       0
+#define MCBSP_RCER_DEFAULT      0
+#define MCBSP_XCER_DEFAULT      0
+
+MCBSP_Handle MCBSP_open(int devNum, Uint32 flags);
+void         MCBSP_config(MCBSP_Handle hMcbsp, MCBSP_Config *config);
+void         MCBSP_start(MCBSP_Handle hMcbsp, Uint32 startMask, Uint32 delay);
+EDMA_Addr    MCBSP_getXmtAddr(MCBSP_Handle hMcbsp);
+EDMA_Addr    MCBSP_getRcvAddr(MCBSP_Handle hMcbsp);
+void         MCBSP_write(MCBSP_Handle hMcbsp, Uint32 val);
+
+/* ---------------------- dsk6713.h, _led.h, _dip.h --------------------- */
+
+void   DSK6713_init(void);
+void   DSK6713_LED_init(void);
+void   DSK6713_LED_on(Uint32 ledNum);
+void   DSK6713_LED_off(Uint32 ledNum);
+void   DSK6713_DIP_init(void);
+Uint32 DSK6713_DIP_get(Uint32 dipNum);
+
+/* ------------------------------ aic23.h ------------------------------- */
+
+typedef struct AIC23_Params {
+    int regs[10];
+} AIC23_Params;
+
+void AIC23_setParams(AIC23_Params *params);
+
+/* ------------------------ simulation controls ------------------------- */
+
+/*
+ *  Simulated board state shared between dsk_sim.c and the harness.
+ */
+typedef struct DskSim {
+    Uint32       dipSwitches;   // bit n set => DIP switch n depressed
+    Uint32       ledState;      // bit n set => LED n lit
+    Uint32       ledOnCount[4]; // number of LED off->on transitions
+    AIC23_Params codec;         // last parameters sent to the codec
+} DskSim;
+
+extern DskSim gDskSim;
+
+/*
+ *  The EDMA transfer hooks.  simEdmaFrame() completes one full frame on
+ *  every enabled channel: for each element, the transmit channel reads its
+ *  source before the receive channel writes its destination (the McBSP
+ *  transmit is primed one word ahead by the dummy write in initEdma()).
+ *  Returns the number of elements moved per channel, 0 if none are enabled.
+ */
+typedef Int16 (*SimRcvFxn)(void *arg);
+typedef void  (*SimXmtFxn)(void *arg, Int16 sample);
+
+Uint32 simEdmaFrame(SimRcvFxn rcv, SimXmtFxn xmt, void *arg);
+void   simHwiReturn(void);
+
+#endif /* DSK_SIM_H */
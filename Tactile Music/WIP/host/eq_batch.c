@@ -0,0 +1,607 @@
+/*
+ *  ======== eq_batch.c ========
+ *
+ *  Batch tactile renderer: turns a library of WAV files into one tactile
+ *  track each (the motor packets of eq_tactile.h in the TTRK format of
+ *  eq_track.h), on every core.
+ *
+ *  Usage: eq_batch [-j threads] [-g seconds] [-w seconds] [-o dir] [-c]
+ *                  [-S] in.wav...
+ *
+ *  Each file is mapped (wavMap()) and cut into segments of -g seconds
+ *  (default 30) of BATCH_FRAME-word frames, fed to the codec words the
+ *  way the simulation feeds them (mono on both channels, silence to fill
+ *  the last frame).  The segments of all the files go into a
+ *  work-stealing pool of -j threads (default: one per core).  Each
+ *  worker runs the LED meter filters (eqFirLoad()) over its segments
+ *  into the file's per-frame band powers.  A segment starts from the
+ *  FIR history that a serial run would have at its first frame, loaded
+ *  from the frame before it, so the powers are the same to the bit.
+ *  The adaptive thresholds carry state from one interval to the next,
+ *  so the worker that finishes a file's last segment runs the tactile
+ *  encoder over all of its frames (a few flops per frame) and writes
+ *  <dir>/<name>.ttrk.
+ *
+ *  Files at other rates than 8 kHz are converted as they are read
+ *  (eq_resample.h): each segment seeks the converter to its first frame
+ *  and pushes the input from there, so segments stay independent and
+ *  bit-exact against a serial run.
+ *
+ *  -c checks each file against a serial run on one FIR and fails on any
+ *  difference.  -S runs the whole batch at 1, 2, 4, ... threads up to -j
+ *  and prints the throughput in audio seconds per wall second at each.
+ *  -w is the warm-up of the adaptive thresholds (gAdaptWarmup).
+ */
+#define DSK_SIM_HARNESS
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dsk_sim.h"
+#include "eq_resample.h"
+#include "eq_track.h"
+#include "wav_io.h"
+
+extern const float lp1[], bp1[], hp1[];
+
+#define BATCH_FRAME     1024            // words, as BUFFSIZE
+#define BATCH_RATE      8000            // the meters' design rate
+#define BATCH_INTERVAL  0.1f            // seconds per packet, as the sim
+#define BATCH_SEGMENT   30.0            // default seconds per segment
+#define BATCH_MAX_JOBS  256
+
+typedef struct BatchFile {
+    const char *path;
+    char       *out;
+    WavMap     wav;
+    EqResamplePlan *plan;       // to BATCH_RATE, or NULL if already there
+    Uint32     samples;         // at BATCH_RATE, per channel
+    Uint32     frames;          // BATCH_FRAME-word frames, the last padded
+    float      (*power)[EQ_METERS];
+    Uint32     segmentsLeft;    // atomic
+    Uint8      *packet;         // the tactile track
+    Uint32     packets;
+    int        failed;
+} BatchFile;
+
+/* Where batchEncode() puts the packets */
+typedef struct BatchTrack {
+    Uint8  *packet;
+    Uint32 packets;
+} BatchTrack;
+
+/* A segment of a file, or its encoding once count is 0 */
+typedef struct BatchTask {
+    BatchFile *file;
+    Uint32    first;
+    Uint32    count;
+} BatchTask;
+
+/* One worker's deque: the owner pops at the tail, thieves take the head */
+typedef struct BatchQueue {
+    pthread_mutex_t lock;
+    BatchTask       *task;
+    Uint32          head;
+    Uint32          tail;
+} BatchQueue;
+
+typedef struct BatchPool {
+    BatchQueue *queue;
+    int        workers;
+    Uint32     outstanding;     // atomic: tasks not yet finished
+} BatchPool;
+
+typedef struct BatchWorker {
+    BatchPool *pool;
+    int       id;
+    pthread_t thread;
+} BatchWorker;
+
+static const float *gMeter[EQ_METERS];
+static Uint32 gMeterSymmetric;
+static float gWarmup = EQ_ADAPT_WARMUP;
+
+static double batchNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ *  batchWords() - Codec words first .. first + n - 1 of a file: right on
+ *                 even words, left on odd ones, mono on both, 0 past the
+ *                 end.  first and n are even.  Files at other rates go
+ *                 through rs, seeked to the first word.
+ */
+static void batchWords(const BatchFile *file, EqResampler *rs, Uint32 first,
+                       Int16 *y, Uint32 n)
+{
+    const WavMap *wav = &file->wav;
+    Int16 in[EQ_RESAMPLE_CHUNK * EQ_CHANNELS];
+    Int16 out[EQ_RESAMPLE_CHUNK * EQ_CHANNELS];
+    Uint32 i, t, c, got = 0, made, src, chunk;
+
+    if (file->plan == NULL)
+    {
+        for (i = 0; i < n; i++)
+        {
+            Uint32 w = first + i;
+
+            t = w / EQ_CHANNELS;
+            c = wav->channels == 1 ? 0 : w % EQ_CHANNELS;
+            y[i] = t < wav->frames ?
+                   wavMapSample(wav, t * wav->channels + c) : 0;
+        }
+        return;
+    }
+
+    /* few enough inputs at a time that their outputs fit in out[] */
+    chunk = (Uint32)((EQ_RESAMPLE_CHUNK - 1) * (double)file->plan->down /
+                     file->plan->up);
+    if (chunk > EQ_RESAMPLE_CHUNK)
+        chunk = EQ_RESAMPLE_CHUNK;
+    eqResampleInit(rs, file->plan, wav->channels);
+    src = eqResampleSeek(rs, first / EQ_CHANNELS + file->plan->delay);
+    while (got < n / EQ_CHANNELS)
+    {
+        for (i = 0; i < chunk * wav->channels; i++)
+        {
+            t = src + i / wav->channels;
+            in[i] = t < wav->frames ? wavMapSample(wav, t * wav->channels +
+                                                   i % wav->channels) : 0;
+        }
+        src += chunk;
+        made = eqResamplePush(rs, in, chunk, out);
+        for (i = 0; i < made && got < n / EQ_CHANNELS; i++, got++)
+        {
+            t = first / EQ_CHANNELS + got;
+            for (c = 0; c < EQ_CHANNELS; c++)
+                y[EQ_CHANNELS * got + c] = t >= file->samples ? 0 :
+                    out[i * wav->channels + (wav->channels == 1 ? 0 : c)];
+        }
+    }
+}
+
+/*
+ *  batchMeter() - Band powers of count frames from first into power.  The
+ *                 FIR history is rebuilt from the frame before first.
+ */
+static void batchMeter(const BatchFile *file, EqFir *fir, EqResampler *rs,
+                       Uint32 first, Uint32 count, float (*power)[EQ_METERS])
+{
+    Uint32 from = first > 0 ? first - 1 : 0, f;
+    Int16 *words = malloc((first + count - from) * BATCH_FRAME *
+                          sizeof(Int16));
+    const Int16 *frame = words;
+
+    if (words == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    batchWords(file, rs, from * BATCH_FRAME, words,
+               (first + count - from) * BATCH_FRAME);
+
+    eqFirInit(fir);
+    if (first > 0)
+    {
+        eqFirLoad(fir, frame, BATCH_FRAME, NULL, 0, NULL);
+        eqFirCommit(fir, BATCH_FRAME);
+        frame += BATCH_FRAME;
+    }
+    for (f = first; f < first + count; f++, frame += BATCH_FRAME)
+    {
+        eqFirLoad(fir, frame, BATCH_FRAME, gMeter, gMeterSymmetric, power[f]);
+        eqFirCommit(fir, BATCH_FRAME);
+    }
+    free(words);
+}
+
+static void batchPacket(void *arg, const Uint8 *packet)
+{
+    BatchTrack *track = arg;
+
+    memcpy(track->packet + EQ_TACTILE_PACKET * track->packets++, packet,
+           EQ_TACTILE_PACKET);
+}
+
+/*
+ *  batchEncode() - The tactile track of a file's frame powers, into
+ *                  packet (room for every interval of the file).
+ */
+static Uint32 batchEncode(BatchFile *file, float (*power)[EQ_METERS],
+                          Uint8 *packet, EqTrackInfo *info)
+{
+    EqTactile enc;
+    EqMeters meters;
+    BatchTrack track = { packet, 0 };
+    Uint32 f, k;
+
+    eqTactileInit(&enc, BATCH_RATE, BATCH_INTERVAL, gWarmup,
+                  batchPacket, &track);
+    memset(&meters, 0, sizeof(meters));
+    for (f = 0; f < file->frames; f++)
+    {
+        for (k = 0; k < EQ_METERS; k++)
+            meters.power[k] = power[f][k];
+        eqTactilePush(&enc, &meters, BATCH_FRAME);
+    }
+    if (info)
+        eqTrackInfoTactile(info, &enc);
+    return track.packets;
+}
+
+static int batchWrite(BatchFile *file, const EqTrackInfo *info)
+{
+    FILE *fp = fopen(file->out, "wb");
+    EqTrackWriter w;
+    Uint32 i;
+    int rc;
+
+    if (fp == NULL)
+    {
+        perror(file->out);
+        return -1;
+    }
+    eqTrackWriterOpen(&w, fp, info);
+    for (i = 0; i < file->packets; i++)
+        eqTrackWrite(&w, file->packet + EQ_TACTILE_PACKET * i);
+    rc = eqTrackWriterClose(&w);
+    if (fclose(fp) != 0 || rc != 0)
+    {
+        perror(file->out);
+        return -1;
+    }
+    return 0;
+}
+
+static void batchPush(BatchQueue *q, const BatchTask *t)
+{
+    pthread_mutex_lock(&q->lock);
+    q->task[q->tail++] = *t;
+    pthread_mutex_unlock(&q->lock);
+}
+
+static int batchPop(BatchQueue *q, BatchTask *t)
+{
+    int got = 0;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head)
+    {
+        *t = q->task[--q->tail];
+        got = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return got;
+}
+
+static int batchSteal(BatchQueue *q, BatchTask *t)
+{
+    int got = 0;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head)
+    {
+        *t = q->task[q->head++];
+        got = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return got;
+}
+
+static void batchRun(BatchWorker *w, EqFir *fir, EqResampler *rs,
+                     const BatchTask *t)
+{
+    BatchFile *file = t->file;
+    EqTrackInfo info;
+
+    if (t->count)
+    {
+        BatchTask encode = { file, 0, 0 };
+
+        batchMeter(file, fir, rs, t->first, t->count, file->power);
+        /* the last segment to finish queues the encoding */
+        if (__atomic_sub_fetch(&file->segmentsLeft, 1, __ATOMIC_ACQ_REL) == 0)
+            batchPush(&w->pool->queue[w->id], &encode);
+        return;
+    }
+
+    file->packets = batchEncode(file, file->power, file->packet, &info);
+    if (batchWrite(file, &info) != 0)
+        file->failed = 1;
+}
+
+static void *batchWorker(void *arg)
+{
+    BatchWorker *w = arg;
+    BatchPool *pool = w->pool;
+    EqFir *fir;
+    EqResampler *rs;
+    BatchTask t;
+    int i;
+
+    if (posix_memalign((void **)&fir, 32, sizeof(*fir)) != 0 ||
+        posix_memalign((void **)&rs, 32, sizeof(*rs)) != 0)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    while (__atomic_load_n(&pool->outstanding, __ATOMIC_ACQUIRE) > 0)
+    {
+        int got = batchPop(&pool->queue[w->id], &t);
+
+        for (i = 1; !got && i < pool->workers; i++)
+            got = batchSteal(&pool->queue[(w->id + i) % pool->workers], &t);
+        if (!got)
+        {
+            sched_yield();
+            continue;
+        }
+        batchRun(w, fir, rs, &t);
+        __atomic_sub_fetch(&pool->outstanding, 1, __ATOMIC_ACQ_REL);
+    }
+    free(rs);
+    free(fir);
+    return NULL;
+}
+
+/*
+ *  batchPool() - Meter and encode every file on workers threads.
+ */
+static void batchPool(BatchFile *files, int nfiles, Uint32 segFrames,
+                      int workers)
+{
+    BatchWorker worker[BATCH_MAX_JOBS];
+    BatchQueue queue[BATCH_MAX_JOBS];
+    BatchPool pool;
+    Uint32 ntasks = 0, f;
+    int i, next = 0;
+
+    for (i = 0; i < nfiles; i++)
+        ntasks += (files[i].frames + segFrames - 1) / segFrames + 1;
+
+    pool.queue = queue;
+    pool.workers = workers;
+    pool.outstanding = ntasks;
+    for (i = 0; i < workers; i++)
+    {
+        pthread_mutex_init(&queue[i].lock, NULL);
+        queue[i].task = malloc(ntasks * sizeof(BatchTask));
+        queue[i].head = queue[i].tail = 0;
+        if (queue[i].task == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+
+    /* deal the segments out round-robin */
+    for (i = 0; i < nfiles; i++)
+    {
+        files[i].segmentsLeft = (files[i].frames + segFrames - 1) / segFrames;
+        files[i].packets = 0;
+        for (f = 0; f < files[i].frames; f += segFrames)
+        {
+            BatchTask t = { &files[i], f, segFrames };
+
+            if (t.count > files[i].frames - f)
+                t.count = files[i].frames - f;
+            batchPush(&queue[next], &t);
+            next = (next + 1) % workers;
+        }
+    }
+
+    for (i = 0; i < workers; i++)
+    {
+        worker[i].pool = &pool;
+        worker[i].id = i;
+        pthread_create(&worker[i].thread, NULL, batchWorker, &worker[i]);
+    }
+    for (i = 0; i < workers; i++)
+        pthread_join(worker[i].thread, NULL);
+    for (i = 0; i < workers; i++)
+    {
+        pthread_mutex_destroy(&queue[i].lock);
+        free(queue[i].task);
+    }
+}
+
+/*
+ *  batchCheck() - Compare a file's powers and track with a serial run.
+ */
+static int batchCheck(BatchFile *file)
+{
+    float (*power)[EQ_METERS] = malloc(file->frames * sizeof(*power));
+    Uint8 *packet = malloc(file->packets * EQ_TACTILE_PACKET + 1);
+    EqFir *fir;
+    EqResampler *rs;
+    Uint32 packets;
+    int same;
+
+    if (power == NULL || packet == NULL ||
+        posix_memalign((void **)&fir, 32, sizeof(*fir)) != 0 ||
+        posix_memalign((void **)&rs, 32, sizeof(*rs)) != 0)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    batchMeter(file, fir, rs, 0, file->frames, power);
+    packets = batchEncode(file, power, packet, NULL);
+    same = packets == file->packets &&
+           !memcmp(power, file->power, file->frames * sizeof(*power)) &&
+           !memcmp(packet, file->packet, packets * EQ_TACTILE_PACKET);
+    if (!same)
+        fprintf(stderr, "%s: differs from the serial run\n", file->path);
+    free(rs);
+    free(fir);
+    free(packet);
+    free(power);
+    return same ? 0 : -1;
+}
+
+/*
+ *  batchOpen() - Map a file and size its buffers.
+ */
+static int batchOpen(BatchFile *file, const char *path, const char *outDir)
+{
+    const char *base = strrchr(path, '/');
+    Uint32 words, intervals;
+    size_t len;
+
+    memset(file, 0, sizeof(*file));
+    file->path = path;
+    if (wavMap(path, &file->wav) != 0)
+        return -1;
+    if (file->wav.channels > 2 || file->wav.frames == 0)
+    {
+        fprintf(stderr, "%s: needs mono or stereo audio\n", path);
+        wavUnmap(&file->wav);
+        return -1;
+    }
+    file->samples = file->wav.frames;
+    if (file->wav.sampleRate != BATCH_RATE)
+    {
+        file->plan = malloc(sizeof(*file->plan));
+        if (file->plan == NULL ||
+            eqResamplePlan(file->plan, file->wav.sampleRate, BATCH_RATE) != 0)
+        {
+            fprintf(stderr, "%s: cannot convert %u Hz to %d Hz\n", path,
+                    file->wav.sampleRate, BATCH_RATE);
+            free(file->plan);
+            wavUnmap(&file->wav);
+            return -1;
+        }
+        file->samples = (Uint32)(((double)file->wav.frames * file->plan->up +
+                                  file->plan->down - 1) / file->plan->down);
+    }
+
+    words = file->samples * EQ_CHANNELS;
+    file->frames = (words + BATCH_FRAME - 1) / BATCH_FRAME;
+    intervals = (Uint32)(file->frames * (BATCH_FRAME / EQ_CHANNELS) /
+                         (BATCH_RATE * BATCH_INTERVAL)) + 1;
+    file->power = malloc((file->frames + 1) * sizeof(*file->power));
+    file->packet = malloc(intervals * EQ_TACTILE_PACKET);
+
+    base = base ? base + 1 : path;
+    len = strlen(base);
+    if (len > 4 && !strcmp(base + len - 4, ".wav"))
+        len -= 4;
+    file->out = malloc(strlen(outDir) + len + 7);
+    if (file->power == NULL || file->packet == NULL || file->out == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    sprintf(file->out, "%s/%.*s.ttrk", outDir, (int)len, base);
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: eq_batch [-j threads] [-g seconds] [-w seconds] [-o dir] [-c]\n"
+        "                [-S] in.wav...\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *outDir = ".";
+    double segSeconds = BATCH_SEGMENT, audio = 0.0, t0, wall, serial = 0.0;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN), check = 0, scale = 0;
+    int nfiles, argi, i, j, rc = 0;
+    BatchFile *files;
+    Uint32 segFrames;
+
+    for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++)
+    {
+        if (!strcmp(argv[argi], "-j") && argi + 1 < argc)
+            jobs = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-g") && argi + 1 < argc)
+            segSeconds = atof(argv[++argi]);
+        else if (!strcmp(argv[argi], "-w") && argi + 1 < argc)
+            gWarmup = (float)atof(argv[++argi]);
+        else if (!strcmp(argv[argi], "-o") && argi + 1 < argc)
+            outDir = argv[++argi];
+        else if (!strcmp(argv[argi], "-c"))
+            check = 1;
+        else if (!strcmp(argv[argi], "-S"))
+            scale = 1;
+        else
+            usage();
+    }
+    if (argi == argc || segSeconds <= 0.0)
+        usage();
+    if (jobs < 1)
+        jobs = 1;
+    if (jobs > BATCH_MAX_JOBS)
+        jobs = BATCH_MAX_JOBS;
+
+    gMeter[0] = lp1;
+    gMeter[1] = bp1;
+    gMeter[2] = hp1;
+    gMeterSymmetric = eqFirIsSymmetric(lp1, EQ_LED_TAPS) &&
+                      eqFirIsSymmetric(bp1, EQ_LED_TAPS) &&
+                      eqFirIsSymmetric(hp1, EQ_LED_TAPS);
+    segFrames = (Uint32)(segSeconds * BATCH_RATE / (BATCH_FRAME / EQ_CHANNELS));
+    if (segFrames == 0)
+        segFrames = 1;
+
+    files = malloc((argc - argi) * sizeof(*files));
+    if (files == NULL)
+        return 1;
+    for (nfiles = 0; argi < argc; argi++)
+        if (batchOpen(&files[nfiles], argv[argi], outDir) == 0)
+            audio += (double)files[nfiles++].samples / BATCH_RATE;
+        else
+            rc = 1;
+    if (nfiles == 0)
+        return 1;
+
+    if (scale)
+        printf("%7s %9s %11s %8s %7s\n", "threads", "wall_s", "audio_s/s",
+               "speedup", "effic");
+    for (j = scale ? 1 : jobs; ; j = j * 2 < jobs ? j * 2 : jobs)
+    {
+        t0 = batchNow();
+        batchPool(files, nfiles, segFrames, j);
+        wall = batchNow() - t0;
+        if (j == 1)
+            serial = wall;
+        if (scale)
+            printf("%7d %9.3f %11.1f %8.2f %6.0f%%\n", j, wall, audio / wall,
+                   serial / wall, 100.0 * serial / wall / j);
+        else
+            printf("%d files, %.1f s of audio in %.3f s on %d threads: "
+                   "%.1f audio s/s\n", nfiles, audio, wall, j, audio / wall);
+        if (j == jobs)
+            break;
+    }
+
+    for (i = 0; i < nfiles; i++)
+    {
+        if (files[i].failed)
+            rc = 1;
+        if (check && batchCheck(&files[i]) != 0)
+            rc = 1;
+    }
+    if (check && rc == 0)
+        printf("all tracks match a serial run\n");
+
+    for (i = 0; i < nfiles; i++)
+    {
+        wavUnmap(&files[i].wav);
+        free(files[i].plan);
+        free(files[i].power);
+        free(files[i].packet);
+        free(files[i].out);
+    }
+    free(files);
+    return rc;
+}
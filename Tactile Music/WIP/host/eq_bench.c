@@ -0,0 +1,1442 @@
+/*
+ *  ======== eq_bench.c ========
+ *
+ *  Host checks and measurements for the equalizer engine.
+ *
+ *  Usage: eq_bench verify
+ *         eq_bench crossover
+ *         eq_bench fixed in.wav...
+ *         eq_bench nband [bands.txt]
+ *         eq_bench design bands [taps [lowHz]]
+ *         eq_bench iir
+ *         eq_bench sdft
+ *         eq_bench resample
+ *         eq_bench onset
+ *         eq_bench suite [-o out.json] [-b base.json] [-t percent] [in.wav...]
+ *
+ *  verify     Checks the real FFT against a direct DFT, the overlap-save
+ *             convolution against direct form for a range of tap counts,
+ *             and the FFT engine mode against the direct one for every
+ *             DIP setting (output within 1 LSB), and writes a tactile
+ *             track whose duties rise and fall and reads it back packet
+ *             for packet.  Exits non-zero on a mismatch.
+ *  crossover  Times direct form against overlap-save for one channel of
+ *             a BUFFSIZE frame at increasing tap counts, and reports the
+ *             tap count from which the FFT is faster.
+ *  fixed      Runs every channel of each WAV file through each filtering
+ *             DIP setting with the float kernel and with the Q15 one, and
+ *             reports the fixed-point SNR and largest error against the
+ *             unrounded float output, then times both kernels.
+ *  nband      Frame time of the engine with an N-band entry against the
+ *             band count (designed banks of 8..32 bands, or the one file
+ *             given), and the band count the frame deadline allows.
+ *  design     Prints a windowed-sinc N-band bank in the eq_nband.h file
+ *             format.
+ *  iir        Compares the FIR and biquad (EQ_PATH_IIR) paths: time and
+ *             cycles per sample of the output and of the meters, and the
+ *             delay of the filters in each DIP setting, measured from the
+ *             impulse response, on top of the Ping/Pong pipeline.
+ *  sdft       Times the sliding DFT band energies (eq_sdft.h) per sample
+ *             across hop and window lengths, which should not change the
+ *             cost, and checks the band powers it reports for tones in
+ *             each band.
+ *  resample   For 11.025 to 96 kHz input: the converter's taps, its time
+ *             per second of audio against the 8 kHz engine's, and the
+ *             error of in-band tones and the level of an alias against
+ *             the ideal 8 kHz signal.
+ *  onset      Times the onset detector (eq_onset.h) per frame across
+ *             frame sizes, which should not change the cost, and scores
+ *             it on band powers with attacks at known frames over levels
+ *             that wander by a few dB.
+ *  suite      The regression suite: ns per stereo sample, frames per
+ *             second and headroom against the frame period of the engine
+ *             at each DIP value (mute, filters, bypass; meters included),
+ *             of the three LED meter loops alone, and from each WAV file
+ *             (default ../test.wav) to motor packets, as e2e/<file>.  -o writes the
+ *             results as JSON; -b compares them with an earlier -o file
+ *             and exits non-zero if a case got more than -t percent
+ *             (default 10) slower.
+ */
+#define DSK_SIM_HARNESS
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "dsk_sim.h"
+#include "eq_engine.h"
+#include "eq_onset.h"
+#include "eq_resample.h"
+#include "eq_sdft.h"
+#include "eq_tactile.h"
+#include "eq_track.h"
+#include "wav_io.h"
+
+extern const float lp[], bp[], hp[], lp1[], bp1[], hp1[];
+
+#define BENCH_FRAME     1024                    // words, as BUFFSIZE
+#define BENCH_BLOCK     (BENCH_FRAME / EQ_CHANNELS)
+#define BENCH_RATE      8000
+#define BENCH_MAX_TAPS  1023
+
+static void usage(void);
+
+static Uint32 gSeed = 12345;
+
+/* Reproducible uniform noise in [-1, 1) */
+static float benchNoise(void)
+{
+    gSeed = gSeed * 1664525u + 1013904223u;
+    return (float)((Int32)gSeed) / 2147483648.0f;
+}
+
+static double benchNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ *  benchTicks() - The time stamp counter, which counts cycles at the
+ *                 core's nominal clock; 0 where there is none.
+ */
+static double benchTicks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (double)__rdtsc();
+#else
+    return 0.0;
+#endif
+}
+
+/* ------------------------------ verify -------------------------------- */
+
+/*
+ *  verifyFft() - Forward transform against a double precision DFT, and
+ *                the round trip, for every supported size.
+ */
+static int verifyFft(void)
+{
+    static EqFftPlan plan;
+    static float buf[EQ_FFT_MAX], x[EQ_FFT_MAX];
+    const double pi = 3.14159265358979323846;
+    Uint32 n, i, k;
+    int fail = 0;
+
+    for (n = 8; n <= EQ_FFT_MAX; n <<= 1)
+    {
+        double maxErr = 0.0, maxTrip = 0.0;
+
+        eqFftInit(&plan, n);
+        for (i = 0; i < n; i++)
+            x[i] = buf[i] = benchNoise();
+        eqFftForward(&plan, buf);
+
+        /* spot-check bins (all of them for the small sizes) */
+        for (k = 0; k <= n / 2; k += (n <= 256 ? 1 : 37))
+        {
+            double re = 0.0, im = 0.0, er, ei;
+
+            for (i = 0; i < n; i++)
+            {
+                re += x[i] * cos(2.0 * pi * k * i / n);
+                im -= x[i] * sin(2.0 * pi * k * i / n);
+            }
+            if (k == 0)
+                er = buf[0] - re, ei = 0.0;
+            else if (k == n / 2)
+                er = buf[1] - re, ei = 0.0;
+            else
+                er = buf[2 * k] - re, ei = buf[2 * k + 1] - im;
+            if (fabs(er) > maxErr) maxErr = fabs(er);
+            if (fabs(ei) > maxErr) maxErr = fabs(ei);
+        }
+
+        eqFftInverse(&plan, buf);
+        for (i = 0; i < n; i++)
+            if (fabs(buf[i] - x[i]) > maxTrip)
+                maxTrip = fabs(buf[i] - x[i]);
+
+        /* float error grows with sqrt(n) log(n) for unit-variance input */
+        if (maxErr > 1e-5 * n || maxTrip > 1e-5)
+            fail = 1;
+        printf("fft %5u: max bin error %.2e, round trip %.2e\n",
+               n, maxErr, maxTrip);
+    }
+    return fail;
+}
+
+/*
+ *  verifyConvolve() - Overlap-save over several consecutive blocks
+ *                     against eqFirFloat().
+ */
+static int verifyConvolve(void)
+{
+    static const Uint32 taps[] = { 13, 101, 255, 511, 1023 };
+    static EqFftPlan plan;
+    static float h[BENCH_MAX_TAPS], spec[EQ_FFT_MAX], buf[EQ_FFT_MAX];
+    static float x[BENCH_MAX_TAPS + 8 * BENCH_BLOCK], y[BENCH_BLOCK];
+    Uint32 t, i, b;
+    int fail = 0;
+
+    for (t = 0; t < sizeof(taps) / sizeof(taps[0]); t++)
+    {
+        Uint32 T = taps[t], n = eqFftSize(BENCH_BLOCK, T);
+        double maxErr = 0.0, peak = 0.0;
+
+        eqFftInit(&plan, n);
+        for (i = 0; i < T; i++)
+            h[i] = benchNoise() / T;
+        eqFftSpectrum(&plan, h, T, spec);
+        for (i = 0; i < sizeof(x) / sizeof(x[0]); i++)
+            x[i] = (i < T - 1) ? 0.0f : benchNoise() * 10000.0f;
+        memset(buf, 0, sizeof(buf));
+
+        for (b = 0; b < 8; b++)
+        {
+            const float *in = x + T - 1 + b * BENCH_BLOCK;
+
+            memcpy(buf + n - BENCH_BLOCK - (T - 1), in - (T - 1),
+                   (BENCH_BLOCK + T - 1) * sizeof(float));
+            eqFftConvolve(&plan, spec, buf);
+            eqFirFloat(in, h, T, y, BENCH_BLOCK);
+            for (i = 0; i < BENCH_BLOCK; i++)
+            {
+                double e = fabs(buf[n - BENCH_BLOCK + i] - y[i]);
+                if (e > maxErr) maxErr = e;
+                if (fabs(y[i]) > peak) peak = fabs(y[i]);
+            }
+        }
+        if (maxErr > 1e-4 * peak)
+            fail = 1;
+        printf("overlap-save %4u taps (fft %4u): max error %.2e of peak %.0f\n",
+               T, n, maxErr, peak);
+    }
+    return fail;
+}
+
+/*
+ *  verifyEngine() - The FFT engine mode against direct form, frame by
+ *                   frame, for each filtering DIP setting.
+ */
+static int verifyEngine(void)
+{
+    static EqBank bank;
+    static EqEngine direct, fft;
+    static float spectra[7 * EQ_FFT_MAX];
+    static Int16 rcv[BENCH_FRAME], yd[BENCH_FRAME], yf[BENCH_FRAME];
+    EqMeters meters;
+    Uint32 dip, f, i;
+    int fail = 0;
+
+    eqBankInit(&bank, lp, bp, hp);
+
+    for (dip = 1; dip < 8; dip++)
+    {
+        int maxDiff = 0;
+
+        eqEngineInit(&direct, &bank.set[dip], lp1, bp1, hp1, 0);
+        eqEngineInit(&fft, &bank.set[dip], lp1, bp1, hp1, 0);
+        eqEngineSetFft(&fft, BENCH_FRAME);
+        eqBankPrepareFft(&bank, &fft.fft, spectra,
+                         sizeof(spectra) / sizeof(spectra[0]));
+
+        for (f = 0; f < 16; f++)
+        {
+            for (i = 0; i < BENCH_FRAME; i++)
+                rcv[i] = (Int16)(benchNoise() * 12000.0f);
+            eqEngineProcess(&direct, &bank.set[dip], rcv, yd, BENCH_FRAME,
+                            &meters);
+            eqEngineProcess(&fft, &bank.set[dip], rcv, yf, BENCH_FRAME,
+                            &meters);
+            for (i = 0; i < BENCH_FRAME; i++)
+                if (abs(yd[i] - yf[i]) > maxDiff)
+                    maxDiff = abs(yd[i] - yf[i]);
+        }
+        if (maxDiff > 1)
+            fail = 1;
+        printf("engine dip %u: fft vs direct max difference %d LSB\n",
+               dip, maxDiff);
+    }
+    return fail;
+}
+
+/*
+ *  verifyNBand() - A designed bank at unity gain sums to a delay, and its
+ *                  per-band energies add up to the input energy.
+ */
+static int verifyNBand(void)
+{
+    static EqNBand nb;
+    static EqBank bank;
+    static EqEngine eng;
+    static Int16 rcv[BENCH_FRAME], xmt[BENCH_FRAME];
+    float mix[EQ_FIR_TAPS];
+    EqMeters meters;
+    double maxErr = 0.0, total = 0.0, in = 0.0;
+    Uint32 i, f;
+    int fail = 0;
+
+    eqNBandDesign(&nb, 16, EQ_FIR_TAPS, BENCH_RATE, 60.0f);
+    eqNBandMix(&nb, mix);
+    for (i = 0; i < EQ_FIR_TAPS; i++)
+    {
+        double e = fabs(mix[i] - (i == EQ_FIR_TAPS / 2 ? 1.0 : 0.0));
+        if (e > maxErr) maxErr = e;
+    }
+
+    eqBankBuildNBand(&bank.set[1], &nb);
+    eqEngineInit(&eng, &bank.set[1], lp1, bp1, hp1, 0);
+    for (f = 0; f < 4; f++)
+    {
+        for (i = 0; i < BENCH_FRAME; i++)
+            rcv[i] = (Int16)(benchNoise() * 12000.0f);
+        eqEngineProcess(&eng, &bank.set[1], rcv, xmt, BENCH_FRAME, &meters);
+    }
+    /* last frame: white noise spreads over the bands by their widths,
+       less what overlapping transition bands split between them */
+    for (i = 0; i < BENCH_FRAME; i++)
+        in += (double)rcv[i] * rcv[i];
+    for (i = 0; i < meters.nbands; i++)
+        total += meters.energy[i];
+
+    if (maxErr > 1e-5 || meters.nbands != 16 || total / in < 0.7 || total / in > 1.05)
+        fail = 1;
+    printf("nband 16: mix vs delay max error %.2e, band energy sum / input "
+           "%.3f\n", maxErr, total / in);
+    return fail;
+}
+
+/*
+ *  verifyTrack() - A track of runs whose duties go up and down, by up to
+ *                  the full range, decodes to the packets written.
+ */
+static int verifyTrack(void)
+{
+    static EqTrackWriter w;
+    static Uint8 packets[3000][EQ_TACTILE_PACKET];
+    EqTrackInfo info;
+    EqTrack t;
+    EqTrackCursor c;
+    Uint8 got[EQ_TACTILE_PACKET], *base = NULL;
+    Uint32 n = sizeof(packets) / sizeof(packets[0]), i, k, bad = 0;
+    long length;
+    FILE *f = tmpfile();
+
+    if (f == NULL)
+        return 1;
+    for (i = 0; i < n; i++)
+    {
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+        {
+            /* runs of 1-7 packets; every other motor falls as i rises */
+            Uint32 r = i / (1 + (i / 64) % 7) + k * 131;
+            Uint16 duty = (Uint16)(r * 389 % (EQ_TACTILE_MAX + 1));
+
+            if (k & 1)
+                duty = EQ_TACTILE_MAX - duty;
+            if ((i / 200) % 3 == 2)
+                duty = (r & 1) ? EQ_TACTILE_MAX : 0;
+            packets[i][2 * k] = (Uint8)(duty >> 8);
+            packets[i][2 * k + 1] = (Uint8)duty;
+        }
+    }
+
+    memset(&info, 0, sizeof(info));
+    info.sampleRate = BENCH_RATE;
+    info.interval = BENCH_RATE / 10;
+    if (eqTrackWriterOpen(&w, f, &info) != 0)
+        bad = n;
+    for (i = 0; i < n && !bad; i++)
+        eqTrackWrite(&w, packets[i]);
+    if (!bad && eqTrackWriterClose(&w) == 0 &&
+        fseek(f, 0, SEEK_END) == 0 && (length = ftell(f)) > 0 &&
+        (base = malloc(length)) != NULL && fseek(f, 0, SEEK_SET) == 0 &&
+        fread(base, 1, length, f) == (size_t)length &&
+        eqTrackOpen(&t, base, (Uint32)length) == 0 && t.packets == n &&
+        eqTrackSeek(&t, &c, 0) == 0)
+    {
+        for (i = 0; i < n; i++)
+            if (eqTrackNext(&c, got) != 1 ||
+                memcmp(got, packets[i], EQ_TACTILE_PACKET) != 0)
+                bad++;
+    }
+    else
+        bad = n;
+    free(base);
+    fclose(f);
+
+    printf("track: %u of %u packets differ after a round trip\n", bad, n);
+    return bad != 0;
+}
+
+static int benchVerify(void)
+{
+    int fail = 0;
+
+    fail |= verifyFft();
+    fail |= verifyConvolve();
+    fail |= verifyEngine();
+    fail |= verifyNBand();
+    fail |= verifyTrack();
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
+
+/* ----------------------------- crossover ------------------------------ */
+
+/*
+ *  benchTime() - Seconds per call of fn, repeated for at least 50 ms.
+ */
+static double benchTime(void (*fn)(void *), void *arg)
+{
+    Uint32 reps = 0;
+    double start = benchNow(), now;
+
+    do
+    {
+        fn(arg);
+        reps++;
+        now = benchNow();
+    } while (now - start < 0.05);
+    return (now - start) / reps;
+}
+
+typedef struct CrossoverCase {
+    Uint32    taps;
+    EqFftPlan plan;
+    float     h[BENCH_MAX_TAPS];
+    float     spec[EQ_FFT_MAX];
+    float     buf[EQ_FFT_MAX];
+    float     x[BENCH_MAX_TAPS + BENCH_BLOCK];
+    float     y[BENCH_BLOCK];
+} CrossoverCase;
+
+static void runDirect(void *arg)
+{
+    CrossoverCase *c = arg;
+
+    eqFirFloat(c->x + c->taps - 1, c->h, c->taps, c->y, BENCH_BLOCK);
+}
+
+static void runFft(void *arg)
+{
+    CrossoverCase *c = arg;
+    Uint32 n = c->plan.n;
+
+    memcpy(c->buf + n - BENCH_BLOCK - (c->taps - 1), c->x,
+           (BENCH_BLOCK + c->taps - 1) * sizeof(float));
+    eqFftConvolve(&c->plan, c->spec, c->buf);
+    memcpy(c->y, c->buf + n - BENCH_BLOCK, BENCH_BLOCK * sizeof(float));
+}
+
+static int benchCrossover(void)
+{
+    static const Uint32 taps[] = { 13, 25, 51, 101, 151, 201, 255, 383, 511,
+                                   767, 1023 };
+    static CrossoverCase c;
+    double framePeriod = (double)BENCH_BLOCK / BENCH_RATE;
+    Uint32 t, i, crossover = 0;
+
+    printf("one channel, %u-sample blocks; frame deadline %.1f ms "
+           "(%u-word stereo frame at %u Hz)\n",
+           BENCH_BLOCK, framePeriod * 1e3, BENCH_FRAME, BENCH_RATE);
+    printf("%6s %6s %14s %14s %10s %10s\n", "taps", "fft", "direct ns/smp",
+           "fft ns/smp", "direct dl", "fft dl");
+
+    for (t = 0; t < sizeof(taps) / sizeof(taps[0]); t++)
+    {
+        double td, tf;
+
+        c.taps = taps[t];
+        eqFftInit(&c.plan, eqFftSize(BENCH_BLOCK, c.taps));
+        for (i = 0; i < c.taps; i++)
+            c.h[i] = benchNoise() / c.taps;
+        for (i = 0; i < c.taps - 1 + BENCH_BLOCK; i++)
+            c.x[i] = benchNoise();
+        eqFftSpectrum(&c.plan, c.h, c.taps, c.spec);
+        memset(c.buf, 0, sizeof(c.buf));
+
+        td = benchTime(runDirect, &c);
+        tf = benchTime(runFft, &c);
+        if (!crossover && tf < td)
+            crossover = c.taps;
+
+        /* deadline share for both channels of a frame */
+        printf("%6u %6u %14.2f %14.2f %9.3f%% %9.3f%%\n", c.taps, c.plan.n,
+               td * 1e9 / BENCH_BLOCK, tf * 1e9 / BENCH_BLOCK,
+               100.0 * EQ_CHANNELS * td / framePeriod,
+               100.0 * EQ_CHANNELS * tf / framePeriod);
+    }
+
+    if (crossover)
+        printf("fft is faster from %u taps\n", crossover);
+    else
+        printf("direct form is faster at every tap count measured\n");
+    return 0;
+}
+
+/* ------------------------------- fixed -------------------------------- */
+
+typedef struct FixedCase {
+    const float *h;
+    const Int16 *q;
+    Uint32      shift;
+    float       x[EQ_FIR_TAPS - 1 + BENCH_BLOCK];
+    Int16       xq[EQ_FIR_TAPS - 1 + BENCH_BLOCK];
+    float       y[BENCH_BLOCK];
+    Int16       yq[BENCH_BLOCK];
+} FixedCase;
+
+static void runFloat(void *arg)
+{
+    FixedCase *c = arg;
+
+    eqFirFloat(c->x + EQ_FIR_TAPS - 1, c->h, EQ_FIR_TAPS, c->y, BENCH_BLOCK);
+}
+
+static void runQ15(void *arg)
+{
+    FixedCase *c = arg;
+
+    eqFirQ15(c->xq + EQ_FIR_TAPS - 1, c->q, EQ_FIR_TAPS, c->shift, c->yq,
+             BENCH_BLOCK);
+}
+
+/*
+ *  fixedFile() - SNR of the Q15 kernel against float for each filtering
+ *                entry over every channel of one file.
+ */
+static int fixedFile(const char *path, const EqBank *bank)
+{
+    WavData wav;
+    Uint32 len, c, i, dip;
+    float *x, *y;
+    Int16 *xq, *yq;
+
+    if (wavRead(path, &wav) != 0)
+        return 1;
+    len = EQ_FIR_TAPS - 1 + wav.frames;
+    x = calloc(len, sizeof(float));
+    y = malloc(wav.frames * sizeof(float));
+    xq = calloc(len, sizeof(Int16));
+    yq = malloc(wav.frames * sizeof(Int16));
+    if (!x || !y || !xq || !yq)
+    {
+        fprintf(stderr, "%s: out of memory\n", path);
+        exit(1);
+    }
+
+    printf("%s: %u frames x %u channels\n", path, wav.frames, wav.channels);
+    for (dip = 1; dip < 8; dip++)
+    {
+        const EqCoefSet *set = &bank->set[dip];
+        double sig = 0.0, noise = 0.0, maxErr = 0.0;
+
+        for (c = 0; c < wav.channels; c++)
+        {
+            for (i = 0; i < wav.frames; i++)
+            {
+                xq[EQ_FIR_TAPS - 1 + i] = wav.samples[i * wav.channels + c];
+                x[EQ_FIR_TAPS - 1 + i] = xq[EQ_FIR_TAPS - 1 + i];
+            }
+            eqFirFloat(x + EQ_FIR_TAPS - 1, set->h, EQ_FIR_TAPS, y,
+                       wav.frames);
+            eqFirQ15(xq + EQ_FIR_TAPS - 1, set->q, EQ_FIR_TAPS,
+                     set->qShift, yq, wav.frames);
+
+            for (i = 0; i < wav.frames; i++)
+            {
+                /* both paths saturate to the codec range */
+                double r = y[i] > 32767.0f ? 32767.0 :
+                           y[i] < -32768.0f ? -32768.0 : y[i];
+                double e = fabs(yq[i] - r);
+
+                sig += r * r;
+                noise += e * e;
+                if (e > maxErr)
+                    maxErr = e;
+            }
+        }
+        printf("  dip %u (Q%u): SNR %6.1f dB, max error %.2f LSB\n", dip,
+               set->qShift, noise > 0.0 ? 10.0 * log10(sig / noise) : 999.0,
+               maxErr);
+    }
+
+    free(x);
+    free(y);
+    free(xq);
+    free(yq);
+    wavFree(&wav);
+    return 0;
+}
+
+static int benchFixed(int argc, char **argv)
+{
+    static EqBank bank;
+    static FixedCase c;
+    const EqCoefSet *set;
+    double tf, tq;
+    int fail = 0, i;
+
+    eqBankInit(&bank, lp, bp, hp);
+    for (i = 0; i < argc; i++)
+        fail |= fixedFile(argv[i], &bank);
+
+    set = &bank.set[7];
+    c.h = set->h;
+    c.q = set->q;
+    c.shift = set->qShift;
+    for (i = 0; i < EQ_FIR_TAPS - 1 + BENCH_BLOCK; i++)
+        c.x[i] = c.xq[i] = (Int16)(benchNoise() * 12000.0f);
+    tf = benchTime(runFloat, &c);
+    tq = benchTime(runQ15, &c);
+    printf("%u taps, one channel: float %.2f ns/smp, Q15 %.2f ns/smp\n",
+           EQ_FIR_TAPS, tf * 1e9 / BENCH_BLOCK, tq * 1e9 / BENCH_BLOCK);
+    return fail;
+}
+
+/* ------------------------------- nband -------------------------------- */
+
+typedef struct NBandCase {
+    EqEngine eng;
+    EqBank   bank;
+    Int16    rcv[BENCH_FRAME];
+    Int16    xmt[BENCH_FRAME];
+} NBandCase;
+
+static void runNBand(void *arg)
+{
+    NBandCase *c = arg;
+    EqMeters meters;
+
+    eqEngineProcess(&c->eng, &c->bank.set[1], c->rcv, c->xmt, BENCH_FRAME,
+                    &meters);
+}
+
+/*
+ *  nbandTime() - Seconds per frame of the engine rendering and metering
+ *                nb (nb == NULL: the plain three-band entry for DIP 7).
+ */
+static double nbandTime(NBandCase *c, const EqNBand *nb)
+{
+    Uint32 i;
+
+    eqBankInit(&c->bank, lp, bp, hp);
+    if (nb)
+        eqBankBuildNBand(&c->bank.set[1], nb);
+    else
+        c->bank.set[1] = c->bank.set[7];
+    eqEngineInit(&c->eng, &c->bank.set[1], lp1, bp1, hp1, 0);
+    for (i = 0; i < BENCH_FRAME; i++)
+        c->rcv[i] = (Int16)(benchNoise() * 12000.0f);
+    return benchTime(runNBand, c);
+}
+
+static char *readText(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    char *text;
+    long len;
+
+    if (f == NULL || fseek(f, 0, SEEK_END) || (len = ftell(f)) < 0 ||
+        fseek(f, 0, SEEK_SET) || (text = malloc(len + 1)) == NULL)
+    {
+        fprintf(stderr, "%s: cannot read\n", path);
+        exit(1);
+    }
+    if (fread(text, 1, len, f) != (size_t)len)
+    {
+        fprintf(stderr, "%s: read error\n", path);
+        exit(1);
+    }
+    text[len] = '\0';
+    fclose(f);
+    return text;
+}
+
+static int benchNBand(int argc, char **argv)
+{
+    static const Uint32 counts[] = { 8, 12, 16, 20, 24, 28, 32 };
+    static NBandCase c;
+    static EqNBand nb;
+    double deadline = (double)BENCH_BLOCK / BENCH_RATE, base, t, slope;
+    Uint32 i, n;
+
+    base = nbandTime(&c, NULL);
+    printf("%u-word frame, deadline %.1f ms; three-band entry %.3f ms "
+           "(%.2f%%)\n", BENCH_FRAME, deadline * 1e3, base * 1e3,
+           100.0 * base / deadline);
+    printf("%6s %10s %10s\n", "bands", "ms/frame", "deadline");
+
+    if (argc > 0)
+    {
+        char *text = readText(argv[0]);
+
+        if (eqNBandParse(&nb, text) != 0)
+        {
+            fprintf(stderr, "%s: not an N-band file\n", argv[0]);
+            return 1;
+        }
+        free(text);
+        t = nbandTime(&c, &nb);
+        printf("%6u %10.3f %9.2f%%\n", nb.bands, t * 1e3,
+               100.0 * t / deadline);
+        n = nb.bands;
+    }
+    else
+    {
+        for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+        {
+            eqNBandDesign(&nb, counts[i], EQ_FIR_TAPS, BENCH_RATE, 60.0f);
+            t = nbandTime(&c, &nb);
+            printf("%6u %10.3f %9.2f%%\n", nb.bands, t * 1e3,
+                   100.0 * t / deadline);
+        }
+        n = nb.bands;
+    }
+
+    /* each band costs one more filter over the frame */
+    slope = (t - base) / n;
+    printf("%.3f ms per band; the deadline allows about %.0f bands "
+           "on this core\n", slope * 1e3,
+           slope > 0.0 ? (deadline - base) / slope : 0.0);
+    return 0;
+}
+
+static int benchDesign(int argc, char **argv)
+{
+    static EqNBand nb;
+    Uint32 bands, taps = EQ_FIR_TAPS, b, i;
+    float lowHz = 60.0f;
+
+    if (argc < 1)
+        return 2;
+    bands = strtoul(argv[0], NULL, 0);
+    if (argc > 1)
+        taps = strtoul(argv[1], NULL, 0);
+    if (argc > 2)
+        lowHz = atof(argv[2]);
+    if (eqNBandDesign(&nb, bands, taps, BENCH_RATE, lowHz) != 0)
+    {
+        fprintf(stderr, "design: %u bands of %u taps from %g Hz is out of "
+                "range\n", bands, taps, lowHz);
+        return 1;
+    }
+
+    printf("# %u-band windowed-sinc bank, %u Hz\n", bands, BENCH_RATE);
+    printf("bands %u taps %u\n", nb.bands, nb.taps);
+    for (b = 0; b < nb.bands; b++)
+    {
+        printf("# %.1f - %.1f Hz\nband %g", nb.lowHz[b], nb.highHz[b],
+               nb.gain[b]);
+        for (i = 0; i < nb.taps; i++)
+            printf("%s%.9g", i % 6 ? " " : "\n", nb.h[b][i]);
+        printf("\n");
+    }
+    return 0;
+}
+
+/* -------------------------------- iir --------------------------------- */
+
+typedef struct IirCase {
+    EqEngine eng;
+    EqBank   bank;
+    Uint32   dip;
+    Int16    rcv[BENCH_FRAME];
+    Int16    xmt[BENCH_FRAME];
+} IirCase;
+
+static void runIir(void *arg)
+{
+    IirCase *c = arg;
+    EqMeters meters;
+
+    eqEngineProcess(&c->eng, &c->bank.set[c->dip], c->rcv, c->xmt,
+                    BENCH_FRAME, &meters);
+}
+
+/*
+ *  iirTime() - Seconds and time stamp counter ticks per stereo sample of
+ *              the engine at DIP 7 with the given paths.
+ */
+static void iirTime(IirCase *c, Uint32 audio, Uint32 meter, double *sec,
+                    double *ticks)
+{
+    Uint32 i, reps = 200;
+    double t0;
+
+    eqEngineInit(&c->eng, &c->bank.set[7], lp1, bp1, hp1, 0);
+    eqEngineSetPaths(&c->eng, audio, meter, BENCH_RATE);
+    c->dip = 7;
+    for (i = 0; i < BENCH_FRAME; i++)
+        c->rcv[i] = (Int16)(benchNoise() * 12000.0f);
+
+    *sec = benchTime(runIir, c) / BENCH_BLOCK;
+    t0 = benchTicks();
+    for (i = 0; i < reps; i++)
+        runIir(c);
+    *ticks = (benchTicks() - t0) / reps / BENCH_BLOCK;
+}
+
+/*
+ *  iirDelay() - Peak and median (half the energy arrived) of the left
+ *               channel's response to an impulse at DIP dip, in samples.
+ */
+static void iirDelay(IirCase *c, Uint32 dip, Uint32 audio, Uint32 *peak,
+                     Uint32 *median)
+{
+    double total = 0.0, sum = 0.0;
+    Uint32 i;
+    int best = -1;
+
+    eqEngineInit(&c->eng, &c->bank.set[dip], lp1, bp1, hp1, 0);
+    eqEngineSetPaths(&c->eng, audio, EQ_PATH_FIR, BENCH_RATE);
+    c->dip = dip;
+    memset(c->rcv, 0, sizeof(c->rcv));
+    c->rcv[0] = 16000;
+    runIir(c);
+
+    *peak = *median = 0;
+    for (i = 0; i < BENCH_FRAME; i += EQ_CHANNELS)
+    {
+        total += (double)c->xmt[i] * c->xmt[i];
+        if (abs(c->xmt[i]) > best)
+        {
+            best = abs(c->xmt[i]);
+            *peak = i / EQ_CHANNELS;
+        }
+    }
+    for (i = 0; i < BENCH_FRAME && sum < total / 2; i += EQ_CHANNELS)
+    {
+        sum += (double)c->xmt[i] * c->xmt[i];
+        *median = i / EQ_CHANNELS;
+    }
+}
+
+static int benchIir(void)
+{
+    static const char *name[] = { "fir", "iir" };
+    static IirCase c;
+    double frameMs = 1e3 * BENCH_BLOCK / BENCH_RATE, sec, ticks;
+    Uint32 audio, meter, dip, peak[2], median[2];
+
+    eqBankInit(&c.bank, lp, bp, hp);
+
+    printf("engine at DIP 7, %u-word frames; per stereo sample\n",
+           BENCH_FRAME);
+    printf("%6s %6s %10s %12s\n", "audio", "meter", "ns/smp", "ticks/smp");
+    for (audio = EQ_PATH_FIR; audio <= EQ_PATH_IIR; audio++)
+        for (meter = EQ_PATH_FIR; meter <= EQ_PATH_IIR; meter++)
+        {
+            iirTime(&c, audio, meter, &sec, &ticks);
+            printf("%6s %6s %10.2f %12.1f\n", name[audio], name[meter],
+                   sec * 1e9, ticks);
+        }
+
+    printf("\nfilter delay, samples (ms) at %u Hz: impulse peak / median\n",
+           BENCH_RATE);
+    printf("%4s %20s %20s\n", "dip", "fir", "iir");
+    for (dip = 1; dip < 8; dip++)
+    {
+        for (audio = EQ_PATH_FIR; audio <= EQ_PATH_IIR; audio++)
+            iirDelay(&c, dip, audio, &peak[audio], &median[audio]);
+        printf("%4u %5u / %3u (%4.1f) %5u / %3u (%4.1f)\n", dip,
+               peak[0], median[0], 1e3 * median[0] / BENCH_RATE,
+               peak[1], median[1], 1e3 * median[1] / BENCH_RATE);
+    }
+    printf("end to end: add %.1f ms of Ping/Pong buffering (two frames)\n",
+           2.0 * frameMs);
+    return 0;
+}
+
+/* -------------------------------- sdft -------------------------------- */
+
+typedef struct SdftCase {
+    EqSdft s;
+    Uint32 hops;
+    float  ms[EQ_NUM_BANDS];
+    Int16  rcv[BENCH_FRAME];
+} SdftCase;
+
+static void sdftSink(void *arg, const float ms[EQ_NUM_BANDS])
+{
+    SdftCase *c = arg;
+
+    memcpy(c->ms, ms, sizeof(c->ms));
+}
+
+static void runSdft(void *arg)
+{
+    SdftCase *c = arg;
+
+    c->hops += eqSdftPush(&c->s, c->rcv, BENCH_FRAME);
+}
+
+static int benchSdft(void)
+{
+    static const float hopMs[] = { 2.5f, 5.0f, 10.0f, 20.0f };
+    static const float windowMs[] = { 20.0f, 50.0f, 100.0f, 160.0f };
+    static const float toneHz[] = { 500.0f, 1500.0f, 3000.0f };
+    static SdftCase c;
+    Uint32 h, w, i, b;
+    int rc = 0;
+
+    for (i = 0; i < BENCH_FRAME; i++)
+        c.rcv[i] = (Int16)(benchNoise() * 12000.0f);
+
+    printf("sliding DFT, %u points; ns per stereo sample\n", EQ_SDFT_SIZE);
+    printf("%8s", "hop/win");
+    for (w = 0; w < sizeof(windowMs) / sizeof(windowMs[0]); w++)
+        printf(" %7.0fms", windowMs[w]);
+    printf("\n");
+    for (h = 0; h < sizeof(hopMs) / sizeof(hopMs[0]); h++)
+    {
+        printf("%6.1fms", hopMs[h]);
+        for (w = 0; w < sizeof(windowMs) / sizeof(windowMs[0]); w++)
+        {
+            if (eqSdftInit(&c.s, BENCH_RATE, EQ_IIR_LO_HZ, EQ_IIR_HI_HZ,
+                           hopMs[h] / 1e3f, windowMs[w] / 1e3f, sdftSink,
+                           &c) != 0)
+            {
+                printf(" %9s", "-");
+                continue;
+            }
+            printf(" %9.2f", benchTime(runSdft, &c) / BENCH_BLOCK * 1e9);
+        }
+        printf("\n");
+    }
+
+    /* a tone at half scale has a mean square of 0.125, all in its band */
+    printf("\ntone at half scale, 10 ms hops over 100 ms: band mean squares\n");
+    printf("%8s %9s %9s %9s\n", "Hz", "low", "mid", "high");
+    for (i = 0; i < sizeof(toneHz) / sizeof(toneHz[0]); i++)
+    {
+        Uint32 n, band = toneHz[i] < EQ_IIR_LO_HZ ? EQ_LP :
+                         toneHz[i] < EQ_IIR_HI_HZ ? EQ_BP : EQ_HP;
+
+        eqSdftInit(&c.s, BENCH_RATE, EQ_IIR_LO_HZ, EQ_IIR_HI_HZ, 0.01f, 0.1f,
+                   sdftSink, &c);
+        for (n = 0; n < BENCH_RATE / 2; n++)
+        {
+            Int16 x = (Int16)(16384.0 * sin(2.0 * M_PI * toneHz[i] * n /
+                                            BENCH_RATE));
+            Int16 words[EQ_CHANNELS] = { x, x };
+
+            eqSdftPush(&c.s, words, EQ_CHANNELS);
+        }
+        printf("%8.0f", toneHz[i]);
+        for (b = 0; b < EQ_NUM_BANDS; b++)
+            printf(" %9.5f", c.ms[b]);
+        printf("\n");
+        if (fabsf(c.ms[band] - 0.125f) > 0.005f)
+            rc = 1;
+    }
+    printf("%s\n", rc ? "FAIL" : "ok");
+    return rc;
+}
+
+/* ------------------------------ resample ------------------------------ */
+
+#define RESAMPLE_SECONDS    2
+
+typedef struct ResampleCase {
+    EqResamplePlan plan;
+    EqResampler    r;
+    Int16          *in;
+    Uint32         frames;
+    Int16          *out;
+    Uint32         made;
+} ResampleCase;
+
+static void runResample(void *arg)
+{
+    ResampleCase *c = arg;
+
+    eqResampleInit(&c->r, &c->plan, EQ_CHANNELS);
+    eqResampleSeek(&c->r, c->plan.delay);
+    c->made = eqResamplePush(&c->r, c->in, c->frames, c->out);
+}
+
+/*
+ *  resampleTone() - Three tones inside the 8 kHz band at time t, plus one
+ *                   of amplitude alias at 6 kHz that must not get through.
+ */
+static double resampleTone(double t, double alias)
+{
+    double v = 6000.0 * sin(2.0 * M_PI * 440.0 * t) +
+               4000.0 * sin(2.0 * M_PI * 1700.0 * t + 1.0) +
+               3000.0 * sin(2.0 * M_PI * 3100.0 * t + 2.0);
+
+    return v + alias * sin(2.0 * M_PI * 6000.0 * t);
+}
+
+static int benchResample(void)
+{
+    static const Uint32 rates[] = { 11025, 22050, 32000, 44100, 48000,
+                                    88200, 96000 };
+    static ResampleCase c;
+    static IirCase e;
+    double engine, sec, err, sig, alias;
+    Uint32 k, i, n;
+    int rc = 0;
+
+    /* the engine at DIP 7 with its default paths, per 8 kHz sample */
+    eqBankInit(&e.bank, lp, bp, hp);
+    eqEngineInit(&e.eng, &e.bank.set[7], lp1, bp1, hp1, 0);
+    e.dip = 7;
+    for (i = 0; i < BENCH_FRAME; i++)
+        e.rcv[i] = (Int16)(benchNoise() * 12000.0f);
+    engine = benchTime(runIir, &e) / BENCH_BLOCK * BENCH_RATE;
+
+    printf("to %u Hz; time per second of audio, engine at DIP 7 %.3f ms\n",
+           EQ_RESAMPLE_RATE, engine * 1e3);
+    printf("%6s %7s %5s %9s %8s %9s %9s\n", "rate", "up/down", "taps",
+           "ms/s", "xengine", "err_dB", "alias_dB");
+    for (k = 0; k < sizeof(rates) / sizeof(rates[0]); k++)
+    {
+        double a = rates[k] > 12000 ? 8000.0 : 0.0;
+
+        if (eqResamplePlan(&c.plan, rates[k], EQ_RESAMPLE_RATE) != 0)
+        {
+            printf("%6u unsupported\n", rates[k]);
+            rc = 1;
+            continue;
+        }
+        c.frames = rates[k] * RESAMPLE_SECONDS;
+        c.in = malloc(c.frames * EQ_CHANNELS * sizeof(Int16));
+        c.out = malloc(eqResampleMaxOut(&c.plan, c.frames) * EQ_CHANNELS *
+                       sizeof(Int16));
+        if (c.in == NULL || c.out == NULL)
+            return 1;
+        for (i = 0; i < c.frames; i++)
+        {
+            double t = (double)i / rates[k];
+
+            c.in[EQ_CHANNELS * i] = (Int16)resampleTone(t, a);
+            c.in[EQ_CHANNELS * i + 1] = (Int16)resampleTone(t, 0.0);
+        }
+        sec = benchTime(runResample, &c) / RESAMPLE_SECONDS;
+
+        /* away from the ends, against the tones computed at 8 kHz */
+        err = sig = alias = 0.0;
+        n = 0;
+        for (i = EQ_RESAMPLE_RATE / 10; i + EQ_RESAMPLE_RATE / 10 < c.made;
+             i++, n++)
+        {
+            double t = (double)i / EQ_RESAMPLE_RATE, ideal = resampleTone(t, 0);
+            double r = c.out[EQ_CHANNELS * i + 1] - ideal;
+            double l = c.out[EQ_CHANNELS * i] - c.out[EQ_CHANNELS * i + 1];
+
+            sig += ideal * ideal;
+            err += r * r;
+            alias += l * l;
+        }
+        printf("%6u %3u/%-3u %5u %9.3f %8.2f %9.1f", rates[k], c.plan.up,
+               c.plan.down, c.plan.taps, sec * 1e3, sec / engine,
+               10.0 * log10(err / sig + 1e-30));
+        if (a > 0.0)
+            printf(" %9.1f\n", 10.0 * log10(alias / n / (a * a / 2.0)));
+        else
+            printf(" %9s\n", "-");
+        free(c.in);
+        free(c.out);
+    }
+    return rc;
+}
+
+/* ------------------------------- onset -------------------------------- */
+
+#define ONSET_FRAMES    2000            // 64 ms frames, about two minutes
+#define ONSET_ATTACK_DB 12.0f
+
+typedef struct OnsetCase {
+    EqOnset  o;
+    EqMeters meters;
+    Uint32   words;
+} OnsetCase;
+
+static void runOnset(void *arg)
+{
+    OnsetCase *c = arg;
+
+    eqOnsetPush(&c->o, &c->meters, c->words);
+}
+
+static int benchOnset(void)
+{
+    static const Uint32 words[] = { 64, 256, 1024, 4096 };
+    static Uint8 attack[ONSET_FRAMES];      // bit b: band b attacks
+    static OnsetCase c;
+    Uint32 k, f, b, found, hits = 0, misses = 0, spurious = 0, attacks = 0;
+    float db[EQ_NUM_BANDS];
+    int rc = 0;
+
+    printf("onset detector, ns per frame\n");
+    printf("%6s %9s\n", "words", "ns");
+    for (k = 0; k < sizeof(words) / sizeof(words[0]); k++)
+    {
+        c.words = words[k];
+        for (b = 0; b < EQ_NUM_BANDS; b++)
+            c.meters.power[b] = 1e6f * words[k] * (1.0f + benchNoise());
+        eqOnsetInit(&c.o, BENCH_RATE, EQ_ONSET_TAU, EQ_ONSET_K, EQ_ONSET_HOLD,
+                    0.0f, NULL, NULL);
+        printf("%6u %9.1f\n", words[k], benchTime(runOnset, &c) * 1e9);
+    }
+
+    /* each band wanders around -20 dB; an attack jumps ONSET_ATTACK_DB in
+       one band and decays over the next frames, every 0.5 to 1.5 s */
+    for (f = 64; f < ONSET_FRAMES; f += 8 + (Uint32)((benchNoise() + 1.0f) * 8))
+        attack[f] |= 1u << (Uint32)((benchNoise() + 1.0f) * 1.5f);
+    eqOnsetInit(&c.o, BENCH_RATE, EQ_ONSET_TAU, EQ_ONSET_K, EQ_ONSET_HOLD,
+                EQ_ADAPT_WARMUP, NULL, NULL);
+    for (b = 0; b < EQ_NUM_BANDS; b++)
+        db[b] = -20.0f;
+    for (f = 0; f < ONSET_FRAMES; f++)
+    {
+        for (b = 0; b < EQ_NUM_BANDS; b++)
+        {
+            db[b] = -20.0f + 0.7f * (db[b] + 20.0f) + 1.5f * benchNoise();
+            if ((attack[f] >> b) & 1)
+                db[b] += ONSET_ATTACK_DB;
+            c.meters.power[b] = BENCH_FRAME * EQ_FULL_SCALE2 *
+                                (float)pow(10.0, db[b] / 10.0);
+        }
+        found = eqOnsetPush(&c.o, &c.meters, BENCH_FRAME);
+        for (b = 0; b < EQ_NUM_BANDS; b++)
+        {
+            Uint32 want = (attack[f] >> b) & 1, got = (found >> b) & 1;
+
+            attacks += want;
+            hits += want && got;
+            misses += want && !got;
+            spurious += got && !want;
+        }
+    }
+    printf("\n%u attacks of %.0f dB in %u frames: %u found, %u missed, "
+           "%u spurious\n", attacks, ONSET_ATTACK_DB, ONSET_FRAMES, hits,
+           misses, spurious);
+    if (misses * 10 > attacks || spurious * 10 > attacks)
+        rc = 1;
+    printf("%s\n", rc ? "FAIL" : "ok");
+    return rc;
+}
+
+/* ------------------------------- suite -------------------------------- */
+
+#define SUITE_MAX_CASES     64
+#define SUITE_MAX_FILES     (SUITE_MAX_CASES - EQ_BANK_SIZE - 1)
+#define SUITE_SLOWER        10.0    // default % over the baseline that fails
+
+typedef struct SuiteResult {
+    char   name[64];
+    double nsPerSample;             // per stereo sample
+    double framesPerSec;            // BENCH_FRAME-word frames
+    double headroom;                // of the frame period, 0..1
+} SuiteResult;
+
+static SuiteResult gSuite[SUITE_MAX_CASES];
+static Uint32 gSuiteCases;
+
+/*
+ *  suiteAdd() - Record a case that takes sec per BENCH_FRAME-word frame.
+ *               Cases past SUITE_MAX_CASES are dropped.
+ */
+static void suiteAdd(const char *name, double sec)
+{
+    SuiteResult *r = &gSuite[gSuiteCases];
+    double period = (double)BENCH_BLOCK / BENCH_RATE;
+
+    if (gSuiteCases == SUITE_MAX_CASES)
+        return;
+    gSuiteCases++;
+
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->nsPerSample = sec / BENCH_BLOCK * 1e9;
+    r->framesPerSec = 1.0 / sec;
+    r->headroom = 1.0 - sec / period;
+    printf("%-24s %10.2f %12.0f %8.1f%%\n", r->name, r->nsPerSample,
+           r->framesPerSec, 100.0 * r->headroom);
+}
+
+typedef struct MeterCase {
+    EqFir       *fir;
+    const float *meter[EQ_NUM_BANDS];
+    Uint32      symmetric;
+    float       power[EQ_NUM_BANDS];
+    Int16       rcv[BENCH_FRAME];
+} MeterCase;
+
+static void runMeters(void *arg)
+{
+    MeterCase *c = arg;
+
+    eqFirLoad(c->fir, c->rcv, BENCH_FRAME, c->meter, c->symmetric, c->power);
+    eqFirCommit(c->fir, BENCH_FRAME);
+}
+
+/*
+ *  suiteFile() - Seconds per frame from a WAV file to motor packets: the
+ *                conversion to 8 kHz, the engine at DIP 7 and the tactile
+ *                encoder, as gupta_nair_sim runs them.
+ */
+static int suiteFile(const char *path, IirCase *c, double *sec)
+{
+    static EqTactile t;
+    WavData wav;
+    Uint32 frames, f, i;
+    double t0;
+
+    if (wavRead(path, &wav) != 0)
+        return -1;
+    t0 = benchNow();
+    if (wavResample(&wav, BENCH_RATE) != 0 || wav.channels > 2)
+    {
+        wavFree(&wav);
+        return -1;
+    }
+    eqEngineInit(&c->eng, &c->bank.set[7], lp1, bp1, hp1, 0);
+    eqTactileInit(&t, BENCH_RATE, 0.1f, EQ_ADAPT_WARMUP, NULL, NULL);
+    frames = (wav.frames + BENCH_BLOCK - 1) / BENCH_BLOCK;
+    for (f = 0; f < frames; f++)
+    {
+        EqMeters meters;
+
+        for (i = 0; i < BENCH_FRAME; i++)
+        {
+            Uint32 n = f * BENCH_BLOCK + i / EQ_CHANNELS;
+            Uint32 ch = wav.channels == 1 ? 0 : i % EQ_CHANNELS;
+
+            c->rcv[i] = n < wav.frames ? wav.samples[n * wav.channels + ch]
+                                       : 0;
+        }
+        eqEngineProcess(&c->eng, &c->bank.set[7], c->rcv, c->xmt,
+                        BENCH_FRAME, &meters);
+        eqTactilePush(&t, &meters, BENCH_FRAME);
+    }
+    *sec = frames ? (benchNow() - t0) / frames : 0.0;
+    wavFree(&wav);
+    return frames ? 0 : -1;
+}
+
+/*
+ *  suiteBuild() - The kernels and arithmetic this binary was built with.
+ */
+static const char *suiteBuild(void)
+{
+#if defined(EQ_FIXED)
+    const char *arith = "q15";
+#else
+    const char *arith = "float";
+#endif
+#if defined(EQ_FIR_SCALAR)
+    const char *simd = "scalar";
+#elif defined(__AVX__)
+    const char *simd = "avx";
+#elif defined(__SSE2__)
+    const char *simd = "sse2";
+#else
+    const char *simd = "scalar";
+#endif
+    static char build[32];
+
+    snprintf(build, sizeof(build), "%s/%s", simd, arith);
+    return build;
+}
+
+static int suiteWrite(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    Uint32 i;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "{\n  \"version\": 1,\n  \"build\": \"%s\",\n"
+            "  \"rate\": %u,\n  \"frame_words\": %u,\n"
+            "  \"deadline_ms\": %.3f,\n  \"results\": [\n", suiteBuild(),
+            BENCH_RATE, BENCH_FRAME, 1e3 * BENCH_BLOCK / BENCH_RATE);
+    for (i = 0; i < gSuiteCases; i++)
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_sample\": %.3f, "
+                "\"frames_per_sec\": %.1f, \"headroom\": %.5f}%s\n",
+                gSuite[i].name, gSuite[i].nsPerSample,
+                gSuite[i].framesPerSec, gSuite[i].headroom,
+                i + 1 < gSuiteCases ? "," : "");
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+/*
+ *  suiteBaseline() - ns_per_sample of case name in the JSON text of an
+ *                    earlier suite -o, or a negative value if it has none.
+ */
+static double suiteBaseline(const char *json, const char *name)
+{
+    char key[80];
+    const char *p;
+
+    snprintf(key, sizeof(key), "\"name\": \"%s\"", name);
+    p = strstr(json, key);
+    if (p == NULL || (p = strstr(p, "\"ns_per_sample\":")) == NULL)
+        return -1.0;
+    return atof(p + strlen("\"ns_per_sample\":"));
+}
+
+static int benchSuite(int argc, char **argv)
+{
+    static const char *mode[] = { "filter", "bypass", "mute" };
+    static IirCase c;
+    static MeterCase m;
+    const char *out = NULL, *base = NULL, *deflt[] = { "../test.wav" };
+    double slower = SUITE_SLOWER, sec;
+    Uint32 dip, i;
+    int argi, rc = 0;
+
+    for (argi = 0; argi < argc && argv[argi][0] == '-'; argi++)
+    {
+        if (!strcmp(argv[argi], "-o") && argi + 1 < argc)
+            out = argv[++argi];
+        else if (!strcmp(argv[argi], "-b") && argi + 1 < argc)
+            base = argv[++argi];
+        else if (!strcmp(argv[argi], "-t") && argi + 1 < argc)
+            slower = atof(argv[++argi]);
+        else
+            usage();
+    }
+    if (argi == argc)
+    {
+        argv = (char **)deflt;
+        argc = 1;
+        argi = 0;
+    }
+    if (argc - argi > SUITE_MAX_FILES)
+    {
+        fprintf(stderr, "suite: at most %d WAV files\n", SUITE_MAX_FILES);
+        return 1;
+    }
+
+    printf("%s, %u-word frames at %u Hz, deadline %.1f ms\n", suiteBuild(),
+           BENCH_FRAME, BENCH_RATE, 1e3 * BENCH_BLOCK / BENCH_RATE);
+    printf("%-24s %10s %12s %9s\n", "case", "ns/smp", "frames/s",
+           "headroom");
+
+    /* processBuffer()'s engine for each DIP value, meters included */
+    eqBankInit(&c.bank, lp, bp, hp);
+    for (i = 0; i < BENCH_FRAME; i++)
+        c.rcv[i] = (Int16)(benchNoise() * 12000.0f);
+    for (dip = 0; dip < EQ_BANK_SIZE; dip++)
+    {
+        char name[32];
+
+        eqEngineInit(&c.eng, &c.bank.set[dip], lp1, bp1, hp1, 0);
+        c.dip = dip;
+        snprintf(name, sizeof(name), "dip%u/%s", dip,
+                 mode[c.bank.set[dip].mode]);
+        suiteAdd(name, benchTime(runIir, &c));
+    }
+
+    /* the three LED power loops on their own */
+    if (posix_memalign((void **)&m.fir, 32, sizeof(*m.fir)) != 0)
+        return 1;
+    eqFirInit(m.fir);
+    m.meter[EQ_LP] = lp1;
+    m.meter[EQ_BP] = bp1;
+    m.meter[EQ_HP] = hp1;
+    m.symmetric = eqFirIsSymmetric(lp1, EQ_LED_TAPS) &&
+                  eqFirIsSymmetric(bp1, EQ_LED_TAPS) &&
+                  eqFirIsSymmetric(hp1, EQ_LED_TAPS);
+    memcpy(m.rcv, c.rcv, sizeof(m.rcv));
+    suiteAdd("meters", benchTime(runMeters, &m));
+    free(m.fir);
+
+    for (; argi < argc; argi++)
+    {
+        const char *slash = strrchr(argv[argi], '/');
+        char name[64];
+
+        if (suiteFile(argv[argi], &c, &sec) != 0)
+        {
+            fprintf(stderr, "%s: not a usable WAV file\n", argv[argi]);
+            return 1;
+        }
+        snprintf(name, sizeof(name), "e2e/%s",
+                 slash ? slash + 1 : argv[argi]);
+        suiteAdd(name, sec);
+    }
+
+    if (out && suiteWrite(out) != 0)
+        return 1;
+    if (base)
+    {
+        char *json = readText(base);
+
+        printf("\nagainst %s (fails %.0f%% slower)\n", base, slower);
+        printf("%-24s %10s %10s %8s\n", "case", "base", "now", "change");
+        for (i = 0; i < gSuiteCases; i++)
+        {
+            double b = suiteBaseline(json, gSuite[i].name), change;
+
+            if (b <= 0.0)
+            {
+                printf("%-24s %10s %10.2f %8s\n", gSuite[i].name, "-",
+                       gSuite[i].nsPerSample, "new");
+                continue;
+            }
+            change = 100.0 * (gSuite[i].nsPerSample / b - 1.0);
+            printf("%-24s %10.2f %10.2f %+7.1f%%%s\n", gSuite[i].name, b,
+                   gSuite[i].nsPerSample, change,
+                   change > slower ? " SLOWER" : "");
+            if (change > slower)
+                rc = 1;
+        }
+        printf("%s\n", rc ? "FAIL" : "ok");
+        free(json);
+    }
+    return rc;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: eq_bench verify | crossover | fixed in.wav... |\n"
+        "                nband [bands.txt] | design bands [taps [lowHz]] |\n"
+        "                iir | sdft | resample | onset |\n"
+        "                suite [-o out.json] [-b base.json] [-t percent]\n"
+        "                      [in.wav...]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+        usage();
+    if (!strcmp(argv[1], "verify"))
+        return benchVerify();
+    if (!strcmp(argv[1], "crossover"))
+        return benchCrossover();
+    if (!strcmp(argv[1], "fixed"))
+        return benchFixed(argc - 2, argv + 2);
+    if (!strcmp(argv[1], "nband"))
+        return benchNBand(argc - 2, argv + 2);
+    if (!strcmp(argv[1], "design") && argc > 2)
+        return benchDesign(argc - 2, argv + 2);
+    if (!strcmp(argv[1], "iir"))
+        return benchIir();
+    if (!strcmp(argv[1], "sdft"))
+        return benchSdft();
+    if (!strcmp(argv[1], "resample"))
+        return benchResample();
+    if (!strcmp(argv[1], "onset"))
+        return benchOnset();
+    if (!strcmp(argv[1], "suite"))
+        return benchSuite(argc - 2, argv + 2);
+    usage();
+    return 2;
+}
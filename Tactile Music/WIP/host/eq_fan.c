@@ -0,0 +1,394 @@
+/*
+ *  ======== eq_fan.c ========
+ *
+ *  Group sessions: several audio streams at once, each driving many
+ *  tactile sleeves through its own fan-out encoder (eq_fanout.h).
+ *
+ *  Usage: eq_fan [-j threads] [-s streams] [-n devices] [-m map]...
+ *                [-w seconds] [-c] [-S] in.wav...
+ *
+ *  Stream i plays file i % files (default: one stream per file) and
+ *  drives -n devices (default 1), device j with map j % maps.  A map
+ *  is four comma-separated band sets, one per motor in packet order, each
+ *  made of the letters l, b and h (low, mid, high) or "-" for none:
+ *  "lbh,l,b,h", the script's layout, is the default.  Each stream runs
+ *  the LED meter filters once per frame (eqFirLoad()) and hands the
+ *  powers to its encoder.  The streams are dealt out to -j threads
+ *  (default: one per core), and each thread plays its streams in turn,
+ *  frame by frame.  Files at other rates are converted to 8 kHz first.
+ *
+ *  -c checks every motor whose set is a single band or all three against
+ *  eqTactilePush() on the same powers, packet by packet.  -S measures
+ *  instead: the cost of one stream per second of audio against its
+ *  device count, split into the meters and the fan-out, and the streams
+ *  a core keeps up with in real time at 1, 2, 4, ... threads up to -j.
+ */
+#define DSK_SIM_HARNESS
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dsk_sim.h"
+#include "eq_fanout.h"
+#include "eq_resample.h"
+#include "wav_io.h"
+
+extern const float lp1[], bp1[], hp1[];
+
+#define FAN_FRAME       1024            // words, as BUFFSIZE
+#define FAN_RATE        EQ_RESAMPLE_RATE
+#define FAN_INTERVAL    0.1f            // seconds per packet, as the sim
+#define FAN_MAX_STREAMS 1024
+#define FAN_MAX_MAPS    16
+#define FAN_MAX_JOBS    256
+
+typedef struct FanStream {
+    const WavData *wav;
+    Uint32        frames;           // FAN_FRAME-word frames, the last padded
+    EqFir         *fir;
+    EqFanout      fan;
+    EqTactile     ref;              // -c
+    Uint32        mismatches;
+} FanStream;
+
+typedef struct FanThread {
+    FanStream *stream;
+    int       nstreams;
+    int       first;                // this thread plays first, + threads, ..
+    int       step;
+    int       check;
+    double    meterSec;             // time in the meters
+    double    fanSec;               // time in the encoders
+    pthread_t thread;
+} FanThread;
+
+static const float *gMeter[EQ_METERS];
+static Uint32 gMeterSymmetric;
+static float gWarmup = EQ_ADAPT_WARMUP;
+static Uint8 gMap[FAN_MAX_MAPS][EQ_TACTILE_MOTORS];
+static int gMaps;
+
+static double fanNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ *  fanParseMap() - "lbh,l,b,h" to band sets.  Returns 0, or -1 if it is
+ *                  not four sets.
+ */
+static int fanParseMap(const char *s, Uint8 map[EQ_TACTILE_MOTORS])
+{
+    Uint32 m;
+
+    for (m = 0; m < EQ_TACTILE_MOTORS; m++)
+    {
+        map[m] = 0;
+        if (*s == '-')
+            s++;
+        else
+            for (; *s && *s != ','; s++)
+            {
+                if (*s == 'l')
+                    map[m] |= EQ_BAND_LP;
+                else if (*s == 'b')
+                    map[m] |= EQ_BAND_BP;
+                else if (*s == 'h')
+                    map[m] |= EQ_BAND_HP;
+                else
+                    return -1;
+            }
+        if (m + 1 < EQ_TACTILE_MOTORS && *s++ != ',')
+            return -1;
+    }
+    return *s ? -1 : 0;
+}
+
+/*
+ *  fanWords() - Frame f of a file as codec words, as the sim feeds them.
+ */
+static void fanWords(const WavData *wav, Uint32 f, Int16 *y)
+{
+    Uint32 i;
+
+    for (i = 0; i < FAN_FRAME; i++)
+    {
+        Uint32 w = f * FAN_FRAME + i, t = w / EQ_CHANNELS;
+        Uint32 c = wav->channels == 1 ? 0 : w % EQ_CHANNELS;
+
+        y[i] = t < wav->frames ? wav->samples[t * wav->channels + c] : 0;
+    }
+}
+
+/*
+ *  fanCheck() - Compare each checkable motor of every device with the
+ *               single-sleeve encoder's packet.
+ */
+static void fanCheck(FanStream *s)
+{
+    /* the reference motor of each set; -2 never runs, -1 has none */
+    static const int motor[EQ_FAN_SETS] = { -2, EQ_TACTILE_LP,
+        EQ_TACTILE_BP, -1, EQ_TACTILE_HP, -1, -1, EQ_TACTILE_ALL };
+    const EqFanout *f = &s->fan;
+    Uint32 d, m;
+
+    for (d = 0; d < f->devices; d++)
+        for (m = 0; m < EQ_TACTILE_MOTORS; m++)
+        {
+            int k = motor[f->set[m][d]], ref = 0;
+            int on = f->last[d][2 * m] | f->last[d][2 * m + 1];
+
+            if (k == -1)
+                continue;
+            if (k >= 0)
+                ref = s->ref.last[2 * k] | s->ref.last[2 * k + 1];
+            if (!on != !ref)
+                s->mismatches++;
+        }
+}
+
+static void *fanThread(void *arg)
+{
+    FanThread *t = arg;
+    Int16 frame[FAN_FRAME];
+    EqMeters meters;
+    Uint32 f;
+    int i;
+
+    memset(&meters, 0, sizeof(meters));
+    for (i = t->first; i < t->nstreams; i += t->step)
+    {
+        FanStream *s = &t->stream[i];
+
+        eqFirInit(s->fir);
+        for (f = 0; f < s->frames; f++)
+        {
+            double t0 = fanNow(), t1;
+            Uint32 done;
+
+            fanWords(s->wav, f, frame);
+            eqFirLoad(s->fir, frame, FAN_FRAME, gMeter, gMeterSymmetric,
+                      meters.power);
+            eqFirCommit(s->fir, FAN_FRAME);
+            t1 = fanNow();
+            done = eqFanoutPush(&s->fan, &meters, FAN_FRAME);
+            t->meterSec += t1 - t0;
+            t->fanSec += fanNow() - t1;
+
+            if (t->check)
+            {
+                eqTactilePush(&s->ref, &meters, FAN_FRAME);
+                if (done)
+                    fanCheck(s);
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ *  fanRun() - Play every stream with devices devices on threads threads.
+ *             Returns the wall time; *meter and *fan are the CPU seconds
+ *             in each part.
+ */
+static double fanRun(FanStream *stream, int nstreams, int devices,
+                     int threads, int check, double *meter, double *fan)
+{
+    static FanThread thread[FAN_MAX_JOBS];
+    double t0;
+    int i, d;
+
+    for (i = 0; i < nstreams; i++)
+    {
+        FanStream *s = &stream[i];
+
+        eqFanoutInit(&s->fan, FAN_RATE, FAN_INTERVAL, gWarmup);
+        for (d = 0; d < devices; d++)
+            eqFanoutAdd(&s->fan, gMap[d % gMaps], EQ_TACTILE_ON, NULL, NULL);
+        eqTactileInit(&s->ref, FAN_RATE, FAN_INTERVAL, gWarmup, NULL, NULL);
+        s->mismatches = 0;
+    }
+
+    t0 = fanNow();
+    for (i = 0; i < threads; i++)
+    {
+        thread[i].stream = stream;
+        thread[i].nstreams = nstreams;
+        thread[i].first = i;
+        thread[i].step = threads;
+        thread[i].check = check;
+        thread[i].meterSec = thread[i].fanSec = 0.0;
+        pthread_create(&thread[i].thread, NULL, fanThread, &thread[i]);
+    }
+    *meter = *fan = 0.0;
+    for (i = 0; i < threads; i++)
+    {
+        pthread_join(thread[i].thread, NULL);
+        *meter += thread[i].meterSec;
+        *fan += thread[i].fanSec;
+    }
+    return fanNow() - t0;
+}
+
+/*
+ *  fanScale() - The -S tables.
+ */
+static void fanScale(FanStream *stream, int nstreams, int jobs, double audio)
+{
+    static const int devices[] = { 1, 4, 16, 64 };
+    double wall, meter, fan, serial = 0.0;
+    Uint32 k;
+    int j;
+
+    printf("one stream, per second of audio\n");
+    printf("%7s %10s %10s %13s\n", "devices", "meters_us", "fanout_us",
+           "per_device_ns");
+    for (k = 0; k < sizeof(devices) / sizeof(devices[0]); k++)
+    {
+        fanRun(stream, 1, devices[k], 1, 0, &meter, &fan);
+        meter /= (double)stream[0].wav->frames / FAN_RATE;
+        fan /= (double)stream[0].wav->frames / FAN_RATE;
+        printf("%7d %10.1f %10.1f %13.1f\n", devices[k], meter * 1e6,
+               fan * 1e6, fan * 1e9 / devices[k] /
+               (FAN_RATE / (FAN_RATE * FAN_INTERVAL)));
+    }
+
+    printf("\n%d streams of 1 device; real-time streams per core\n",
+           nstreams);
+    printf("%7s %9s %11s %8s %7s\n", "threads", "wall_s", "streams/core",
+           "speedup", "effic");
+    for (j = 1; ; j = j * 2 < jobs ? j * 2 : jobs)
+    {
+        wall = fanRun(stream, nstreams, 1, j, 0, &meter, &fan);
+        if (j == 1)
+            serial = wall;
+        printf("%7d %9.3f %11.0f %8.2f %6.0f%%\n", j, wall,
+               audio / wall / j, serial / wall, 100.0 * serial / wall / j);
+        if (j == jobs)
+            break;
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: eq_fan [-j threads] [-s streams] [-n devices] [-m map]...\n"
+        "              [-w seconds] [-c] [-S] in.wav...\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static FanStream stream[FAN_MAX_STREAMS];
+    WavData *wav;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN), nstreams = 0;
+    int devices = 1, check = 0, scale = 0, nfiles, argi, i;
+    double audio = 0.0, wall, meter, fan;
+    Uint32 mismatches = 0;
+
+    for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++)
+    {
+        if (!strcmp(argv[argi], "-j") && argi + 1 < argc)
+            jobs = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-s") && argi + 1 < argc)
+            nstreams = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-n") && argi + 1 < argc)
+            devices = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-m") && argi + 1 < argc &&
+                 gMaps < FAN_MAX_MAPS)
+        {
+            if (fanParseMap(argv[++argi], gMap[gMaps++]) != 0)
+                usage();
+        }
+        else if (!strcmp(argv[argi], "-w") && argi + 1 < argc)
+            gWarmup = (float)atof(argv[++argi]);
+        else if (!strcmp(argv[argi], "-c"))
+            check = 1;
+        else if (!strcmp(argv[argi], "-S"))
+            scale = 1;
+        else
+            usage();
+    }
+    nfiles = argc - argi;
+    if (nfiles == 0)
+        usage();
+    if (nstreams <= 0)
+        nstreams = nfiles;
+    if (nstreams > FAN_MAX_STREAMS || devices < 1 ||
+        devices > EQ_FAN_MAX_DEVICES)
+        usage();
+    if (jobs < 1)
+        jobs = 1;
+    if (jobs > FAN_MAX_JOBS)
+        jobs = FAN_MAX_JOBS;
+    if (gMaps == 0)
+    {
+        static const Uint8 script[EQ_TACTILE_MOTORS] = EQ_FAN_MAP_SCRIPT;
+
+        memcpy(gMap[gMaps++], script, sizeof(script));
+    }
+
+    gMeter[0] = lp1;
+    gMeter[1] = bp1;
+    gMeter[2] = hp1;
+    gMeterSymmetric = eqFirIsSymmetric(lp1, EQ_LED_TAPS) &&
+                      eqFirIsSymmetric(bp1, EQ_LED_TAPS) &&
+                      eqFirIsSymmetric(hp1, EQ_LED_TAPS);
+
+    wav = calloc(nfiles, sizeof(*wav));
+    if (wav == NULL)
+        return 1;
+    for (i = 0; i < nfiles; i++)
+        if (wavRead(argv[argi + i], &wav[i]) != 0 ||
+            wavResample(&wav[i], FAN_RATE) != 0)
+            return 1;
+        else if (wav[i].channels > 2)
+        {
+            fprintf(stderr, "%s: only mono or stereo input is supported\n",
+                    argv[argi + i]);
+            return 1;
+        }
+
+    for (i = 0; i < nstreams; i++)
+    {
+        FanStream *s = &stream[i];
+
+        s->wav = &wav[i % nfiles];
+        s->frames = (s->wav->frames * EQ_CHANNELS + FAN_FRAME - 1) /
+                    FAN_FRAME;
+        if (posix_memalign((void **)&s->fir, 32, sizeof(*s->fir)) != 0)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        audio += (double)s->wav->frames / FAN_RATE;
+    }
+
+    if (scale)
+        fanScale(stream, nstreams, jobs, audio);
+    else
+    {
+        wall = fanRun(stream, nstreams, devices, jobs, check, &meter, &fan);
+        printf("%d streams x %d devices, %.1f s of audio in %.3f s on %d "
+               "threads: %.1f audio s/s (meters %.0f%%, fan-out %.0f%%)\n",
+               nstreams, devices, audio, wall, jobs, audio / wall,
+               100.0 * meter / (meter + fan), 100.0 * fan / (meter + fan));
+        for (i = 0; i < nstreams; i++)
+            mismatches += stream[i].mismatches;
+        if (check)
+            printf("%s: %u motor packets differ from eqTactilePush()\n",
+                   mismatches ? "FAIL" : "ok", mismatches);
+    }
+
+    for (i = 0; i < nstreams; i++)
+        free(stream[i].fir);
+    for (i = 0; i < nfiles; i++)
+        wavFree(&wav[i]);
+    free(wav);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,403 @@
+/*
+ *  ======== link_mock.c ========
+ *
+ *  Local stand-in for the BLE link to the sleeve: plays a tactile track
+ *  to the reference receiver of eq_link.h over a simulated transport,
+ *  once as play_file() sends it and once in batched link messages, and
+ *  compares what the motors do with what the track asks for.
+ *
+ *  Usage: link_mock [-l ms] [-J ms] [-p percent] [-b intervals]
+ *                   [-L ms] [-H ms] [-s seed] track.ttrk
+ *
+ *  Every write reaches the receiver -l ms (default 30) plus a uniform
+ *  0..-J ms (default 40) after it is sent, in order, and -p percent of
+ *  them are lost.  The receiver's clock ticks every millisecond.
+ *
+ *  legacy   Each interval's packet is written when it is due and an
+ *           all-zero one -H ms (default 25) later; the receiver applies
+ *           each write as it arrives, like processWrite().
+ *  batched  -b intervals (default 8) per message, each message sent -L ms
+ *           (default 150) before its first interval with the envelope
+ *           "on for -H ms".  The audio plays -L ms behind the track.
+ *
+ *  For each, the table gives the writes and bytes per second, the error
+ *  of the motor onsets against the audio (mean, standard deviation and
+ *  worst, ms), the onsets missed, and the milliseconds in which any
+ *  motor differs from the track.
+ */
+#define DSK_SIM_HARNESS
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dsk_sim.h"
+#include "eq_link.h"
+#include "eq_track.h"
+
+typedef struct MockWrite {
+    Uint32 arrive;                  // receiver ms, or MOCK_NONE if lost
+    Uint32 packet;                  // legacy: interval, MOCK_NONE to stop
+    Uint32 len;
+    Uint8  msg[EQ_LINK_MAX_MESSAGE];
+} MockWrite;
+
+typedef struct MockLink {
+    MockWrite *write;
+    Uint32    count;
+    Uint32    cap;
+    Uint32    bytes;
+    Uint32    last;                 // latest arrival so far
+    Uint32    seed;
+    Uint32    latency;
+    Uint32    jitter;
+    float     loss;
+    Uint32    now;                  // sender ms of the next write
+} MockLink;
+
+typedef struct MockResult {
+    Uint32 writes;
+    Uint32 bytes;
+    Uint32 onsets;
+    Uint32 missed;
+    double sum;                     // onset error, ms
+    double sum2;
+    Int32  worst;
+    Uint32 mismatch;                // ms
+} MockResult;
+
+#define MOCK_NONE   0xffffffffu
+
+static const EqTrack *gTrack;
+static Uint8 (*gPacket)[EQ_TACTILE_PACKET];
+static Uint32 gHold = 25;
+
+/*
+ *  mockRandom() - Uniform in [0, 1), from the link's own generator so a
+ *                 seed replays the same run.
+ */
+static double mockRandom(MockLink *l)
+{
+    l->seed = l->seed * 1664525u + 1013904223u;
+    return (l->seed >> 8) / 16777216.0;
+}
+
+/*
+ *  mockSend() - EqLinkSend for the transport: queue a write sent at
+ *               l->now.
+ */
+static void mockSend(void *arg, const Uint8 *msg, Uint32 len)
+{
+    MockLink *l = arg;
+    MockWrite *w;
+    Uint32 arrive;
+
+    if (l->count == l->cap)
+    {
+        l->cap = l->cap ? 2 * l->cap : 1024;
+        l->write = realloc(l->write, l->cap * sizeof(*l->write));
+        if (l->write == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    w = &l->write[l->count++];
+    memcpy(w->msg, msg, len);
+    w->len = len;
+    l->bytes += len;
+
+    /* in order: a write never overtakes the one before it */
+    arrive = l->now + l->latency + (Uint32)(mockRandom(l) * (l->jitter + 1));
+    if (arrive < l->last)
+        arrive = l->last;
+    w->packet = MOCK_NONE;
+    if (mockRandom(l) * 100.0 < l->loss)
+        w->arrive = MOCK_NONE;
+    else
+        w->arrive = l->last = arrive;
+}
+
+/*
+ *  mockStream() - Stream ms of interval i of the track.
+ */
+static Uint32 mockStream(Uint32 i)
+{
+    return (Uint32)((double)i * gTrack->info.interval * 1000.0 /
+                    gTrack->info.sampleRate);
+}
+
+/*
+ *  mockInterval() - The interval that starts at stream ms, or MOCK_NONE.
+ */
+static Uint32 mockInterval(Uint32 ms)
+{
+    Uint32 i = (Uint32)((double)ms * gTrack->info.sampleRate /
+                        gTrack->info.interval / 1000.0);
+
+    while (i > 0 && mockStream(i) > ms)
+        i--;
+    while (i < gTrack->packets && mockStream(i) < ms)
+        i++;
+    return i < gTrack->packets && mockStream(i) == ms ? i : MOCK_NONE;
+}
+
+static int mockActive(const Uint8 *packet)
+{
+    Uint32 k;
+
+    for (k = 0; k < EQ_TACTILE_PACKET; k++)
+        if (packet[k])
+            return 1;
+    return 0;
+}
+
+/*
+ *  mockPlay() - Run the receiver over the writes of l, with the track's
+ *               intervals due base ms after their stream time, and score
+ *               it.  An onset is the motors changing to a non-zero set of
+ *               duties; it belongs to the interval the receiver is playing
+ *               (the last packet for legacy writes, else the queue's
+ *               head).  onset has room for an entry per interval.
+ */
+static void mockPlay(MockLink *l, Uint32 *onset, Uint32 base, MockResult *r)
+{
+    EqLinkDecoder d;
+    Uint16 duty[EQ_TACTILE_MOTORS], prev[EQ_TACTILE_MOTORS] = { 0 };
+    Uint32 end = base + mockStream(gTrack->packets) + 1000;
+    Uint32 next = 0, p = 0, shown = MOCK_NONE, now, i, k;
+
+    eqLinkDecoderInit(&d);
+    memset(r, 0, sizeof(*r));
+    r->writes = l->count;
+    r->bytes = l->bytes;
+    for (i = 0; i < gTrack->packets; i++)
+        onset[i] = MOCK_NONE;
+
+    for (now = 0; now < end; now++)
+    {
+        Uint32 want, changed = 0, active = 0;
+
+        /* writes arrive in order, so the lost ones just get skipped */
+        while (next < l->count && (l->write[next].arrive == MOCK_NONE ||
+                                   l->write[next].arrive <= now))
+        {
+            const MockWrite *w = &l->write[next++];
+
+            if (w->arrive == MOCK_NONE)
+                continue;
+            eqLinkReceive(&d, w->msg, w->len, w->arrive);
+            if (w->len == EQ_TACTILE_PACKET && w->packet != MOCK_NONE)
+                shown = w->packet;
+        }
+        eqLinkDuties(&d, now, duty);
+        if (d.synced && d.count)
+            shown = mockInterval(d.slot[d.head].due - d.offset);
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+        {
+            changed |= duty[k] != prev[k];
+            active |= duty[k];
+            prev[k] = duty[k];
+        }
+        if (changed && active && shown != MOCK_NONE &&
+            onset[shown] == MOCK_NONE)
+            onset[shown] = now;
+
+        /* the track: each interval on for the first gHold ms */
+        want = 0;
+        if (now >= base)
+        {
+            while (p + 1 < gTrack->packets &&
+                   mockStream(p + 1) <= now - base)
+                p++;
+            want = now - base - mockStream(p) < gHold;
+        }
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+        {
+            Uint32 w = want ? (gPacket[p][2 * k] << 8) | gPacket[p][2 * k + 1]
+                            : 0;
+
+            if (duty[k] != w)
+            {
+                r->mismatch++;
+                break;
+            }
+        }
+    }
+
+    for (i = 0; i < gTrack->packets; i++)
+    {
+        Int32 err;
+
+        if (!mockActive(gPacket[i]))
+            continue;
+        r->onsets++;
+        if (onset[i] == MOCK_NONE)
+        {
+            r->missed++;
+            continue;
+        }
+        err = (Int32)(onset[i] - base - mockStream(i));
+        r->sum += err;
+        r->sum2 += (double)err * err;
+        if (abs(err) > abs(r->worst))
+            r->worst = err;
+    }
+}
+
+static void mockPrint(const char *mode, const MockResult *r, double seconds)
+{
+    Uint32 n = r->onsets - r->missed;
+    double mean = n ? r->sum / n : 0.0;
+    double var = n ? r->sum2 / n - mean * mean : 0.0;
+
+    printf("%-8s %8.1f %8.0f %9.1f %9.1f %7d %7u %9u\n", mode,
+           r->writes / seconds, r->bytes / seconds, mean,
+           sqrt(var > 0.0 ? var : 0.0), r->worst, r->missed, r->mismatch);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: link_mock [-l ms] [-J ms] [-p percent] [-b intervals]\n"
+        "                 [-L ms] [-H ms] [-s seed] track.ttrk\n");
+    exit(2);
+}
+
+/*
+ *  mockCompare() - Play track t from path over link, legacy then batched,
+ *                  and print the table.  gPacket and onset hold t.packets
+ *                  + 1 entries.  Returns 0, or 1 for a corrupt track.
+ */
+static int mockCompare(MockLink *link, const EqTrack *t, const char *path,
+                       Uint32 batch, Uint32 lead, Uint32 *onset)
+{
+    static const Uint8 stop[EQ_TACTILE_PACKET];
+    MockResult legacy, batched;
+    EqLinkEncoder e;
+    EqTrackCursor c;
+    double seconds;
+    Uint32 i;
+
+    if (eqTrackSeek(t, &c, 0) != 0)
+        return 1;
+    for (i = 0; i < t->packets; i++)
+        if (eqTrackNext(&c, gPacket[i]) != 1)
+        {
+            fprintf(stderr, "%s: corrupt track\n", path);
+            return 1;
+        }
+    seconds = mockStream(t->packets) / 1000.0;
+    if (t->packets == 0 || !(seconds > 0.0) ||
+        eqLinkEncoderInit(&e, (float)t->info.sampleRate, t->info.interval,
+                          batch, lead, 0, gHold, mockSend, link) != 0)
+    {
+        fprintf(stderr, "%s: empty track\n", path);
+        return 1;
+    }
+
+    /* legacy: the packet when due, the stop hold ms later */
+    for (i = 0; i < t->packets; i++)
+    {
+        link->now = mockStream(i);
+        mockSend(link, gPacket[i], EQ_TACTILE_PACKET);
+        link->write[link->count - 1].packet = i;
+        link->now += gHold;
+        mockSend(link, stop, EQ_TACTILE_PACKET);
+    }
+    mockPlay(link, onset, 0, &legacy);
+
+    /* batched: each message leaves lead ms before its first interval
+       plays, which is at its stream time on the sender's clock */
+    link->count = link->bytes = link->last = 0;
+    for (i = 0; i < t->packets; i++)
+    {
+        Uint32 first = i - i % batch;
+
+        link->now = eqLinkStreamMs(&e, first);
+        eqLinkPacket(&e, gPacket[i]);
+    }
+    eqLinkFlush(&e);
+
+    mockPlay(link, onset, lead, &batched);
+
+    printf("%.1f s, %u intervals; link %u ms + 0..%u ms, %.1f%% lost; "
+           "batch %u, lead %u ms\n", seconds, t->packets, link->latency,
+           link->jitter, link->loss, batch, lead);
+    printf("%-8s %8s %8s %9s %9s %7s %7s %9s\n", "mode", "writes/s",
+           "bytes/s", "onset_ms", "jitter_ms", "worst", "missed",
+           "mismatch");
+    mockPrint("legacy", &legacy, seconds);
+    mockPrint("batched", &batched, seconds);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    MockLink link;
+    EqTrack t;
+    struct stat st;
+    Uint32 *onset, batch = 8, lead = 150;
+    void *base = MAP_FAILED;
+    int fd, argi, rc = 1;
+
+    memset(&link, 0, sizeof(link));
+    link.latency = 30;
+    link.jitter = 40;
+    link.seed = 1;
+    for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++)
+    {
+        if (!strcmp(argv[argi], "-l") && argi + 1 < argc)
+            link.latency = (Uint32)atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-J") && argi + 1 < argc)
+            link.jitter = (Uint32)atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-p") && argi + 1 < argc)
+            link.loss = (float)atof(argv[++argi]);
+        else if (!strcmp(argv[argi], "-b") && argi + 1 < argc)
+            batch = (Uint32)atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-L") && argi + 1 < argc)
+            lead = (Uint32)atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-H") && argi + 1 < argc)
+            gHold = (Uint32)atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-s") && argi + 1 < argc)
+            link.seed = (Uint32)atoi(argv[++argi]);
+        else
+            usage();
+    }
+    /* the limits of the message fields (eq_link.h) */
+    if (argi + 1 != argc || gHold == 0 || gHold > 0xff || batch == 0 ||
+        batch > EQ_LINK_MAX_INTERVALS || lead > 0xffff)
+        usage();
+
+    fd = open(argv[argi], O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror(argv[argi]);
+        return 1;
+    }
+    if (st.st_size)
+        base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED || eqTrackOpen(&t, base, (Uint32)st.st_size) != 0)
+    {
+        fprintf(stderr, "%s: not a TTRK version %d track\n", argv[argi],
+                EQ_TRACK_VERSION);
+        if (base != MAP_FAILED)
+            munmap(base, st.st_size);
+        return 1;
+    }
+    gTrack = &t;
+    gPacket = malloc((t.packets + 1) * sizeof(*gPacket));
+    onset = malloc((t.packets + 1) * sizeof(*onset));
+    if (gPacket && onset)
+        rc = mockCompare(&link, &t, argv[argi], batch, lead, onset);
+
+    free(link.write);
+    free(onset);
+    free(gPacket);
+    munmap(base, st.st_size);
+    return rc;
+}
@@ -0,0 +1,542 @@
+/*
+ *  ======== sim_main.c ========
+ *
+ *  WAV replay harness for the DSK6713 equalizer.  Gupta_Nair.c is compiled
+ *  as-is against dsk_sim.h; this file plays the part of the codec,
+ *  the EDMA controller and the DSP/BIOS scheduler:
+ *
+ *  1)  dskAppMain() runs the application's own initialization, so the
+ *      EDMA buffer ring link tables are the ones built by initEdma().
+ *  2)  Each frame, the simulated EDMA streams gBuffSize words from the WAV
+ *      file into the active receive buffer and from the active transmit
+ *      buffer into the output, then raises the completion interrupt.
+ *      edmaHwi() posts processBufferSwi, which runs when the HWI returns.
+ *  3)  The load(), blinkLED() and hapticTick() PRDs are called every 10 ms,
+ *      500 ms and 1 ms of timer time, with the DIP switches set from the
+ *      command line.  The timer keeps audio time unless -c skews it.
+ *
+ *  Usage: gupta_nair_sim [-d mask[@seconds]]... [-e direct|fft]
+ *                        [-a fir|iir] [-m fir|iir] [-n bands.txt] [-q]
+ *                        [-s] [-f words] [-r depth] [-t packets.bin]
+ *                        [-w seconds] [-H ms] [-k ms] [-c ppm]
+ *                        [-o add|only] in.wav out.wav
+ *         gupta_nair_sim -S [options] in.wav
+ *
+ *  -d sets the DIP switch pattern (0..15, bit n = switch n depressed),
+ *  optionally from a given point in the file; repeat to flip switches
+ *  mid-stream.  -e picks the filtering engine (gEqEngineMode), and -a and
+ *  -m the filter family of the output and of the LED meters (gEqAudioPath,
+ *  gEqMeterPath).  -n replaces
+ *  the filtering DIP settings (1..7) with an N-band bank loaded from a
+ *  file in the eq_nband.h format, at the file's gains.  -s prints the
+ *  frame timing statistics (dumpStats()) at the end.  -f and -r set the
+ *  frame size in words (gBuffSize, 64..4096) and the number of buffers in
+ *  the EDMA ring (gRingDepth, 2..8).  -t writes the tactile sleeve's motor
+ *  packets (gEqTactile) to a file, 8 bytes each, as they would be sent,
+ *  or as a TTRK track (eq_track.h) if the name ends in .ttrk; use it with
+ *  -m iir for the encoder's own bands.  -w sets the warm-up of the
+ *  adaptive LED and motor thresholds (gAdaptWarmup).  -H sends a motor
+ *  packet every ms milliseconds, each over the last 100 ms, from the
+ *  sliding DFT of eq_sdft.h (gTactileHop).  -k releases the packets on
+ *  the sample clock (eq_sched.h, gTactileSched), ms after the end of each
+ *  interval (0: when it is heard), and prints the scheduler's drift and jitter
+ *  at the end; hapticTick() runs every millisecond.  -c runs the codec
+ *  ppm parts per million fast against the PRD timer (slow if negative),
+ *  which moves the PRDs against the frames.  -o lets the band onsets of
+ *  eq_onset.h run the motors as well as the level ("add") or instead of
+ *  it ("only"), and prints the onsets found (gTactileOnsets).  Mono
+ *  input is fed to both codec channels.  Input at any other rate than
+ *  the 8 kHz the filters are designed for is converted to it first
+ *  (wavResample()).  The output is stereo at 8 kHz and includes the
+ *  latency of the ring, gRingDepth frames.
+ *
+ *  -S sweeps power-of-two frame sizes against every ring depth instead,
+ *  running the file once per setting (in a child process, so each run
+ *  starts from the application's initial state), and prints the latency
+ *  of each setting against the time left for processing.  The times are
+ *  the host's, so only their ratios carry over to the DSK.
+ */
+#define DSK_SIM_HARNESS
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "dsk_sim.h"
+#include "eq_engine.h"
+#include "eq_onset.h"
+#include "eq_resample.h"
+#include "eq_sched.h"
+#include "eq_sdft.h"
+#include "eq_stats.h"
+#include "eq_track.h"
+#include "wav_io.h"
+
+extern int dip_value;
+extern int gEqEngineMode;
+extern int gEqAudioPath;
+extern int gEqMeterPath;
+extern int gBuffSize;
+extern int gRingDepth;
+extern EqStats gEqStats;
+extern EqTactile gEqTactile;
+extern EqTactileSink gTactileSink;
+extern void *gTactileArg;
+extern float gAdaptWarmup;
+extern float gTactileHop;
+extern int gTactileSched;
+extern float gSchedDelay;
+extern Uint32 gTactileOnsets;
+extern EqOnset gEqOnset;
+extern EqSched gEqSched;
+extern EqBank gEqBank;
+extern EqEngine gEqEngine;
+void edmaHwi(void);
+void load(void);
+void blinkLED(void);
+void hapticTick(void);
+void dumpStats(void);
+
+#define SIM_MAX_DIP_EVENTS  32
+#define SIM_LOAD_MS         10      // PRD_load period
+#define SIM_BLINK_MS        500     // PRD_blinkLed period
+#define SIM_TICK_MS         1       // PRD_hapticTick period
+#define SIM_SWEEP_MIN       64      // -S frame sizes, words
+#define SIM_SWEEP_MAX       4096
+#define SIM_SWEEP_DEPTH     8
+
+typedef struct DipEvent {
+    double seconds;
+    Uint32 mask;
+} DipEvent;
+
+typedef struct SimStream {
+    const WavData *in;
+    Uint32 inPos;           // next input sample (per-channel index)
+    Uint32 inChan;          // codec channel the next word belongs to
+    Int16  *out;
+    Uint32 outLen;          // words written
+    Uint32 outCap;
+} SimStream;
+
+static double gCodecPpm;            // -c
+
+/*
+ *  simRcv() - Next codec word for the receive EDMA.  Mono files are
+ *             duplicated onto both channels; past the end, silence.
+ */
+static Int16 simRcv(void *arg)
+{
+    SimStream *s = arg;
+    Int16 v = 0;
+
+    if (s->inPos < s->in->frames)
+    {
+        Uint32 ch = s->in->channels == 1 ? 0 : s->inChan;
+        v = s->in->samples[s->inPos * s->in->channels + ch];
+    }
+    if (++s->inChan == 2)
+    {
+        s->inChan = 0;
+        s->inPos++;
+    }
+    return v;
+}
+
+/*
+ *  simXmt() - Capture a word sent by the transmit EDMA.
+ */
+static void simXmt(void *arg, Int16 sample)
+{
+    SimStream *s = arg;
+
+    if (s->outLen == s->outCap)
+    {
+        s->outCap = s->outCap ? 2 * s->outCap : 65536;
+        s->out = realloc(s->out, s->outCap * sizeof(Int16));
+        if (s->out == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    s->out[s->outLen++] = sample;
+}
+
+/*
+ *  simTactile() - Write a motor packet to the -t file.
+ */
+static void simTactile(void *arg, const Uint8 *packet)
+{
+    fwrite(packet, 1, EQ_TACTILE_PACKET, (FILE *)arg);
+}
+
+/*
+ *  simLoadNBand() - Parse an N-band file and install it for DIP 1..7.
+ */
+static int simLoadNBand(const char *path, EqNBand *nb)
+{
+    FILE *f = fopen(path, "rb");
+    char *text = NULL;
+    long len = -1;
+    Uint32 dip;
+    int rc = -1;
+
+    if (f && fseek(f, 0, SEEK_END) == 0 && (len = ftell(f)) >= 0 &&
+        fseek(f, 0, SEEK_SET) == 0 && (text = malloc(len + 1)) != NULL &&
+        fread(text, 1, len, f) == (size_t)len)
+    {
+        text[len] = '\0';
+        rc = eqNBandParse(nb, text);
+    }
+    if (f)
+        fclose(f);
+    free(text);
+    if (rc != 0)
+    {
+        fprintf(stderr, "%s: not a readable N-band file\n", path);
+        return -1;
+    }
+
+    for (dip = 1; dip < 8; dip++)
+        eqBankBuildNBand(&gEqBank.set[dip], nb);
+    if (gEqEngine.engine == EQ_ENGINE_FFT &&
+        eqBankPrepareFft(&gEqBank, &gEqEngine.fft, gEqSpectra,
+                         sizeof(gEqSpectra) / sizeof(gEqSpectra[0])) != 0)
+        gEqEngine.engine = EQ_ENGINE_DIRECT;
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: gupta_nair_sim [-d mask[@seconds]]... [-e direct|fft]\n"
+        "                      [-a fir|iir] [-m fir|iir] [-n bands.txt] [-q]\n"
+        "                      [-s] [-f words] [-r depth] [-t packets.bin]\n"
+        "                      [-w seconds] [-H ms] [-k ms] [-c ppm]\n"
+        "                      [-o add|only] in.wav out.wav\n"
+        "       gupta_nair_sim -S [options] in.wav\n");
+    exit(2);
+}
+
+static int simPath(const char *name)
+{
+    if (!strcmp(name, "fir"))
+        return EQ_PATH_FIR;
+    if (!strcmp(name, "iir"))
+        return EQ_PATH_IIR;
+    usage();
+    return -1;
+}
+
+/*
+ *  simRun() - Start the application and replay the input through it until
+ *             the input is consumed and the ring drained.  Returns the
+ *             number of frames, or 0 on error; *ms is the audio time.
+ */
+static Uint32 simRun(SimStream *s, const DipEvent *dips, int ndips,
+                     const char *nbandPath, double *ms)
+{
+    static EqNBand nband;
+    Uint32 frames = 0, drain = 0, words, exhausted;
+    double nowMs = 0.0, nextLoadMs = SIM_LOAD_MS, nextBlinkMs = SIM_BLINK_MS;
+    double nextTickMs = SIM_TICK_MS;
+    int nextDip = 0;
+
+    dskAppMain();
+    if (nbandPath && simLoadNBand(nbandPath, &nband) != 0)
+        return 0;
+
+    /* Run frames until the input is consumed and the ring drained */
+    while (drain < (Uint32)gRingDepth)
+    {
+        while (nextDip < ndips && dips[nextDip].seconds * 1000.0 <= nowMs)
+            gDskSim.dipSwitches = dips[nextDip++].mask;
+
+        exhausted = s->inPos >= s->in->frames;
+        words = simEdmaFrame(simRcv, simXmt, s);
+        if (words == 0)
+        {
+            fprintf(stderr, "EDMA channels were never enabled\n");
+            return 0;
+        }
+        frames++;
+        nowMs += 1000.0 * (words / 2) /
+                 (s->in->sampleRate * (1.0 + gCodecPpm * 1e-6));
+
+        for (; nextLoadMs <= nowMs; nextLoadMs += SIM_LOAD_MS)
+            load();
+        for (; nextBlinkMs <= nowMs; nextBlinkMs += SIM_BLINK_MS)
+            blinkLED();
+        for (; nextTickMs <= nowMs; nextTickMs += SIM_TICK_MS)
+            hapticTick();
+
+        edmaHwi();
+        simHwiReturn();
+
+        if (exhausted)
+            drain++;
+    }
+    *ms = nowMs;
+    return frames;
+}
+
+/*
+ *  simSweepLine() - One -S table row from gEqStats after a run.
+ */
+static void simSweepLine(void)
+{
+    const EqStats *st = &gEqStats;
+    double perMs = st->countsPerUs * 1000.0, sum = 0.0, period, deadline;
+    Uint32 i, frames = 0, misses = 0;
+
+    for (i = 0; i < EQ_STATS_MODES; i++)
+    {
+        frames += st->mode[i].frames;
+        misses += st->mode[i].misses;
+        sum += st->mode[i].sumExec;
+    }
+    period = st->period / perMs;
+    deadline = st->deadline / perMs;
+    printf("%6d %6d %9.1f %9.1f %9.3f %7.2f%% %9.3f %8.1f%% %6u %6u\n",
+           gBuffSize, gRingDepth, gRingDepth * period, deadline,
+           sum / frames / perMs, 100.0 * sum / frames / perMs / period,
+           st->maxResponse / perMs,
+           100.0 * (1.0 - st->maxResponse / perMs / deadline), misses,
+           st->overruns);
+}
+
+/*
+ *  simSweep() - Run the input once per frame size and ring depth.
+ */
+static int simSweep(const WavData *in, const DipEvent *dips, int ndips,
+                    const char *nbandPath)
+{
+    int words, depth, status;
+
+    printf("%6s %6s %9s %9s %9s %8s %9s %9s %6s %6s\n", "words", "depth",
+           "lat_ms", "ddl_ms", "mean_ms", "load", "worst_ms", "headroom",
+           "misses", "ovrun");
+    fflush(stdout);
+    for (words = SIM_SWEEP_MIN; words <= SIM_SWEEP_MAX; words *= 2)
+        for (depth = 2; depth <= SIM_SWEEP_DEPTH; depth++)
+        {
+            pid_t pid = fork();
+
+            if (pid == 0)
+            {
+                SimStream s;
+                double ms;
+
+                memset(&s, 0, sizeof(s));
+                s.in = in;
+                gBuffSize = words;
+                gRingDepth = depth;
+                if (simRun(&s, dips, ndips, nbandPath, &ms) == 0)
+                    exit(1);
+                simSweepLine();
+                exit(0);
+            }
+            if (pid < 0 || waitpid(pid, &status, 0) < 0 ||
+                !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                return 1;
+        }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    DipEvent dips[SIM_MAX_DIP_EVENTS];
+    const char *nbandPath = NULL;
+    FILE *tactile = NULL;
+    static EqTrackWriter track;
+    int ttrk = 0;
+    int ndips = 0, quiet = 0, stats = 0, sweep = 0;
+    WavData in;
+    SimStream s;
+    Uint32 frames, inRate;
+    double nowMs;
+    float hop;
+    int argi;
+
+    for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++)
+    {
+        if (!strcmp(argv[argi], "-d") && argi + 1 < argc &&
+            ndips < SIM_MAX_DIP_EVENTS)
+        {
+            char *at;
+            dips[ndips].mask = strtoul(argv[++argi], &at, 0) & 0xf;
+            dips[ndips].seconds = (*at == '@') ? atof(at + 1) : 0.0;
+            ndips++;
+        }
+        else if (!strcmp(argv[argi], "-e") && argi + 1 < argc)
+        {
+            argi++;
+            if (!strcmp(argv[argi], "fft"))
+                gEqEngineMode = EQ_ENGINE_FFT;
+            else if (!strcmp(argv[argi], "direct"))
+                gEqEngineMode = EQ_ENGINE_DIRECT;
+            else
+                usage();
+        }
+        else if (!strcmp(argv[argi], "-a") && argi + 1 < argc)
+        {
+            gEqAudioPath = simPath(argv[++argi]);
+        }
+        else if (!strcmp(argv[argi], "-m") && argi + 1 < argc)
+        {
+            gEqMeterPath = simPath(argv[++argi]);
+        }
+        else if (!strcmp(argv[argi], "-n") && argi + 1 < argc)
+        {
+            nbandPath = argv[++argi];
+        }
+        else if (!strcmp(argv[argi], "-q"))
+        {
+            quiet = 1;
+        }
+        else if (!strcmp(argv[argi], "-s"))
+        {
+            stats = 1;
+        }
+        else if (!strcmp(argv[argi], "-f") && argi + 1 < argc)
+        {
+            gBuffSize = atoi(argv[++argi]);
+        }
+        else if (!strcmp(argv[argi], "-r") && argi + 1 < argc)
+        {
+            gRingDepth = atoi(argv[++argi]);
+        }
+        else if (!strcmp(argv[argi], "-t") && argi + 1 < argc)
+        {
+            argi++;
+            tactile = fopen(argv[argi], "wb");
+            if (tactile == NULL)
+            {
+                perror(argv[argi]);
+                return 1;
+            }
+            gTactileSink = simTactile;
+            gTactileArg = tactile;
+            ttrk = strlen(argv[argi]) > 5 &&
+                   !strcmp(argv[argi] + strlen(argv[argi]) - 5, ".ttrk");
+            if (ttrk)
+            {
+                gTactileSink = eqTrackSink;
+                gTactileArg = &track;
+            }
+        }
+        else if (!strcmp(argv[argi], "-w") && argi + 1 < argc)
+        {
+            gAdaptWarmup = (float)atof(argv[++argi]);
+        }
+        else if (!strcmp(argv[argi], "-H") && argi + 1 < argc)
+        {
+            gTactileHop = (float)atof(argv[++argi]) / 1000.0f;
+        }
+        else if (!strcmp(argv[argi], "-k") && argi + 1 < argc)
+        {
+            gTactileSched = 1;
+            gSchedDelay = (float)atof(argv[++argi]) / 1000.0f;
+        }
+        else if (!strcmp(argv[argi], "-c") && argi + 1 < argc)
+        {
+            gCodecPpm = atof(argv[++argi]);
+        }
+        else if (!strcmp(argv[argi], "-o") && argi + 1 < argc)
+        {
+            argi++;
+            if (!strcmp(argv[argi], "add"))
+                gTactileOnsets = EQ_TACTILE_ONSETS;
+            else if (!strcmp(argv[argi], "only"))
+                gTactileOnsets = EQ_TACTILE_ONSETS_ONLY;
+            else
+                usage();
+        }
+        else if (!strcmp(argv[argi], "-S"))
+        {
+            sweep = 1;
+        }
+        else
+        {
+            usage();
+        }
+    }
+    if (argc - argi != (sweep ? 1 : 2))
+        usage();
+
+    if (wavRead(argv[argi], &in) != 0)
+        return 1;
+    if (in.channels > 2)
+    {
+        fprintf(stderr, "%s: only mono or stereo input is supported\n",
+                argv[argi]);
+        return 1;
+    }
+    inRate = in.sampleRate;
+    if (wavResample(&in, EQ_RESAMPLE_RATE) != 0)
+        return 1;
+
+    if (sweep)
+        return simSweep(&in, dips, ndips, nbandPath);
+
+    memset(&s, 0, sizeof(s));
+    s.in = &in;
+    if (ttrk)
+    {
+        /* the header is written last, once main() has set up the encoder */
+        EqTrackInfo info;
+
+        memset(&info, 0, sizeof(info));
+        eqTrackWriterOpen(&track, tactile, &info);
+    }
+    hop = gTactileHop;
+    frames = simRun(&s, dips, ndips, nbandPath, &nowMs);
+    if (frames == 0)
+        return 1;
+    if (gEqEngineMode == EQ_ENGINE_FFT && gEqEngine.engine != EQ_ENGINE_FFT)
+        fprintf(stderr, "-e fft: no room for the spectra of %d-word "
+                "frames, filtered in direct form\n", gBuffSize);
+    if (hop > 0.0f && gTactileHop <= 0.0f)
+        fprintf(stderr, "-H %g: more than %d hops in a window, packets "
+                "from the frame meters instead\n", hop * 1000.0f,
+                EQ_SDFT_MAX_HOPS);
+    if (gTactileSched)
+        eqSchedFlush(&gEqSched);
+    if (ttrk)
+        eqTrackInfoTactile(&track.info, &gEqTactile);
+    if (ttrk && eqTrackWriterClose(&track) != 0)
+    {
+        fprintf(stderr, "tactile track write failed\n");
+        return 1;
+    }
+
+    if (wavWrite(argv[argi + 1], s.out, s.outLen / 2, 2, in.sampleRate) != 0)
+        return 1;
+
+    if (!quiet)
+    {
+        printf("%s: %u frames, %.2f s at %u Hz, dip_value %d\n",
+               argv[argi], frames, nowMs / 1000.0, in.sampleRate, dip_value);
+        if (inRate != in.sampleRate)
+            printf("Resampled from %u Hz\n", inRate);
+        printf("LED on counts: LP %u, BP %u, HP %u\n",
+               gDskSim.ledOnCount[0], gDskSim.ledOnCount[1],
+               gDskSim.ledOnCount[2]);
+        if (tactile)
+            printf("Tactile packets: %u\n", gEqTactile.packets);
+        if (gTactileOnsets != EQ_TACTILE_LEVEL)
+            printf("Onsets: LP %u, BP %u, HP %u\n", gEqOnset.onsets[EQ_LP],
+                   gEqOnset.onsets[EQ_BP], gEqOnset.onsets[EQ_HP]);
+    }
+    if (stats)
+        dumpStats();
+    if (gTactileSched)
+        eqSchedDump(&gEqSched, stdout);
+
+    if (tactile)
+        fclose(tactile);
+    wavFree(&in);
+    free(s.out);
+    return 0;
+}
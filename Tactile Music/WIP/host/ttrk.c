@@ -0,0 +1,221 @@
+/*
+ *  ======== ttrk.c ========
+ *
+ *  Reader, validator and converter for TTRK tactile tracks (eq_track.h).
+ *
+ *  Usage: ttrk check track.ttrk...
+ *         ttrk dump track.ttrk [seconds [count]]
+ *         ttrk pack [-r rate] [-i samples] packets.tac track.ttrk
+ *
+ *  check  Validates each track and prints its header.  Exits non-zero if
+ *         any track is damaged.
+ *  dump   Prints count packets (default: to the end) from seconds into
+ *         the track, found through the seek index.  The file is mapped,
+ *         not read.
+ *  pack   Converts raw 8-byte packets (gupta_nair_sim -t to a .tac file)
+ *         to a track.  The stream's rate and interval default to the
+ *         simulation's 8000 Hz and 800 samples.
+ */
+#define DSK_SIM_HARNESS
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dsk_sim.h"
+#include "eq_track.h"
+
+#define TTRK_RATE       8000
+#define TTRK_INTERVAL   800
+
+typedef struct TtrkMap {
+    void   *base;
+    size_t length;
+} TtrkMap;
+
+static int ttrkMap(const char *path, TtrkMap *m, EqTrack *t)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    m->base = MAP_FAILED;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    m->length = st.st_size;
+    if (m->length)
+        m->base = mmap(NULL, m->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m->base == MAP_FAILED || m->length > 0xffffffffu ||
+        eqTrackOpen(t, m->base, (Uint32)m->length) != 0)
+    {
+        fprintf(stderr, "%s: not a TTRK version %d track\n", path,
+                EQ_TRACK_VERSION);
+        if (m->base != MAP_FAILED)
+            munmap(m->base, m->length);
+        return -1;
+    }
+    return 0;
+}
+
+static int ttrkCheck(int argc, char **argv)
+{
+    int i, k, rc = 0;
+
+    for (i = 0; i < argc; i++)
+    {
+        TtrkMap m;
+        EqTrack t;
+
+        if (ttrkMap(argv[i], &m, &t) != 0)
+        {
+            rc = 1;
+            continue;
+        }
+        printf("%s: %u packets of %u samples at %u Hz (%.1f s), %u blocks, "
+               "%u data bytes, bands", argv[i], t.packets, t.info.interval,
+               t.info.sampleRate,
+               (double)t.packets * t.info.interval / t.info.sampleRate,
+               t.blocks, t.dataBytes);
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+            printf(" %u-%u", t.info.lowHz[k], t.info.highHz[k]);
+        printf("\n");
+        if (eqTrackCheck(&t, stderr) != 0)
+        {
+            fprintf(stderr, "%s: damaged\n", argv[i]);
+            rc = 1;
+        }
+        munmap(m.base, m.length);
+    }
+    return rc;
+}
+
+static int ttrkDump(const char *path, float seconds, Uint32 count)
+{
+    TtrkMap m;
+    EqTrack t;
+    EqTrackCursor c;
+    Uint8 packet[EQ_TACTILE_PACKET];
+    int k, got = 1;
+
+    if (ttrkMap(path, &m, &t) != 0)
+        return 1;
+    if (seconds < 0.0f || (seconds > 0.0f &&
+                           eqTrackPacketAt(&t, seconds) >= t.packets))
+    {
+        fprintf(stderr, "%s: %.3f s is outside the %.3f s track\n", path,
+                seconds, (double)t.packets * t.info.interval /
+                t.info.sampleRate);
+        munmap(m.base, m.length);
+        return 1;
+    }
+    if (eqTrackSeek(&t, &c, eqTrackPacketAt(&t, seconds)) != 0)
+        got = -1;
+    for (; got == 1 && count > 0; count--)
+    {
+        Uint32 n = c.packet;
+
+        got = eqTrackNext(&c, packet);
+        if (got != 1)
+            break;
+        printf("%9.3f", (double)n * t.info.interval / t.info.sampleRate);
+        for (k = 0; k < EQ_TACTILE_MOTORS; k++)
+            printf(" %4u", (packet[2 * k] << 8) | packet[2 * k + 1]);
+        printf("\n");
+    }
+    munmap(m.base, m.length);
+    if (got < 0)
+    {
+        fprintf(stderr, "%s: damaged\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+static int ttrkPack(const char *in, const char *out, Uint32 rate,
+                    Uint32 interval)
+{
+    FILE *src = fopen(in, "rb"), *dst;
+    Uint8 packet[EQ_TACTILE_PACKET];
+    EqTrackWriter w;
+    EqTactile t;
+    EqTrackInfo info;
+    int rc;
+
+    if (src == NULL)
+    {
+        perror(in);
+        return 1;
+    }
+    dst = fopen(out, "wb");
+    if (dst == NULL)
+    {
+        perror(out);
+        fclose(src);
+        return 1;
+    }
+
+    /* the bands the encoder would have used */
+    t.rate = (float)rate;
+    t.interval = interval;
+    eqTrackInfoTactile(&info, &t);
+
+    eqTrackWriterOpen(&w, dst, &info);
+    while (fread(packet, 1, sizeof(packet), src) == sizeof(packet))
+        eqTrackWrite(&w, packet);
+    rc = eqTrackWriterClose(&w);
+    fclose(src);
+    if (fclose(dst) != 0 || rc != 0)
+    {
+        fprintf(stderr, "%s: write failed\n", out);
+        return 1;
+    }
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: ttrk check track.ttrk...\n"
+        "       ttrk dump track.ttrk [seconds [count]]\n"
+        "       ttrk pack [-r rate] [-i samples] packets.tac track.ttrk\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 3 && !strcmp(argv[1], "check"))
+        return ttrkCheck(argc - 2, argv + 2);
+
+    if (argc >= 3 && argc <= 5 && !strcmp(argv[1], "dump"))
+        return ttrkDump(argv[2], argc > 3 ? (float)atof(argv[3]) : 0.0f,
+                        argc > 4 ? (Uint32)atoi(argv[4]) : 0xffffffffu);
+
+    if (argc >= 4 && !strcmp(argv[1], "pack"))
+    {
+        Uint32 rate = TTRK_RATE, interval = TTRK_INTERVAL;
+        int argi;
+
+        for (argi = 2; argi < argc && argv[argi][0] == '-'; argi++)
+        {
+            if (!strcmp(argv[argi], "-r") && argi + 1 < argc)
+                rate = atoi(argv[++argi]);
+            else if (!strcmp(argv[argi], "-i") && argi + 1 < argc)
+                interval = atoi(argv[++argi]);
+            else
+                usage();
+        }
+        if (argc - argi != 2 || rate == 0 || interval == 0)
+            usage();
+        return ttrkPack(argv[argi], argv[argi + 1], rate, interval);
+    }
+
+    usage();
+    return 2;
+}
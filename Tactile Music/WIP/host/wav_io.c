@@ -0,0 +1,282 @@
+/*
+ *  ======== wav_io.c ========
+ *
+ *  16-bit PCM WAV file support for the host tools.  Files are read and
+ *  written little-endian regardless of the workstation byte order.
+ */
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "eq_resample.h"
+#include "wav_io.h"
+
+static Uint32 getLe32(const Uint8 *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((Uint32)p[3] << 24);
+}
+
+static Uint32 getLe16(const Uint8 *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static void putLe32(Uint8 *p, Uint32 v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void putLe16(Uint8 *p, Uint32 v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+int wavRead(const char *path, WavData *wav)
+{
+    FILE *fp;
+    Uint8 hdr[12], chunk[8], fmt[16];
+    Uint32 size, i;
+    int haveFmt = 0;
+
+    memset(wav, 0, sizeof(*wav));
+
+    fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    if (fread(hdr, 1, 12, fp) != 12 || memcmp(hdr, "RIFF", 4) ||
+        memcmp(hdr + 8, "WAVE", 4))
+    {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", path);
+        fclose(fp);
+        return -1;
+    }
+
+    while (fread(chunk, 1, 8, fp) == 8)
+    {
+        size = getLe32(chunk + 4);
+
+        if (!memcmp(chunk, "fmt ", 4) && size >= 16)
+        {
+            if (fread(fmt, 1, 16, fp) != 16)
+                break;
+            fseek(fp, (size - 16) + (size & 1), SEEK_CUR);
+            if (getLe16(fmt) != 1 || getLe16(fmt + 14) != 16)
+            {
+                fprintf(stderr, "%s: only 16-bit PCM is supported\n", path);
+                fclose(fp);
+                return -1;
+            }
+            wav->channels = getLe16(fmt + 2);
+            wav->sampleRate = getLe32(fmt + 4);
+            haveFmt = wav->channels > 0;
+        }
+        else if (!memcmp(chunk, "data", 4) && haveFmt)
+        {
+            Uint32 count = size / 2;
+            Uint8 *raw = malloc(size ? size : 1);
+
+            wav->samples = malloc((count ? count : 1) * sizeof(Int16));
+            if (raw == NULL || wav->samples == NULL)
+            {
+                fprintf(stderr, "%s: out of memory\n", path);
+                free(raw);
+                wavFree(wav);
+                fclose(fp);
+                return -1;
+            }
+            count = fread(raw, 1, size, fp) / 2;
+            for (i = 0; i < count; i++)
+                wav->samples[i] = (Int16)getLe16(raw + 2 * i);
+            free(raw);
+            wav->frames = count / wav->channels;
+            fclose(fp);
+            return 0;
+        }
+        else
+        {
+            fseek(fp, size + (size & 1), SEEK_CUR);
+        }
+    }
+
+    fprintf(stderr, "%s: no PCM data found\n", path);
+    fclose(fp);
+    return -1;
+}
+
+int wavWrite(const char *path, const Int16 *samples, Uint32 frames,
+             Uint32 channels, Uint32 sampleRate)
+{
+    FILE *fp;
+    Uint8 hdr[44];
+    Uint8 buf[2];
+    Uint32 bytes = frames * channels * 2;
+    Uint32 i;
+
+    fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    memcpy(hdr, "RIFF", 4);
+    putLe32(hdr + 4, 36 + bytes);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    putLe32(hdr + 16, 16);
+    putLe16(hdr + 20, 1);                           // PCM
+    putLe16(hdr + 22, channels);
+    putLe32(hdr + 24, sampleRate);
+    putLe32(hdr + 28, sampleRate * channels * 2);   // byte rate
+    putLe16(hdr + 32, channels * 2);                // block align
+    putLe16(hdr + 34, 16);                          // bits per sample
+    memcpy(hdr + 36, "data", 4);
+    putLe32(hdr + 40, bytes);
+    fwrite(hdr, 1, sizeof(hdr), fp);
+
+    for (i = 0; i < frames * channels; i++)
+    {
+        putLe16(buf, (Uint16)samples[i]);
+        fwrite(buf, 1, 2, fp);
+    }
+
+    if (fclose(fp) != 0)
+    {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+void wavFree(WavData *wav)
+{
+    free(wav->samples);
+    wav->samples = NULL;
+    wav->frames = 0;
+}
+
+int wavResample(WavData *wav, Uint32 rate)
+{
+    static EqResamplePlan plan;
+    static EqResampler r;
+    Uint32 nch = wav->channels, frames, made;
+    Int16 zero[EQ_RESAMPLE_CHUNK * EQ_CHANNELS], *out;
+
+    if (wav->sampleRate == rate)
+        return 0;
+    if (nch > EQ_CHANNELS ||
+        eqResamplePlan(&plan, wav->sampleRate, rate) != 0)
+    {
+        fprintf(stderr, "cannot convert %u Hz audio to %u Hz\n",
+                wav->sampleRate, rate);
+        return -1;
+    }
+    frames = (Uint32)(((double)wav->frames * plan.up + plan.down - 1) /
+                      plan.down);
+    out = malloc((frames + eqResampleMaxOut(&plan, EQ_RESAMPLE_CHUNK)) *
+                 nch * sizeof(Int16));
+    if (out == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return -1;
+    }
+
+    /* drop the filter's delay at the start, flush it with zeros at the end */
+    eqResampleInit(&r, &plan, nch);
+    eqResampleSeek(&r, plan.delay);
+    made = eqResamplePush(&r, wav->samples, wav->frames, out);
+    memset(zero, 0, sizeof(zero));
+    while (made < frames)
+        made += eqResamplePush(&r, zero, EQ_RESAMPLE_CHUNK, out + made * nch);
+
+    free(wav->samples);
+    wav->samples = out;
+    wav->frames = frames;
+    wav->sampleRate = rate;
+    return 0;
+}
+
+int wavMap(const char *path, WavMap *map)
+{
+    const Uint8 *p, *end;
+    struct stat st;
+    int fd, haveFmt = 0;
+
+    memset(map, 0, sizeof(*map));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    map->length = st.st_size;
+    map->base = map->length ? mmap(NULL, map->length, PROT_READ, MAP_PRIVATE,
+                                   fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map->base == MAP_FAILED)
+    {
+        fprintf(stderr, "%s: cannot map\n", path);
+        map->base = NULL;
+        return -1;
+    }
+
+    p = map->base;
+    end = p + map->length;
+    if (map->length < 12 || memcmp(p, "RIFF", 4) || memcmp(p + 8, "WAVE", 4))
+    {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", path);
+        wavUnmap(map);
+        return -1;
+    }
+
+    for (p += 12; end - p >= 8; p += 8 + getLe32(p + 4) + (getLe32(p + 4) & 1))
+    {
+        Uint32 size = getLe32(p + 4);
+
+        if (!memcmp(p, "fmt ", 4) && size >= 16 && end - p >= 24)
+        {
+            if (getLe16(p + 8) != 1 || getLe16(p + 22) != 16)
+            {
+                fprintf(stderr, "%s: only 16-bit PCM is supported\n", path);
+                wavUnmap(map);
+                return -1;
+            }
+            map->channels = getLe16(p + 10);
+            map->sampleRate = getLe32(p + 12);
+            haveFmt = map->channels > 0;
+        }
+        else if (!memcmp(p, "data", 4) && haveFmt)
+        {
+            if (size > (Uint32)(end - p - 8))
+                size = end - p - 8;
+            map->data = p + 8;
+            map->frames = size / 2 / map->channels;
+            return 0;
+        }
+        if (size > (Uint32)(end - p - 8))
+            break;
+    }
+
+    fprintf(stderr, "%s: no PCM data found\n", path);
+    wavUnmap(map);
+    return -1;
+}
+
+void wavUnmap(WavMap *map)
+{
+    if (map->base)
+        munmap(map->base, map->length);
+    memset(map, 0, sizeof(*map));
+}
@@ -0,0 +1,66 @@
+/*
+ *  ======== wav_io.h ========
+ *
+ *  Minimal RIFF/WAVE reader and writer for 16-bit PCM, used by the host
+ *  tools to feed and capture the simulated codec.
+ */
+#ifndef WAV_IO_H
+#define WAV_IO_H
+
+#include "dsk_sim.h"
+
+typedef struct WavData {
+    Int16  *samples;        // interleaved samples
+    Uint32 frames;          // samples per channel
+    Uint32 channels;
+    Uint32 sampleRate;
+} WavData;
+
+/*
+ *  wavRead() - Load a 16-bit PCM WAV file.  Returns 0 on success, -1 on
+ *              error after printing the reason to stderr.
+ */
+int  wavRead(const char *path, WavData *wav);
+
+/*
+ *  wavWrite() - Write interleaved 16-bit PCM samples as a WAV file.
+ *               Returns 0 on success, -1 on error.
+ */
+int  wavWrite(const char *path, const Int16 *samples, Uint32 frames,
+              Uint32 channels, Uint32 sampleRate);
+
+void wavFree(WavData *wav);
+
+/*
+ *  wavResample() - Convert wav to rate Hz in place (eq_resample.h), in
+ *                  step with the original: the filter's delay is taken
+ *                  out.  Returns 0, or -1 if the rates are not supported.
+ */
+int  wavResample(WavData *wav, Uint32 rate);
+
+/*
+ *  WavMap - A 16-bit PCM WAV file mapped read-only into memory.  data
+ *           points at the little-endian samples inside the mapping;
+ *           read them with wavMapSample().
+ */
+typedef struct WavMap {
+    const Uint8 *data;
+    Uint32 frames;          // samples per channel
+    Uint32 channels;
+    Uint32 sampleRate;
+    void   *base;           // the mapping
+    size_t length;
+} WavMap;
+
+#define wavMapSample(m, i) \
+    ((Int16)((m)->data[2 * (i)] | ((m)->data[2 * (i) + 1] << 8)))
+
+/*
+ *  wavMap() - Map a 16-bit PCM WAV file.  Returns 0 on success, -1 on
+ *             error after printing the reason to stderr.
+ */
+int  wavMap(const char *path, WavMap *map);
+
+void wavUnmap(WavMap *map);
+
+#endif /* WAV_IO_H */